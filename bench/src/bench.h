@@ -0,0 +1,51 @@
+#ifndef _KILLME_BENCH_H_
+#define _KILLME_BENCH_H_
+
+#include <string>
+#include <chrono>
+#include <functional>
+#include <cstddef>
+
+namespace killme
+{
+    namespace bench
+    {
+        /** Register a benchmark or a test run by the bench runner */
+        struct Registration
+        {
+            Registration(const char* name, void(*fun)());
+        };
+
+        /** Return the average time[ns] of a function per call */
+        /// NOTE: The function is called once before timing, to warm up caches and lazy initializations.
+        template <class F>
+        double measure(size_t numIterations, F fun)
+        {
+            fun();
+            const auto start = std::chrono::high_resolution_clock::now();
+            for (size_t i = 0; i < numIterations; ++i)
+            {
+                fun();
+            }
+            const auto elapsed = std::chrono::high_resolution_clock::now() - start;
+            return std::chrono::duration<double, std::nano>(elapsed).count() / numIterations;
+        }
+
+        /** Output a result line of the running benchmark */
+        void report(const char* fmt, ...);
+
+        /** Record a failure of the running test if the condition is false */
+        void check(bool condition, const std::string& what);
+
+        /** Prevent the compiler from removing a computation */
+        void consume(const void* p);
+    }
+}
+
+/** Define a benchmark or a test. The runner runs all, or the ones named on the command line. */
+#define KILLME_BENCH(name) \
+    static void killmeBench_##name(); \
+    static const killme::bench::Registration killmeBenchRegistration_##name(#name, &killmeBench_##name); \
+    static void killmeBench_##name()
+
+#endif
\ No newline at end of file
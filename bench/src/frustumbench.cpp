@@ -0,0 +1,135 @@
+#include "bench.h"
+#include "core/math/frustum.h"
+#include "core/math/boundingvolume.h"
+#include "core/math/matrix44.h"
+#include "core/math/quaternion.h"
+#include "core/math/vector3.h"
+#include "core/math/math.h"
+#include "core/platform.h"
+#include <vector>
+#include <random>
+
+using namespace killme;
+
+namespace
+{
+    struct Instance
+    {
+        Vector3 scale;
+        Quaternion orientation;
+        Vector3 position;
+    };
+
+    // Instances scattered around the camera in all directions
+    std::vector<Instance> makeInstances(size_t n)
+    {
+        std::mt19937 random(1);
+        std::uniform_real_distribution<float> position(-500, 500);
+        std::uniform_real_distribution<float> unit(-1, 1);
+        std::uniform_real_distribution<float> scale(0.5f, 4);
+
+        std::vector<Instance> instances(n);
+        for (auto& inst : instances)
+        {
+            const auto s = scale(random);
+            inst.scale = Vector3(s, s, s);
+            inst.orientation = makeQuaternion(Vector3(unit(random), unit(random), unit(random) + 2), unit(random) * PI);
+            inst.position = Vector3(position(random), position(random), position(random));
+        }
+        return instances;
+    }
+
+    // Return whether a corner of the box is strictly inside the clip volume, where the instance is surely visible
+    bool hasCornerInside(const BoundingBox& box, const Matrix44& worldViewProj)
+    {
+        for (size_t i = 0; i < 8; ++i)
+        {
+            const float p[3] = {
+                (i & 1) ? box.upper.x : box.lower.x,
+                (i & 2) ? box.upper.y : box.lower.y,
+                (i & 4) ? box.upper.z : box.lower.z
+            };
+            float clip[4];
+            for (size_t c = 0; c < 4; ++c)
+            {
+                clip[c] = p[0] * worldViewProj(0, c) + p[1] * worldViewProj(1, c) + p[2] * worldViewProj(2, c) + worldViewProj(3, c);
+            }
+            const auto w = clip[3] * 0.999f;
+            if (-w < clip[0] && clip[0] < w && -w < clip[1] && clip[1] < w && 0 < clip[2] && clip[2] < w)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+}
+
+KILLME_BENCH(FrustumCulling)
+{
+    // Instances of a single submesh, tested like MeshInstance::collectMeshes()
+    const size_t n = 100000;
+    const auto instances = makeInstances(n);
+
+    // Bounds of a cube computed like the importer
+    float positions[8 * 3];
+    for (size_t i = 0; i < 8; ++i)
+    {
+        positions[i * 3 + 0] = (i & 1) ? 1.0f : -1.0f;
+        positions[i * 3 + 1] = (i & 2) ? 1.0f : -1.0f;
+        positions[i * 3 + 2] = (i & 4) ? 1.0f : -1.0f;
+    }
+    const auto localBox = makeBoundingBox(positions, 8);
+    const auto localSphere = makeBoundingSphere(positions, 8);
+
+    const auto view = inverse(makeTransformMatrix(Vector3(1, 1, 1), makeQuaternion(Vector3(0, 1, 0), 0.3f), Vector3(0, 0, -100)));
+    const auto viewProj = view * makeProjectionMatrix(PI / 2, 16.0f / 9, 1, 1000);
+    const Frustum frustum(viewProj);
+
+    std::vector<unsigned char> visible(n);
+    const auto cull = [&]
+    {
+        for (size_t i = 0; i < n; ++i)
+        {
+            const auto& inst = instances[i];
+            const auto transform = makeTransformMatrix(inst.scale, inst.orientation, inst.position);
+            visible[i] = frustum.intersects(transformBoundingSphere(localSphere, transform)) &&
+                frustum.intersects(transformBoundingBox(localBox, transform));
+        }
+        bench::consume(visible.data());
+    };
+
+    // Only the world matrices, which were computed for all instances without culling
+    std::vector<Matrix44> transforms(n);
+    const auto transformTime = bench::measure(10, [&]
+    {
+        for (size_t i = 0; i < n; ++i)
+        {
+            const auto& inst = instances[i];
+            transforms[i] = makeTransformMatrix(inst.scale, inst.orientation, inst.position);
+        }
+        bench::consume(transforms.data());
+    });
+    const auto cullTime = bench::measure(10, cull);
+
+    size_t numVisible = 0;
+    bool conservative = true;
+    for (size_t i = 0; i < n; ++i)
+    {
+        numVisible += visible[i];
+        if (!visible[i] && hasCornerInside(localBox, transforms[i] * viewProj))
+        {
+            conservative = false;
+        }
+    }
+
+#ifdef KILLME_SSE
+    const auto path = "SSE";
+#else
+    const auto path = "scalar";
+#endif
+    bench::report("%u instances: %u visible, %u culled", static_cast<unsigned>(n), static_cast<unsigned>(numVisible), static_cast<unsigned>(n - numVisible));
+    bench::report("culling (%s): %.2f ms per frame, %.2f ns per instance", path, cullTime / 1e6, cullTime / n);
+    bench::report("world matrices only: %.2f ms per frame", transformTime / 1e6);
+    bench::check(conservative, "no instance with a corner in the view is culled");
+    bench::check(numVisible > 0 && numVisible < n, "the view has both visible and culled instances");
+}
\ No newline at end of file
@@ -0,0 +1,89 @@
+#include "bench.h"
+#include <vector>
+#include <utility>
+#include <exception>
+#include <algorithm>
+#include <cstdio>
+#include <cstdarg>
+#include <cstring>
+
+namespace killme
+{
+    namespace bench
+    {
+        namespace
+        {
+            // Registered before main() by static initializations in each file
+            std::vector<std::pair<const char*, void(*)()>>& getRegistrations()
+            {
+                static std::vector<std::pair<const char*, void(*)()>> registrations;
+                return registrations;
+            }
+
+            size_t numFailures = 0;
+            const void* volatile sink = nullptr;
+        }
+
+        Registration::Registration(const char* name, void(*fun)())
+        {
+            getRegistrations().emplace_back(name, fun);
+        }
+
+        void report(const char* fmt, ...)
+        {
+            va_list args;
+            va_start(args, fmt);
+            std::printf("  ");
+            std::vprintf(fmt, args);
+            std::printf("\n");
+            va_end(args);
+        }
+
+        void check(bool condition, const std::string& what)
+        {
+            if (!condition)
+            {
+                std::printf("  FAILED: %s\n", what.c_str());
+                ++numFailures;
+            }
+        }
+
+        void consume(const void* p)
+        {
+            sink = p;
+        }
+    }
+}
+
+int main(int argc, char** argv)
+{
+    using namespace killme::bench;
+
+    // Run in the name order, so that outputs are comparable
+    auto registrations = getRegistrations();
+    std::sort(std::begin(registrations), std::end(registrations),
+        [](const std::pair<const char*, void(*)()>& a, const std::pair<const char*, void(*)()>& b) { return std::strcmp(a.first, b.first) < 0; });
+
+    for (const auto& registration : registrations)
+    {
+        const auto selected = argc <= 1 || std::any_of(argv + 1, argv + argc,
+            [&](const char* name) { return std::strcmp(name, registration.first) == 0; });
+        if (!selected)
+        {
+            continue;
+        }
+
+        std::printf("%s\n", registration.first);
+        try
+        {
+            registration.second();
+        }
+        catch (const std::exception& e)
+        {
+            check(false, std::string("Exception: ") + e.what());
+        }
+    }
+
+    std::printf("%u failure(s)\n", static_cast<unsigned>(numFailures));
+    return numFailures == 0 ? 0 : 1;
+}
\ No newline at end of file
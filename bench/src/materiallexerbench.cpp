@@ -0,0 +1,213 @@
+#include "bench.h"
+#include "scene/materiallexer.h"
+#include <vector>
+#include <string>
+#include <sstream>
+#include <random>
+#include <cctype>
+
+using namespace killme;
+
+namespace
+{
+    // Generate a large material file, which has all kinds of blocks and comments
+    std::string generateMaterial(std::mt19937& random, size_t numParams)
+    {
+        std::uniform_real_distribution<float> dist(-100, 100);
+        std::ostringstream out;
+        out << "/* Generated material\n   for the lexer benchmark */\npriority = translucent;\n\n";
+
+        out << "parameters\n{\n";
+        for (size_t i = 0; i < numParams; ++i)
+        {
+            switch (i % 4)
+            {
+            case 0:
+                out << "    float f" << i << " = " << dist(random) << "; // A scalar\n";
+                break;
+            case 1:
+                out << "    float3 v" << i << " = (" << dist(random) << ", " << dist(random) << ", " << dist(random) << ");\n";
+                break;
+            case 2:
+                out << "    float4 c" << i << " = (" << dist(random) << ", " << dist(random) << ", " << dist(random) << ", " << dist(random) << ");\n";
+                break;
+            default:
+                out << "    tex2d t" << i << " = \"media/texture" << i << ".bmp\";\n";
+                break;
+            }
+        }
+        out << "}\n\n";
+
+        for (size_t i = 0; i < numParams / 16; ++i)
+        {
+            out << "vertex_shader vs" << i << "\n{\n    source = \"media/shader" << i << ".vhlsl\";\n"
+                << "    map_to_constant = { Param" << i << " = f" << i * 4 << " };\n}\n\n";
+        }
+
+        out << "technique main\n{\n";
+        for (size_t i = 0; i < numParams / 16; ++i)
+        {
+            out << "    pass[" << i << "]\n    {\n"
+                << "        vertex_shader_ref = vs" << i << ";\n"
+                << "        for_each_light = point; /* The light\n           iteration */ blend_enable = true;\n"
+                << "        blend_op = add;\n    }\n";
+        }
+        out << "}\n";
+        return out.str();
+    }
+
+    // Numbers are converted where a parser expects them, which is approximated by the first character
+    bool isNumberStart(char c)
+    {
+        return std::isdigit(static_cast<unsigned char>(c)) || c == '-' || c == '.';
+    }
+
+    bool isNumber(const std::string& token)
+    {
+        return !token.empty() && isNumberStart(token[0]);
+    }
+
+    // The former tokenizer, which copies lines and tokens into strings
+    struct CopiedTokens
+    {
+        std::vector<std::string> tokens;
+        std::vector<size_t> lines;
+    };
+
+    void tokenizeByCopy(const std::string& source, CopiedTokens& result, float& sum)
+    {
+        static const std::string DELIMITERS = " \t\",=(){}[];";
+
+        std::istringstream stream(source);
+        bool commentOut = false;
+        size_t lineNumber = 0;
+        while (!stream.eof())
+        {
+            std::string line;
+            std::getline(stream, line);
+            ++lineNumber;
+
+            if (commentOut)
+            {
+                const auto p = line.find("*/");
+                if (p == std::string::npos)
+                {
+                    line.clear();
+                }
+                else
+                {
+                    line = line.substr(p + 2);
+                    commentOut = false;
+                }
+            }
+
+            const auto p = line.find("/*");
+            if (p != std::string::npos)
+            {
+                line = line.substr(0, p);
+                commentOut = true;
+            }
+            line = line.substr(0, line.find("//"));
+
+            size_t q = 0;
+            while (true)
+            {
+                while (q < line.length() && std::isspace(static_cast<unsigned char>(line[q])))
+                {
+                    ++q;
+                }
+                if (q >= line.length())
+                {
+                    break;
+                }
+
+                auto r = line.find_first_of(DELIMITERS, q);
+                r = (r == std::string::npos ? line.length() : r);
+                const auto length = (q == r ? 1 : r - q);
+                result.tokens.emplace_back(line.substr(q, length));
+                result.lines.emplace_back(lineNumber);
+                q += length;
+
+                if (isNumber(result.tokens.back()))
+                {
+                    sum += std::stof(result.tokens.back());
+                }
+            }
+        }
+    }
+}
+
+KILLME_BENCH(MaterialLexer)
+{
+    std::mt19937 random(1);
+    std::vector<std::string> corpus;
+    size_t corpusSize = 0;
+    for (size_t i = 0; i < 32; ++i)
+    {
+        corpus.emplace_back(generateMaterial(random, 2048));
+        corpusSize += corpus.back().size();
+    }
+
+    // The lexer must produce the same tokens on the same lines, and the same numbers
+    bool sameTokens = true;
+    bool sameNumbers = true;
+    for (const auto& source : corpus)
+    {
+        CopiedTokens copied;
+        float sum = 0;
+        tokenizeByCopy(source, copied, sum);
+
+        MaterialLexer lexer(source.data(), source.size());
+        size_t i = 0;
+        for (auto token = lexer.next(); token.keyword != MaterialKeyword::end; token = lexer.next(), ++i)
+        {
+            if (i >= copied.tokens.size() || token.str() != copied.tokens[i] || token.line != copied.lines[i])
+            {
+                sameTokens = false;
+                break;
+            }
+
+            float value;
+            if (isNumber(copied.tokens[i]) && (!toFloat(token, value) || value != std::stof(copied.tokens[i])))
+            {
+                sameNumbers = false;
+            }
+        }
+        sameTokens = sameTokens && i == copied.tokens.size();
+    }
+    bench::check(sameTokens, "the lexer produces the tokens and lines of the former tokenizer");
+    bench::check(sameNumbers, "toFloat() converts numbers like std::stof()");
+
+    const auto copyTime = bench::measure(5, [&]
+    {
+        float sum = 0;
+        for (const auto& source : corpus)
+        {
+            CopiedTokens copied;
+            tokenizeByCopy(source, copied, sum);
+        }
+        bench::consume(&sum);
+    });
+    const auto lexerTime = bench::measure(5, [&]
+    {
+        float sum = 0;
+        for (const auto& source : corpus)
+        {
+            MaterialLexer lexer(source.data(), source.size());
+            for (auto token = lexer.next(); token.keyword != MaterialKeyword::end; token = lexer.next())
+            {
+                float value;
+                if (isNumberStart(*token.begin) && toFloat(token, value))
+                {
+                    sum += value;
+                }
+            }
+        }
+        bench::consume(&sum);
+    });
+
+    const auto megabytes = corpusSize / 1e6;
+    bench::report("corpus: %u files, %.2f MB", static_cast<unsigned>(corpus.size()), megabytes);
+    bench::report("copying tokenizer: %.2f ms, %.2f MB/s", copyTime / 1e6, megabytes / (copyTime / 1e9));
+    bench::report("single pass lexer: %.2f ms, %.2f MB/s, %.2fx", lexerTime / 1e6, megabytes / (lexerTime / 1e9), copyTime / lexerTime);
+}
\ No newline at end of file
@@ -0,0 +1,125 @@
+#include "bench.h"
+#include "core/math/matrix44.h"
+#include "core/math/math.h"
+#include "core/platform.h"
+#include <vector>
+#include <random>
+#include <cmath>
+
+namespace killme
+{
+    namespace
+    {
+        // The scalar product. Elements are copied out once, so that the accessors do not dominate.
+        Matrix44 multiplyScalar(const Matrix44& a, const Matrix44& b)
+        {
+            float fa[4][4], fb[4][4], fm[4][4];
+            for (size_t r = 0; r < 4; ++r)
+            {
+                for (size_t c = 0; c < 4; ++c)
+                {
+                    fa[r][c] = a(r, c);
+                    fb[r][c] = b(r, c);
+                }
+            }
+            for (size_t r = 0; r < 4; ++r)
+            {
+                for (size_t c = 0; c < 4; ++c)
+                {
+                    fm[r][c] = fa[r][0] * fb[0][c] + fa[r][1] * fb[1][c] + fa[r][2] * fb[2][c] + fa[r][3] * fb[3][c];
+                }
+            }
+            return {
+                fm[0][0], fm[0][1], fm[0][2], fm[0][3],
+                fm[1][0], fm[1][1], fm[1][2], fm[1][3],
+                fm[2][0], fm[2][1], fm[2][2], fm[2][3],
+                fm[3][0], fm[3][1], fm[3][2], fm[3][3]
+            };
+        }
+
+        bool nearlyEqual(const Matrix44& a, const Matrix44& b, float tolerance)
+        {
+            for (size_t r = 0; r < 4; ++r)
+            {
+                for (size_t c = 0; c < 4; ++c)
+                {
+                    if (std::abs(a(r, c) - b(r, c)) > tolerance)
+                    {
+                        return false;
+                    }
+                }
+            }
+            return true;
+        }
+
+        // Random well conditioned matrices: rotations and translations with small noise
+        std::vector<Matrix44> makeMatrices(size_t n)
+        {
+            std::mt19937 random(1);
+            std::uniform_real_distribution<float> dist(-1, 1);
+
+            std::vector<Matrix44> matrices(n);
+            for (auto& m : matrices)
+            {
+                for (size_t r = 0; r < 4; ++r)
+                {
+                    for (size_t c = 0; c < 4; ++c)
+                    {
+                        m(r, c) = (r == c ? 2.0f : 0.0f) + dist(random) * 0.5f;
+                    }
+                }
+            }
+            return matrices;
+        }
+    }
+}
+
+using namespace killme;
+
+KILLME_BENCH(Matrix44)
+{
+    const size_t n = 1024;
+    const auto as = makeMatrices(n);
+    const auto bs = makeMatrices(n + 1);
+    std::vector<Matrix44> results(n);
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        bench::check(nearlyEqual(as[i] * bs[i + 1], multiplyScalar(as[i], bs[i + 1]), 1e-4f), "operator * matches the scalar product");
+        bench::check(nearlyEqual(as[i] * inverse(as[i]), Matrix44::IDENTITY, 1e-4f), "inverse() inverts");
+    }
+
+    const auto scalar = bench::measure(100, [&]
+    {
+        for (size_t i = 0; i < n; ++i)
+        {
+            results[i] = multiplyScalar(as[i], bs[i + 1]);
+        }
+        bench::consume(results.data());
+    }) / n;
+    const auto library = bench::measure(100, [&]
+    {
+        for (size_t i = 0; i < n; ++i)
+        {
+            results[i] = as[i] * bs[i + 1];
+        }
+        bench::consume(results.data());
+    }) / n;
+    const auto inversion = bench::measure(100, [&]
+    {
+        for (size_t i = 0; i < n; ++i)
+        {
+            results[i] = inverse(as[i]);
+        }
+        bench::consume(results.data());
+    }) / n;
+
+#ifdef KILLME_SSE
+    const auto path = "SSE";
+#else
+    const auto path = "scalar";
+#endif
+    bench::report("multiply (scalar reference): %.2f ns", scalar);
+    bench::report("multiply (%s): %.2f ns, %.2fx", path, library, scalar / library);
+    bench::report("inverse (%s): %.2f ns", path, inversion);
+}
\ No newline at end of file
@@ -0,0 +1,186 @@
+#include "bench.h"
+#include "renderer/commandstream.h"
+#include "renderer/rendersystem.h"
+#include "renderer/renderdevice.h"
+#include "renderer/commandlist.h"
+#include "renderer/commandqueue.h"
+#include "renderer/gpuresource.h"
+#include <vector>
+
+using namespace killme;
+
+namespace
+{
+    template <class F>
+    bool throwsInvalidCommand(F f)
+    {
+        try
+        {
+            f();
+        }
+        catch (const InvalidCommandException&)
+        {
+            return true;
+        }
+        return false;
+    }
+
+    bool sameCommand(const RecordedCommand& a, const RecordedCommand& b)
+    {
+        return a.type == b.type && a.object == b.object && a.value == b.value;
+    }
+
+    // Record the commands of GraphicsSystem::clearBackBuffer(), and return the commands executed in the frame
+    std::vector<RecordedCommand> clearFrame(RenderSystem& system)
+    {
+        const auto device = system.getDevice();
+        const auto frame = system.getCurrentFrameResource();
+        const auto allocator = device->obtainCommandAllocator();
+        const auto commands = device->obtainCommandList(allocator, nullptr);
+        commands->transitionBarrior(frame.backBuffer, GpuResourceState::present, GpuResourceState::renderTarget);
+        commands->clearRenderTarget(frame.backBufferLocation, { 0.1f, 0.1f, 0.1f, 1 });
+        commands->transitionBarrior(frame.backBuffer, GpuResourceState::renderTarget, GpuResourceState::present);
+        commands->clearDepthStencil(frame.depthStencilLocation, 1);
+        commands->close();
+
+        const auto commandExe = { commands };
+        device->getCommandQueue()->executeCommands(commandExe);
+        device->reuseCommandAllocatorAfterExecution(allocator);
+        device->reuseCommandListAfterExecution(commands);
+
+        const auto executed = device->getCommandQueue()->getExecutedCommands().getCommands();
+        std::vector<RecordedCommand> result(std::cbegin(executed), std::cend(executed));
+        system.presentBackBuffer();
+        return result;
+    }
+}
+
+KILLME_BENCH(CommandStreamValidation)
+{
+    const auto from = [](uint64_t before, uint64_t after) { return packResourceStates(before, after); };
+
+    CommandStream stream;
+    bench::check(throwsInvalidCommand([&] { stream.record(CommandType::draw, 0, 3); }), "drawing without a pipeline state throws");
+    stream.record(CommandType::setPipelineState, 1, 0);
+    bench::check(!throwsInvalidCommand([&] { stream.record(CommandType::drawIndexed, 0, 6); }), "drawing with a pipeline state is valid");
+
+    // The first transition defines the state, and the later ones must begin from it
+    stream.record(CommandType::transitionBarrior, 10, from(1, 2));
+    bench::check(throwsInvalidCommand([&] { stream.record(CommandType::transitionBarrior, 10, from(1, 3)); }), "a transition from a wrong state throws");
+    bench::check(throwsInvalidCommand([&] { stream.record(CommandType::transitionBarrior, 10, from(2, 2)); }), "a transition into the same state throws");
+    bench::check(!throwsInvalidCommand([&] { stream.record(CommandType::transitionBarrior, 10, from(2, 3)); }), "a transition from the current state is valid");
+
+    // Seeded states are validated, and erased states are forgotten
+    stream.setResourceState(20, 4);
+    bench::check(throwsInvalidCommand([&] { stream.record(CommandType::transitionBarrior, 20, from(5, 6)); }), "a seeded state is validated");
+    stream.eraseResourceState(20);
+    bench::check(!throwsInvalidCommand([&] { stream.record(CommandType::transitionBarrior, 20, from(5, 6)); }), "an erased state is forgotten");
+
+    // Constants are copied when recorded
+    float constants[4] = { 1, 2, 3, 4 };
+    stream.recordConstants(constants, sizeof(constants));
+    constants[0] = 100;
+    const auto& recorded = *(std::cend(stream.getCommands()) - 1);
+    bench::check(static_cast<const float*>(stream.getConstants(recorded))[0] == 1, "constants are copied when recorded");
+
+    bench::check(stream.count(CommandType::transitionBarrior) == 3, "only valid commands are recorded");
+    bench::check(stream.getNumCommands() == 6, "every valid command is recorded once");
+
+    // Closed streams reject commands
+    stream.close();
+    bench::check(throwsInvalidCommand([&] { stream.record(CommandType::setPipelineState, 1, 0); }), "recording into a closed stream throws");
+    bench::check(throwsInvalidCommand([&] { stream.close(); }), "closing twice throws");
+
+    // Appended commands are validated with states of the receiving stream
+    CommandStream executed;
+    executed.setResourceState(10, 7);
+    bench::check(throwsInvalidCommand([&] { executed.append(stream); }), "appended transitions are validated with the receiving states");
+
+    CommandStream open;
+    bench::check(throwsInvalidCommand([&] { executed.append(open); }), "appending an open stream throws");
+
+    CommandStream list;
+    list.record(CommandType::setPipelineState, 1, 0);
+    list.record(CommandType::draw, 0, 3);
+    list.close();
+    CommandStream receiver;
+    receiver.append(list);
+    bench::check(receiver.getNumCommands() == 2, "appending copies the commands");
+
+    list.reset();
+    bench::check(throwsInvalidCommand([&] { list.record(CommandType::draw, 0, 3); }), "reset forgets the pipeline state");
+}
+
+KILLME_BENCH(CommandStreamRecording)
+{
+    // A synthetic frame: a pipeline per 16 draws, and constants per draw
+    const size_t numDraws = 10000;
+    const float constants[16] = {};
+    CommandStream stream;
+    const auto time = bench::measure(20, [&]
+    {
+        stream.reset();
+        for (size_t i = 0; i < numDraws; ++i)
+        {
+            if (i % 16 == 0)
+            {
+                stream.record(CommandType::setPipelineState, i / 16, i / 16);
+            }
+            stream.recordConstants(constants, sizeof(constants));
+            stream.record(CommandType::drawIndexed, 0, 36);
+        }
+        stream.close();
+    });
+
+    const auto numCommands = stream.getNumCommands();
+    bench::report("%u commands per frame: %.2f us, %.2f ns per command", static_cast<unsigned>(numCommands), time / 1e3, time / numCommands);
+    bench::check(numCommands == numDraws * 2 + numDraws / 16 + (numDraws % 16 != 0 ? 1 : 0), "every command is recorded");
+    bench::check(stream.count(CommandType::drawIndexed) == numDraws, "every draw is recorded");
+}
+
+KILLME_BENCH(NullDeviceFrame)
+{
+    RenderSystem system(640, 480);
+
+    // Back buffers alternate, so that frames with the same back buffer record the same commands
+    std::vector<std::vector<RecordedCommand>> frames;
+    for (size_t i = 0; i < 4; ++i)
+    {
+        frames.emplace_back(clearFrame(system));
+    }
+
+    bool sameFrames = frames[0].size() == 4 && frames[0].size() == frames[2].size() && frames[0].size() == frames[1].size();
+    bool sameTypes = sameFrames;
+    for (size_t i = 0; sameFrames && i < frames[0].size(); ++i)
+    {
+        sameFrames = sameFrames && sameCommand(frames[0][i], frames[2][i]) && sameCommand(frames[1][i], frames[3][i]);
+        sameTypes = sameTypes && frames[0][i].type == frames[1][i].type && frames[0][i].value == frames[1][i].value;
+    }
+    bench::check(sameFrames, "frames with the same back buffer record the same commands");
+    bench::check(sameTypes, "all frames record the same kinds of commands");
+    bench::check(frames[0].size() == 4 && frames[0][0].object != frames[1][0].object, "back buffers alternate");
+
+    const auto time = bench::measure(1000, [&] { clearFrame(system); });
+    bench::report("clear frame: %.2f us", time / 1e3);
+}
+
+KILLME_BENCH(NullDeviceValidation)
+{
+    RenderSystem system(64, 64);
+    const auto device = system.getDevice();
+    const auto frame = system.getCurrentFrameResource();
+
+    // Back buffers begin in the present state, so a transition from the render target state is invalid
+    const auto allocator = device->obtainCommandAllocator();
+    const auto commands = device->obtainCommandList(allocator, nullptr);
+    commands->transitionBarrior(frame.backBuffer, GpuResourceState::renderTarget, GpuResourceState::present);
+    commands->close();
+
+    const auto commandExe = { commands };
+    bench::check(throwsInvalidCommand([&] { device->getCommandQueue()->executeCommands(commandExe); }),
+        "executing a transition from a wrong state throws");
+
+    const auto drawAllocator = device->obtainCommandAllocator();
+    const auto drawCommands = device->obtainCommandList(drawAllocator, nullptr);
+    bench::check(throwsInvalidCommand([&] { drawCommands->draw(3); }), "drawing without a pipeline state throws");
+}
\ No newline at end of file
@@ -0,0 +1,145 @@
+#include "bench.h"
+#include "processes/processscheduler.h"
+#include "core/threadpool.h"
+#include <unordered_map>
+#include <vector>
+#include <cmath>
+
+using namespace killme;
+
+namespace
+{
+    const size_t NUM_COMPONENTS = 50000;
+
+    // Tickable component state, which a component touches only by itself
+    struct Component
+    {
+        float position;
+        float velocity;
+
+        void tick(float dt)
+        {
+            for (size_t k = 0; k < 16; ++k)
+            {
+                velocity = std::sqrt(velocity * velocity + dt);
+                position += velocity * dt;
+            }
+        }
+    };
+
+    std::vector<Component> makeComponents()
+    {
+        std::vector<Component> components(NUM_COMPONENTS);
+        for (size_t i = 0; i < components.size(); ++i)
+        {
+            components[i].position = 0;
+            components[i].velocity = static_cast<float>(i % 100) * 0.01f;
+        }
+        return components;
+    }
+
+    bool samePositions(const std::vector<Component>& a, const std::vector<Component>& b)
+    {
+        for (size_t i = 0; i < a.size(); ++i)
+        {
+            if (a[i].position != b[i].position)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+KILLME_BENCH(ProcessSchedulerTick)
+{
+    const float dt = 1.0f / 60;
+
+    // The former storage: a hash map of functions called serially
+    auto mapComponents = makeComponents();
+    std::unordered_map<size_t, ProcessFun<float>> map;
+    for (size_t i = 0; i < NUM_COMPONENTS; ++i)
+    {
+        map.emplace(i, [&mapComponents, i](float dt) { mapComponents[i].tick(dt); });
+    }
+    const auto mapTime = bench::measure(10, [&]
+    {
+        for (const auto& pair : map)
+        {
+            pair.second(dt);
+        }
+        bench::consume(mapComponents.data());
+    });
+    bench::report("hash map, serial: %.2f ms", mapTime / 1e6);
+
+    auto serialComponents = makeComponents();
+    ProcessScheduler<float> serialScheduler;
+    std::vector<Process> serialProcesses;
+    for (size_t i = 0; i < NUM_COMPONENTS; ++i)
+    {
+        serialProcesses.emplace_back(serialScheduler.startProcess([&serialComponents, i](float dt) { serialComponents[i].tick(dt); }));
+    }
+    const auto serialTime = bench::measure(10, [&]
+    {
+        serialScheduler.update(dt);
+        bench::consume(serialComponents.data());
+    });
+    bench::report("dense, serial: %.2f ms, %.2fx", serialTime / 1e6, mapTime / serialTime);
+    bench::check(samePositions(mapComponents, serialComponents), "the serial group ticks every component once per update");
+
+    const auto maxThreads = getDefaultNumWorkerThreads();
+    for (size_t numWorkers = 0; numWorkers <= maxThreads; ++numWorkers)
+    {
+        auto components = makeComponents();
+        ProcessScheduler<float> scheduler;
+        std::vector<Process> processes;
+        for (size_t i = 0; i < NUM_COMPONENTS; ++i)
+        {
+            processes.emplace_back(scheduler.startProcess([&components, i](float dt) { components[i].tick(dt); }, ProcessGroup::parallel));
+        }
+
+        ThreadPool pool(numWorkers);
+        const auto time = bench::measure(10, [&]
+        {
+            scheduler.update(pool, dt);
+            bench::consume(components.data());
+        });
+        bench::report("dense, parallel on %u core(s): %.2f ms, %.2fx", static_cast<unsigned>(numWorkers + 1), time / 1e6, mapTime / time);
+        bench::check(samePositions(mapComponents, components), "the parallel group ticks every component once per update");
+    }
+}
+
+KILLME_BENCH(ProcessSchedulerKill)
+{
+    // Kill every other process, so that swap removals move survivors around
+    ProcessScheduler<> scheduler;
+    std::vector<size_t> counts(1000, 0);
+    std::vector<Process> processes;
+    for (size_t i = 0; i < counts.size(); ++i)
+    {
+        processes.emplace_back(scheduler.startProcess([&counts, i] { ++counts[i]; }, i % 3 == 0 ? ProcessGroup::serial : ProcessGroup::parallel));
+    }
+
+    ThreadPool pool(2);
+    scheduler.update(pool);
+    for (size_t i = 0; i < processes.size(); i += 2)
+    {
+        processes[i].kill();
+    }
+    scheduler.update(pool);
+
+    // Restart killed ones, which reuse the freed ids
+    for (size_t i = 0; i < processes.size(); i += 4)
+    {
+        processes[i] = scheduler.startProcess([&counts, i] { counts[i] += 10; }, ProcessGroup::parallel);
+    }
+    scheduler.update(pool);
+
+    bool ok = true;
+    for (size_t i = 0; i < counts.size(); ++i)
+    {
+        const size_t expected = i % 4 == 0 ? 11 : (i % 2 == 0 ? 1 : 3);
+        ok = ok && counts[i] == expected;
+    }
+    bench::check(ok, "killed processes stop and restarted processes run exactly once per update");
+}
\ No newline at end of file
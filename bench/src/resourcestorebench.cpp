@@ -0,0 +1,177 @@
+#include "bench.h"
+#include "resources/resourcemanager.h"
+#include "resources/resource.h"
+#include "core/threadpool.h"
+#include <thread>
+#include <vector>
+#include <string>
+#include <random>
+#include <atomic>
+#include <exception>
+
+using namespace killme;
+
+namespace
+{
+    const size_t RESOURCE_SIZE = 1024;
+
+    struct StressResource : IsResource
+    {
+        std::string path;
+
+        explicit StressResource(const std::string& p)
+            : path(p)
+        {
+        }
+
+        size_t getResourceSize() const override { return RESOURCE_SIZE; }
+    };
+
+    std::vector<ResourceId> makeIds(size_t n)
+    {
+        std::vector<ResourceId> ids;
+        for (size_t i = 0; i < n; ++i)
+        {
+            ids.emplace_back("stress/" + std::to_string(i) + ".stress");
+        }
+        return ids;
+    }
+
+    // Whether a resource is the one loaded for the id
+    bool isResourceOf(const std::shared_ptr<IsResource>& resource, const ResourceId& id)
+    {
+        const auto r = std::dynamic_pointer_cast<StressResource>(resource);
+        return r && r->path == id.getPath();
+    }
+
+    // Run a function on threads concurrently, and return the first exception
+    template <class F>
+    std::exception_ptr runThreads(size_t numThreads, F f)
+    {
+        std::exception_ptr error;
+        std::mutex errorMutex;
+        std::vector<std::thread> threads;
+        for (size_t t = 0; t < numThreads; ++t)
+        {
+            threads.emplace_back([&, t]
+            {
+                try
+                {
+                    f(t);
+                }
+                catch (...)
+                {
+                    std::lock_guard<std::mutex> lock(errorMutex);
+                    error = error ? error : std::current_exception();
+                }
+            });
+        }
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+        return error;
+    }
+}
+
+KILLME_BENCH(ResourceStoreStress)
+{
+    // Mix loads, asynchronous loads, lookups and unloads of few paths under a budget smaller than the paths
+    ResourceStore store;
+    store.registerLoader("stress", [](const std::string& path) { return std::make_shared<StressResource>(path); });
+    store.setMemoryBudget(RESOURCE_SIZE * 32);
+
+    const auto ids = makeIds(128);
+    std::atomic<size_t> numMismatches(0);
+    const auto numThreads = std::max<size_t>(4, getDefaultNumWorkerThreads() + 1);
+
+    const auto error = runThreads(numThreads, [&](size_t t)
+    {
+        std::mt19937 random(static_cast<unsigned>(t));
+        std::uniform_int_distribution<size_t> pick(0, ids.size() - 1);
+        std::uniform_int_distribution<int> op(0, 9);
+        for (size_t i = 0; i < 5000; ++i)
+        {
+            const auto& id = ids[pick(random)];
+            switch (op(random))
+            {
+            case 0:
+                store.unload(id);
+                break;
+            case 1:
+            case 2:
+            {
+                const auto future = store.loadAsync(id);
+                numMismatches += isResourceOf(store.wait(future), id) ? 0 : 1;
+                break;
+            }
+            case 3:
+            case 4:
+            case 5:
+            {
+                const auto resource = store.getLoadedResource(id);
+                numMismatches += !resource || isResourceOf(resource, id) ? 0 : 1;
+                break;
+            }
+            default:
+                numMismatches += isResourceOf(store.load(id), id) ? 0 : 1;
+                break;
+            }
+        }
+    });
+    store.waitForLoading();
+
+    bench::check(!error, "no exception is thrown");
+    bench::check(numMismatches == 0, "every returned resource is the one of the requested path");
+
+    // Nothing is referred out now, so that a load evicts down to the budget
+    store.load(ids[0]);
+    const auto statistics = store.getStatistics();
+    bench::report("%u hits, %u misses, %u evictions", static_cast<unsigned>(statistics.numHits),
+        static_cast<unsigned>(statistics.numMisses), static_cast<unsigned>(statistics.numEvictions));
+    bench::check(statistics.usedMemory % RESOURCE_SIZE == 0, "the used memory is counted per resource");
+    bench::check(statistics.usedMemory <= statistics.memoryBudget, "resources are evicted down to the budget");
+    bench::check(statistics.numEvictions > 0, "resources are evicted over the budget");
+
+    for (const auto& id : ids)
+    {
+        store.unload(id);
+    }
+    bench::check(store.getStatistics().usedMemory == 0, "unloading all resources frees all the memory");
+}
+
+KILLME_BENCH(ResourceStoreLookup)
+{
+    // Lookups of loaded resources from 1..N threads, which contend only on a shard
+    ResourceStore store;
+    store.registerLoader("stress", [](const std::string& path) { return std::make_shared<StressResource>(path); });
+    const auto ids = makeIds(1024);
+    for (const auto& id : ids)
+    {
+        store.load(id);
+    }
+
+    const size_t numLookups = 100000;
+    double single = 0;
+    const auto maxThreads = getDefaultNumWorkerThreads() + 1;
+    for (size_t numThreads = 1; numThreads <= maxThreads; ++numThreads)
+    {
+        std::atomic<size_t> numMisses(0);
+        const auto time = bench::measure(3, [&]
+        {
+            runThreads(numThreads, [&](size_t t)
+            {
+                for (size_t i = 0; i < numLookups / numThreads; ++i)
+                {
+                    numMisses += store.getLoadedResource(ids[(i * 7 + t) % ids.size()]) ? 0 : 1;
+                }
+            });
+        });
+        if (numThreads == 1)
+        {
+            single = time;
+        }
+        bench::report("%u thread(s): %.2f ns per lookup, %.2fx", static_cast<unsigned>(numThreads), time / numLookups, single / time);
+        bench::check(numMisses == 0, "loaded resources are found");
+    }
+}
\ No newline at end of file
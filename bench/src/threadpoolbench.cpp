@@ -0,0 +1,80 @@
+#include "bench.h"
+#include "core/threadpool.h"
+#include <vector>
+#include <cmath>
+
+using namespace killme;
+
+namespace
+{
+    // CPU bound work, which does not touch shared memory
+    float work(size_t i)
+    {
+        auto x = static_cast<float>(i);
+        for (size_t k = 0; k < 2000; ++k)
+        {
+            x = std::sqrt(x * x + 1.0f);
+        }
+        return x;
+    }
+}
+
+KILLME_BENCH(ThreadPoolScaling)
+{
+    const size_t n = 4096;
+    std::vector<float> results(n);
+
+    double serial = 0;
+    const auto maxThreads = getDefaultNumWorkerThreads();
+    for (size_t numWorkers = 0; numWorkers <= maxThreads; ++numWorkers)
+    {
+        ThreadPool pool(numWorkers);
+        const auto time = bench::measure(10, [&]
+        {
+            pool.parallelFor(n, [&](size_t i) { results[i] = work(i); });
+            bench::consume(results.data());
+        });
+        if (numWorkers == 0)
+        {
+            serial = time;
+        }
+        bench::report("%u core(s): %.2f ms, %.2fx", static_cast<unsigned>(numWorkers + 1), time / 1e6, serial / time);
+    }
+}
+
+KILLME_BENCH(ThreadPoolNestedWait)
+{
+    // Each task waits for tasks it posts. With one worker, this completes only if waiters keep running tasks.
+    for (size_t numWorkers = 0; numWorkers <= 2; ++numWorkers)
+    {
+        ThreadPool pool(numWorkers);
+        std::vector<std::future<size_t>> outer;
+        for (size_t i = 0; i < 8; ++i)
+        {
+            outer.emplace_back(pool.post([&pool, i]
+            {
+                std::vector<std::future<size_t>> inner;
+                for (size_t k = 0; k < 8; ++k)
+                {
+                    inner.emplace_back(pool.post([i, k] { return i * 8 + k; }));
+                }
+
+                size_t sum = 0;
+                for (auto& f : inner)
+                {
+                    pool.wait(f);
+                    sum += f.get();
+                }
+                return sum;
+            }));
+        }
+
+        size_t total = 0;
+        for (auto& f : outer)
+        {
+            pool.wait(f);
+            total += f.get();
+        }
+        bench::check(total == 64 * 63 / 2, "nested waits finish all tasks");
+    }
+}
\ No newline at end of file
@@ -0,0 +1,97 @@
+#include "bench.h"
+#include "core/variant.h"
+#include "core/math/vector3.h"
+#include <vector>
+#include <string>
+#include <atomic>
+#include <new>
+#include <cstdlib>
+
+// Count heap allocations of the whole program
+namespace
+{
+    std::atomic<size_t> numAllocations(0);
+}
+
+void* operator new(size_t size)
+{
+    ++numAllocations;
+    if (const auto p = std::malloc(size > 0 ? size : 1))
+    {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+using namespace killme;
+
+namespace
+{
+    // Return count of allocations by a function
+    template <class F>
+    size_t countAllocations(F f)
+    {
+        const size_t before = numAllocations;
+        f();
+        return numAllocations - before;
+    }
+
+    template <class T>
+    void benchType(const char* name, const T& value, bool inlined)
+    {
+        const size_t n = 1000;
+        std::vector<Variant> source(n);
+        std::vector<Variant> dest(n);
+
+        const auto numConstructs = countAllocations([&]
+        {
+            for (auto& v : source)
+            {
+                v = value;
+            }
+        });
+        const auto numCopies = countAllocations([&]
+        {
+            for (size_t i = 0; i < n; ++i)
+            {
+                dest[i] = source[i];
+            }
+        });
+        const auto numMoves = countAllocations([&]
+        {
+            for (size_t i = 0; i < n; ++i)
+            {
+                dest[i] = std::move(source[i]);
+            }
+        });
+
+        const auto copy = bench::measure(100, [&]
+        {
+            for (size_t i = 0; i < n; ++i)
+            {
+                source[i] = dest[i];
+            }
+            bench::consume(source.data());
+        }) / n;
+
+        bench::report("%s: %u/%u/%u allocations per %u constructs/copies/moves, copy %.2f ns", name,
+            static_cast<unsigned>(numConstructs), static_cast<unsigned>(numCopies), static_cast<unsigned>(numMoves),
+            static_cast<unsigned>(n), copy);
+        bench::check(inlined ? numConstructs == 0 && numCopies == 0 : numConstructs > 0 && numCopies > 0,
+            std::string(name) + (inlined ? " is stored inline" : " is stored in the heap"));
+        bench::check(numMoves == 0, std::string(name) + " moves without allocation");
+    }
+}
+
+KILLME_BENCH(VariantAllocations)
+{
+    // Inline values allocate nothing. Heap values allocate holders per construct and copy.
+    benchType("float", 1.0f, true);
+    benchType("Vector3", Vector3(1, 2, 3), true);
+    benchType("std::string", std::string(64, 'x'), false);
+}
\ No newline at end of file
@@ -24,11 +24,62 @@ namespace killme
         return format_;
     }
 
+    size_t AudioClip::getResourceSize() const
+    {
+        return size_;
+    }
+
     AudioLoadException::AudioLoadException(const std::string& msg)
         : FileException(msg)
     {
     }
 
+    namespace
+    {
+        std::shared_ptr<AudioClip> readWavAudio(HMMIO mmio)
+        {
+            // Discend into RIFF chank
+            MMCKINFO riffChunk;
+            riffChunk.fccType = mmioFOURCC('W', 'A', 'V', 'E');
+            enforce<AudioLoadException>(
+                mmioDescend(mmio, &riffChunk, nullptr, MMIO_FINDRIFF) == MMSYSERR_NOERROR,
+                "Invalid .wav file format.");
+
+            // Discend into FMT chank
+            MMCKINFO fmtChunk;
+            fmtChunk.ckid = mmioFOURCC('f', 'm', 't', ' ');
+            enforce<AudioLoadException>(
+                mmioDescend(mmio, &fmtChunk, &riffChunk, MMIO_FINDCHUNK) == MMSYSERR_NOERROR,
+                "Invalid .wav file format.");
+
+            // Read audio format
+            WAVEFORMATEX format;
+            enforce<AudioLoadException>(
+                mmioRead(mmio, reinterpret_cast<LPSTR>(&format), fmtChunk.cksize) == fmtChunk.cksize,
+                "Invalid .wav file format.");
+
+            // Ascend from FMT chack
+            enforce<AudioLoadException>(
+                mmioAscend(mmio, &fmtChunk, 0) == MMSYSERR_NOERROR,
+                "Invalid .wav file format.");
+
+            // Discend into DATA chank
+            MMCKINFO dataChunk;
+            dataChunk.ckid = mmioFOURCC('d', 'a', 't', 'a');
+            enforce<AudioLoadException>(
+                mmioDescend(mmio, &dataChunk, &riffChunk, MMIO_FINDCHUNK) == MMSYSERR_NOERROR,
+                "Invalid .wav file format.");
+
+            // Read audio data
+            const auto data = new char[dataChunk.cksize];
+            enforce<AudioLoadException>(
+                mmioRead(mmio, data, dataChunk.cksize) == dataChunk.cksize,
+                "Invalid .wav file format.");
+
+            return std::make_shared<AudioClip>(reinterpret_cast<unsigned char*>(data), dataChunk.cksize, format);
+        }
+    }
+
     std::shared_ptr<AudioClip> loadWavAudio(const tstring& path)
     {
         // Open file
@@ -38,45 +89,23 @@ namespace killme
             );
 
         KILLME_SCOPE_EXIT{ mmioClose(mmio, 0); };
+        return readWavAudio(mmio);
+    }
+
+    std::shared_ptr<AudioClip> loadWavAudio(const unsigned char* data, size_t size)
+    {
+        // Open memory
+        MMIOINFO info = {};
+        info.fccIOProc = FOURCC_MEM;
+        info.pchBuffer = reinterpret_cast<HPSTR>(const_cast<unsigned char*>(data));
+        info.cchBuffer = static_cast<LONG>(size);
 
-        // Discend into RIFF chank
-        MMCKINFO riffChunk;
-        riffChunk.fccType = mmioFOURCC('W', 'A', 'V', 'E');
-        enforce<AudioLoadException>(
-            mmioDescend(mmio, &riffChunk, nullptr, MMIO_FINDRIFF) == MMSYSERR_NOERROR,
-            "Invalid .wav file format.");
-
-        // Discend into FMT chank
-        MMCKINFO fmtChunk;
-        fmtChunk.ckid = mmioFOURCC('f', 'm', 't', ' ');
-        enforce<AudioLoadException>(
-            mmioDescend(mmio, &fmtChunk, &riffChunk, MMIO_FINDCHUNK) == MMSYSERR_NOERROR,
-            "Invalid .wav file format.");
-
-        // Read audio format
-        WAVEFORMATEX format;
-        enforce<AudioLoadException>(
-            mmioRead(mmio, reinterpret_cast<LPSTR>(&format), fmtChunk.cksize) == fmtChunk.cksize,
-            "Invalid .wav file format.");
-
-        // Ascend from FMT chack
-        enforce<AudioLoadException>(
-            mmioAscend(mmio, &fmtChunk, 0) == MMSYSERR_NOERROR,
-            "Invalid .wav file format.");
-
-        // Discend into DATA chank
-        MMCKINFO dataChunk;
-        dataChunk.ckid = mmioFOURCC('d', 'a', 't', 'a');
-        enforce<AudioLoadException>(
-            mmioDescend(mmio, &dataChunk, &riffChunk, MMIO_FINDCHUNK) == MMSYSERR_NOERROR,
-            "Invalid .wav file format.");
-
-        // Read audio data
-        const auto data = new char[dataChunk.cksize];
-        enforce<AudioLoadException>(
-            mmioRead(mmio, data, dataChunk.cksize) == dataChunk.cksize,
-            "Invalid .wav file format.");
-
-        return std::make_shared<AudioClip>(reinterpret_cast<unsigned char*>(data), dataChunk.cksize, format);
+        const auto mmio = enforce<AudioLoadException>(
+            mmioOpen(nullptr, &info, MMIO_READ),
+            "Failed to open .wav data on memory."
+            );
+
+        KILLME_SCOPE_EXIT{ mmioClose(mmio, 0); };
+        return readWavAudio(mmio);
     }
 }
\ No newline at end of file
@@ -30,6 +30,9 @@ namespace killme
 
         /** Return the audio format */
         WAVEFORMATEX getFormat() const;
+
+        /** Return the memory size */
+        size_t getResourceSize() const;
     };
 
     /** Loading audio exception */
@@ -42,6 +45,9 @@ namespace killme
 
     /** Load an audio from .wav file */
     std::shared_ptr<AudioClip> loadWavAudio(const tstring& path);
+
+    /** Load an audio from .wav data on memory */
+    std::shared_ptr<AudioClip> loadWavAudio(const unsigned char* data, size_t size);
 }
 
 #endif
\ No newline at end of file
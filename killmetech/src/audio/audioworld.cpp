@@ -15,6 +15,7 @@ namespace killme
         , listeners_()
         , emitters_()
         , mainListener_()
+        , simulating_(false)
     {
         /// TODO: Initializing X3DAudio handle every create the world may be heavy cost
         enforce<XAudioException>(
@@ -24,6 +25,7 @@ namespace killme
 
     void AudioWorld::setMainListener(const std::shared_ptr<AudioListener>& listener)
     {
+        assert(!simulating_ && "The audio world must not be modified during the simulation.");
         assert((!listener || listeners_.find(listener) != std::cend(listeners_)) && "This audio listener is not exists in this world.");
         mainListener_ = listener;
     }
@@ -35,11 +37,13 @@ namespace killme
 
     void AudioWorld::addListener(const std::shared_ptr<AudioListener>& listener)
     {
+        assert(!simulating_ && "The audio world must not be modified during the simulation.");
         listeners_.emplace(listener);
     }
 
     void AudioWorld::removeListener(const std::shared_ptr<AudioListener>& listener)
     {
+        assert(!simulating_ && "The audio world must not be modified during the simulation.");
         listeners_.erase(listener);
         if (listener == mainListener_)
         {
@@ -49,11 +53,13 @@ namespace killme
 
     void AudioWorld::addEmitter(const std::shared_ptr<AudioEmitter>& emitter)
     {
+        assert(!simulating_ && "The audio world must not be modified during the simulation.");
         emitters_.emplace(emitter);
     }
 
     void AudioWorld::removeEmitter(const std::shared_ptr<AudioEmitter>& emitter)
     {
+        assert(!simulating_ && "The audio world must not be modified during the simulation.");
         emitters_.erase(emitter);
     }
 
@@ -66,6 +72,13 @@ namespace killme
     }
 
     void AudioWorld::simulate()
+    {
+        simulating_ = true;
+        simulateImpl();
+        simulating_ = false;
+    }
+
+    void AudioWorld::simulateImpl()
     {
         if (!mainListener_)
         {
@@ -11,6 +11,7 @@
 #include <vector>
 #include <unordered_set>
 #include <memory>
+#include <atomic>
 
 namespace killme
 {
@@ -46,6 +47,7 @@ namespace killme
         std::unordered_set<std::shared_ptr<AudioListener>> listeners_;
         std::unordered_set<std::shared_ptr<AudioEmitter>> emitters_;
         std::shared_ptr<AudioListener> mainListener_;
+        std::atomic<bool> simulating_;
 
     public:
         /** Construct */
@@ -70,7 +72,11 @@ namespace killme
         void removeEmitter(const std::shared_ptr<AudioEmitter>& emitter);
 
         /** Simulate 3D audio */
+        /// NOTE: This may be called on a worker thread. The world must not be modified until this returns, which is asserted.
         void simulate();
+
+    private:
+        void simulateImpl();
     };
 }
 
@@ -0,0 +1,190 @@
+#include "boundingvolume.h"
+#include "matrix44.h"
+#include <algorithm>
+#include <utility>
+#include <cmath>
+
+namespace killme
+{
+    BoundingBox::BoundingBox(const Vector3& lower_, const Vector3& upper_)
+        : lower(lower_)
+        , upper(upper_)
+    {
+    }
+
+    Vector3 BoundingBox::getCenter() const
+    {
+        return (lower + upper) * 0.5f;
+    }
+
+    Vector3 BoundingBox::getExtent() const
+    {
+        return (upper - lower) * 0.5f;
+    }
+
+    BoundingSphere::BoundingSphere()
+        : center()
+        , radius(0)
+    {
+    }
+
+    BoundingSphere::BoundingSphere(const Vector3& center_, float radius_)
+        : center(center_)
+        , radius(radius_)
+    {
+    }
+
+    BoundingBox makeBoundingBox(const float* positions, size_t numPositions)
+    {
+        if (numPositions == 0)
+        {
+            return BoundingBox();
+        }
+
+        BoundingBox box(
+            Vector3(positions[0], positions[1], positions[2]),
+            Vector3(positions[0], positions[1], positions[2]));
+        for (size_t i = 1; i < numPositions; ++i)
+        {
+            const auto p = positions + i * 3;
+            box.lower.x = std::min(box.lower.x, p[0]);
+            box.lower.y = std::min(box.lower.y, p[1]);
+            box.lower.z = std::min(box.lower.z, p[2]);
+            box.upper.x = std::max(box.upper.x, p[0]);
+            box.upper.y = std::max(box.upper.y, p[1]);
+            box.upper.z = std::max(box.upper.z, p[2]);
+        }
+        return box;
+    }
+
+    BoundingSphere makeBoundingSphere(const float* positions, size_t numPositions)
+    {
+        // The center of the box is not the minimal, but it is close enough for culling
+        const auto center = makeBoundingBox(positions, numPositions).getCenter();
+
+        float radiusSq = 0;
+        for (size_t i = 0; i < numPositions; ++i)
+        {
+            const auto p = positions + i * 3;
+            const auto dx = p[0] - center.x;
+            const auto dy = p[1] - center.y;
+            const auto dz = p[2] - center.z;
+            radiusSq = std::max(radiusSq, dx * dx + dy * dy + dz * dz);
+        }
+        return BoundingSphere(center, std::sqrt(radiusSq));
+    }
+
+    BoundingBox transformBoundingBox(const BoundingBox& box, const Matrix44& m)
+    {
+        const auto c = box.getCenter();
+        const auto e = box.getExtent();
+
+        Vector3 center;
+        transformPositions(&c, m, &center, 1);
+
+        // Each extent of the new box is the sum of projected extents of the old box
+        Vector3 extent;
+        for (size_t j = 0; j < 3; ++j)
+        {
+            extent[j] = std::abs(m(0, j)) * e.x + std::abs(m(1, j)) * e.y + std::abs(m(2, j)) * e.z;
+        }
+
+        return BoundingBox(center - extent, center + extent);
+    }
+
+    BoundingSphere transformBoundingSphere(const BoundingSphere& sphere, const Matrix44& m)
+    {
+        Vector3 center;
+        transformPositions(&sphere.center, m, &center, 1);
+
+        // Scale the radius by the longest axis
+        float scaleSq = 0;
+        for (size_t i = 0; i < 3; ++i)
+        {
+            scaleSq = std::max(scaleSq, m(i, 0) * m(i, 0) + m(i, 1) * m(i, 1) + m(i, 2) * m(i, 2));
+        }
+
+        return BoundingSphere(center, sphere.radius * std::sqrt(scaleSq));
+    }
+
+    BoundingBox merge(const BoundingBox& a, const BoundingBox& b)
+    {
+        return BoundingBox(
+            Vector3(std::min(a.lower.x, b.lower.x), std::min(a.lower.y, b.lower.y), std::min(a.lower.z, b.lower.z)),
+            Vector3(std::max(a.upper.x, b.upper.x), std::max(a.upper.y, b.upper.y), std::max(a.upper.z, b.upper.z)));
+    }
+
+    BoundingBox enlarge(const BoundingBox& box, float margin)
+    {
+        const Vector3 m(margin, margin, margin);
+        return BoundingBox(box.lower - m, box.upper + m);
+    }
+
+    float getSurfaceArea(const BoundingBox& box)
+    {
+        const auto size = box.upper - box.lower;
+        return 2 * (size.x * size.y + size.y * size.z + size.z * size.x);
+    }
+
+    bool contains(const BoundingBox& a, const BoundingBox& b)
+    {
+        return a.lower.x <= b.lower.x && a.lower.y <= b.lower.y && a.lower.z <= b.lower.z &&
+            b.upper.x <= a.upper.x && b.upper.y <= a.upper.y && b.upper.z <= a.upper.z;
+    }
+
+    bool intersects(const BoundingBox& a, const BoundingBox& b)
+    {
+        return a.lower.x <= b.upper.x && b.lower.x <= a.upper.x &&
+            a.lower.y <= b.upper.y && b.lower.y <= a.upper.y &&
+            a.lower.z <= b.upper.z && b.lower.z <= a.upper.z;
+    }
+
+    bool intersects(const BoundingBox& box, const BoundingSphere& sphere)
+    {
+        // Distance from the center to the closest point in the box
+        float distSq = 0;
+        for (size_t i = 0; i < 3; ++i)
+        {
+            const auto c = sphere.center[i];
+            const auto d = c < box.lower[i] ? box.lower[i] - c : (c > box.upper[i] ? c - box.upper[i] : 0);
+            distSq += d * d;
+        }
+        return distSq <= sphere.radius * sphere.radius;
+    }
+
+    bool intersectsRay(const BoundingBox& box, const Vector3& origin, const Vector3& direction, float maxDistance, float& distance)
+    {
+        // Clip the ray by the slabs of each axis
+        auto tMin = 0.0f;
+        auto tMax = maxDistance;
+        for (size_t i = 0; i < 3; ++i)
+        {
+            if (direction[i] == 0)
+            {
+                if (origin[i] < box.lower[i] || origin[i] > box.upper[i])
+                {
+                    return false;
+                }
+                continue;
+            }
+
+            const auto invDir = 1 / direction[i];
+            auto t1 = (box.lower[i] - origin[i]) * invDir;
+            auto t2 = (box.upper[i] - origin[i]) * invDir;
+            if (t1 > t2)
+            {
+                std::swap(t1, t2);
+            }
+
+            tMin = std::max(tMin, t1);
+            tMax = std::min(tMax, t2);
+            if (tMin > tMax)
+            {
+                return false;
+            }
+        }
+
+        distance = tMin;
+        return true;
+    }
+}
\ No newline at end of file
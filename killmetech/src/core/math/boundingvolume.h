@@ -0,0 +1,76 @@
+#ifndef _KILLME_BOUNDINGVOLUME_H_
+#define _KILLME_BOUNDINGVOLUME_H_
+
+#include "vector3.h"
+
+namespace killme
+{
+    class Matrix44;
+
+    /** Axis aligned bounding box */
+    class BoundingBox
+    {
+    public:
+        /** Elements */
+        Vector3 lower, upper;
+
+        /** Construct as the empty box at the origin */
+        BoundingBox() = default;
+
+        /** Construct with corners */
+        BoundingBox(const Vector3& lower_, const Vector3& upper_);
+
+        /** Return the center */
+        Vector3 getCenter() const;
+
+        /** Return the half size */
+        Vector3 getExtent() const;
+    };
+
+    /** Bounding sphere */
+    class BoundingSphere
+    {
+    public:
+        /** Elements */
+        Vector3 center;
+        float radius;
+
+        /** Construct as the empty sphere at the origin */
+        BoundingSphere();
+
+        /** Construct with initial values */
+        BoundingSphere(const Vector3& center_, float radius_);
+    };
+
+    /** Compute bounds of positions packed as (x, y, z) */
+    BoundingBox makeBoundingBox(const float* positions, size_t numPositions);
+    BoundingSphere makeBoundingSphere(const float* positions, size_t numPositions);
+
+    /** Return bounds of the transformed volume */
+    /// NOTE: The box is the axis aligned box of the transformed box.
+    BoundingBox transformBoundingBox(const BoundingBox& box, const Matrix44& m);
+    BoundingSphere transformBoundingSphere(const BoundingSphere& sphere, const Matrix44& m);
+
+    /** Return the smallest box containing both boxes */
+    BoundingBox merge(const BoundingBox& a, const BoundingBox& b);
+
+    /** Return the box enlarged by the margin in all directions */
+    BoundingBox enlarge(const BoundingBox& box, float margin);
+
+    /** Return the surface area */
+    float getSurfaceArea(const BoundingBox& box);
+
+    /** Return whether the box "a" contains the box "b" */
+    bool contains(const BoundingBox& a, const BoundingBox& b);
+
+    /** Return whether volumes overlap */
+    bool intersects(const BoundingBox& a, const BoundingBox& b);
+    bool intersects(const BoundingBox& box, const BoundingSphere& sphere);
+
+    /** Return whether the ray hits the box within the max distance. The distance is stored into "distance". */
+    /// NOTE: If the origin is inside the box, the distance is 0. The direction need not be normalized,
+    ///       then the distance is measured in units of the direction length.
+    bool intersectsRay(const BoundingBox& box, const Vector3& origin, const Vector3& direction, float maxDistance, float& distance);
+}
+
+#endif
\ No newline at end of file
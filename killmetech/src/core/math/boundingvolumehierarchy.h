@@ -0,0 +1,436 @@
+#ifndef _KILLME_BOUNDINGVOLUMEHIERARCHY_H_
+#define _KILLME_BOUNDINGVOLUMEHIERARCHY_H_
+
+#include "boundingvolume.h"
+#include "frustum.h"
+#include "vector3.h"
+#include <vector>
+#include <algorithm>
+#include <cassert>
+
+namespace killme
+{
+    /** Dynamic bounding volume hierarchy of axis aligned boxes */
+    /// NOTE: Leaves store boxes enlarged by the margin, so that small moves do not change the tree.
+    ///       Leaves are inserted at the sibling of the least surface area cost, and the tree is kept balanced by
+    ///       rotations like the AVL tree. So a proxy is moved in O(log n), and a query visits O(log n + k) nodes.
+    template <class T>
+    class BoundingVolumeHierarchy
+    {
+    public:
+        /** Proxy identifier */
+        /// NOTE: An identifier is stable while the proxy is alive.
+        using ProxyId = size_t;
+
+        /** Invalid proxy identifier */
+        static const ProxyId NONE = static_cast<ProxyId>(-1);
+
+    private:
+        // The tree is balanced, so the height is less than 1.44 * log2(count of nodes)
+        static const size_t MAX_STACK_SIZE = 64;
+
+        struct Node
+        {
+            BoundingBox box;
+            T data;
+            ProxyId parent; // Next free node for free nodes
+            ProxyId child1;
+            ProxyId child2;
+            int height; // 0 for leaves, -1 for free nodes
+        };
+
+        std::vector<Node> nodes_;
+        ProxyId root_;
+        ProxyId freeList_;
+        size_t numProxies_;
+        float margin_;
+
+    public:
+        /** Construct with the margin of boxes */
+        explicit BoundingVolumeHierarchy(float margin = 0.1f)
+            : nodes_()
+            , root_(NONE)
+            , freeList_(NONE)
+            , numProxies_(0)
+            , margin_(margin)
+        {}
+
+        /** Add a proxy */
+        ProxyId createProxy(const BoundingBox& box, const T& data)
+        {
+            const auto proxy = allocateNode();
+            nodes_[proxy].box = enlarge(box, margin_);
+            nodes_[proxy].data = data;
+            nodes_[proxy].height = 0;
+            insertLeaf(proxy);
+            ++numProxies_;
+            return proxy;
+        }
+
+        /** Remove a proxy */
+        void destroyProxy(ProxyId proxy)
+        {
+            assert(isLeaf(proxy) && "Invalid proxy.");
+            removeLeaf(proxy);
+            freeNode(proxy);
+            --numProxies_;
+        }
+
+        /** Move a proxy. Return whether the tree is changed. */
+        /// NOTE: If the new box is in the enlarged box, only the box is kept.
+        bool moveProxy(ProxyId proxy, const BoundingBox& box)
+        {
+            assert(isLeaf(proxy) && "Invalid proxy.");
+            if (contains(nodes_[proxy].box, box))
+            {
+                return false;
+            }
+
+            removeLeaf(proxy);
+            nodes_[proxy].box = enlarge(box, margin_);
+            insertLeaf(proxy);
+            return true;
+        }
+
+        /** Return the data */
+        const T& getData(ProxyId proxy) const
+        {
+            assert(isLeaf(proxy) && "Invalid proxy.");
+            return nodes_[proxy].data;
+        }
+
+        /** Return the enlarged box */
+        const BoundingBox& getBoundingBox(ProxyId proxy) const
+        {
+            assert(isLeaf(proxy) && "Invalid proxy.");
+            return nodes_[proxy].box;
+        }
+
+        /** Return count of proxies */
+        size_t getNumProxies() const
+        {
+            return numProxies_;
+        }
+
+        /** Return the height of the tree */
+        int getHeight() const
+        {
+            return root_ == NONE ? 0 : nodes_[root_].height;
+        }
+
+        /** Call f(data) for each proxy whose enlarged box overlaps the volume */
+        template <class F>
+        void query(const Frustum& frustum, F f) const
+        {
+            traverse([&](const BoundingBox& box) { return frustum.intersects(box); }, f);
+        }
+
+        template <class F>
+        void query(const BoundingBox& volume, F f) const
+        {
+            traverse([&](const BoundingBox& box) { return intersects(box, volume); }, f);
+        }
+
+        template <class F>
+        void query(const BoundingSphere& volume, F f) const
+        {
+            traverse([&](const BoundingBox& box) { return intersects(box, volume); }, f);
+        }
+
+        /** Call f(data, distance) for each proxy whose enlarged box is hit by the ray */
+        /// NOTE: "f" returns the new max distance. Return the distance to find the closest hit,
+        ///       the "maxDistance" to find all hits, or 0 to stop.
+        template <class F>
+        void rayCast(const Vector3& origin, const Vector3& direction, float maxDistance, F f) const
+        {
+            if (root_ == NONE)
+            {
+                return;
+            }
+
+            // Traverse without allocations
+            ProxyId stack[MAX_STACK_SIZE];
+            size_t top = 0;
+            stack[top++] = root_;
+            while (top > 0)
+            {
+                const auto& node = nodes_[stack[--top]];
+
+                float distance;
+                if (!intersectsRay(node.box, origin, direction, maxDistance, distance))
+                {
+                    continue;
+                }
+
+                if (node.height == 0)
+                {
+                    maxDistance = f(node.data, distance);
+                    if (maxDistance <= 0)
+                    {
+                        return;
+                    }
+                }
+                else
+                {
+                    assert(top + 2 <= MAX_STACK_SIZE && "Stack overflow.");
+                    stack[top++] = node.child1;
+                    stack[top++] = node.child2;
+                }
+            }
+        }
+
+    private:
+        bool isLeaf(ProxyId id) const
+        {
+            return id < nodes_.size() && nodes_[id].height == 0;
+        }
+
+        template <class Test, class F>
+        void traverse(Test test, F& f) const
+        {
+            if (root_ == NONE)
+            {
+                return;
+            }
+
+            // Traverse without allocations
+            ProxyId stack[MAX_STACK_SIZE];
+            size_t top = 0;
+            stack[top++] = root_;
+            while (top > 0)
+            {
+                const auto& node = nodes_[stack[--top]];
+
+                if (!test(node.box))
+                {
+                    continue;
+                }
+
+                if (node.height == 0)
+                {
+                    f(node.data);
+                }
+                else
+                {
+                    assert(top + 2 <= MAX_STACK_SIZE && "Stack overflow.");
+                    stack[top++] = node.child1;
+                    stack[top++] = node.child2;
+                }
+            }
+        }
+
+        ProxyId allocateNode()
+        {
+            if (freeList_ == NONE)
+            {
+                nodes_.emplace_back();
+                freeList_ = nodes_.size() - 1;
+                nodes_[freeList_].parent = NONE;
+            }
+
+            const auto id = freeList_;
+            freeList_ = nodes_[id].parent;
+            nodes_[id].parent = NONE;
+            nodes_[id].child1 = NONE;
+            nodes_[id].child2 = NONE;
+            nodes_[id].height = 0;
+            return id;
+        }
+
+        void freeNode(ProxyId id)
+        {
+            nodes_[id].data = T();
+            nodes_[id].parent = freeList_;
+            nodes_[id].height = -1;
+            freeList_ = id;
+        }
+
+        void insertLeaf(ProxyId leaf)
+        {
+            if (root_ == NONE)
+            {
+                root_ = leaf;
+                nodes_[leaf].parent = NONE;
+                return;
+            }
+
+            // Find the best sibling by the increase of surface areas
+            const auto leafBox = nodes_[leaf].box;
+            auto index = root_;
+            while (nodes_[index].height > 0)
+            {
+                const auto& node = nodes_[index];
+                const auto area = getSurfaceArea(node.box);
+                const auto combinedArea = getSurfaceArea(merge(node.box, leafBox));
+
+                // Cost of creating a new parent for this node and the leaf
+                const auto cost = 2 * combinedArea;
+
+                // Minimum cost of pushing the leaf further down the tree
+                const auto inheritanceCost = 2 * (combinedArea - area);
+                const auto childCost = [&](ProxyId child)
+                {
+                    const auto& c = nodes_[child];
+                    const auto merged = getSurfaceArea(merge(c.box, leafBox));
+                    return (c.height == 0 ? merged : merged - getSurfaceArea(c.box)) + inheritanceCost;
+                };
+                const auto cost1 = childCost(node.child1);
+                const auto cost2 = childCost(node.child2);
+
+                if (cost < cost1 && cost < cost2)
+                {
+                    break;
+                }
+                index = cost1 < cost2 ? node.child1 : node.child2;
+            }
+
+            // Create a new parent
+            const auto sibling = index;
+            const auto oldParent = nodes_[sibling].parent;
+            const auto newParent = allocateNode();
+            nodes_[newParent].parent = oldParent;
+            nodes_[newParent].box = merge(leafBox, nodes_[sibling].box);
+            nodes_[newParent].height = nodes_[sibling].height + 1;
+            nodes_[newParent].child1 = sibling;
+            nodes_[newParent].child2 = leaf;
+            nodes_[sibling].parent = newParent;
+            nodes_[leaf].parent = newParent;
+
+            if (oldParent == NONE)
+            {
+                root_ = newParent;
+            }
+            else if (nodes_[oldParent].child1 == sibling)
+            {
+                nodes_[oldParent].child1 = newParent;
+            }
+            else
+            {
+                nodes_[oldParent].child2 = newParent;
+            }
+
+            fixUpward(nodes_[leaf].parent);
+        }
+
+        void removeLeaf(ProxyId leaf)
+        {
+            if (leaf == root_)
+            {
+                root_ = NONE;
+                return;
+            }
+
+            const auto parent = nodes_[leaf].parent;
+            const auto grandParent = nodes_[parent].parent;
+            const auto sibling = nodes_[parent].child1 == leaf ? nodes_[parent].child2 : nodes_[parent].child1;
+
+            // Replace the parent with the sibling
+            nodes_[sibling].parent = grandParent;
+            freeNode(parent);
+            if (grandParent == NONE)
+            {
+                root_ = sibling;
+            }
+            else
+            {
+                if (nodes_[grandParent].child1 == parent)
+                {
+                    nodes_[grandParent].child1 = sibling;
+                }
+                else
+                {
+                    nodes_[grandParent].child2 = sibling;
+                }
+                fixUpward(grandParent);
+            }
+        }
+
+        // Rebalance and refit ancestors
+        void fixUpward(ProxyId index)
+        {
+            while (index != NONE)
+            {
+                index = balance(index);
+
+                auto& node = nodes_[index];
+                const auto& c1 = nodes_[node.child1];
+                const auto& c2 = nodes_[node.child2];
+                node.height = 1 + std::max(c1.height, c2.height);
+                node.box = merge(c1.box, c2.box);
+
+                index = node.parent;
+            }
+        }
+
+        // Rotate the higher child up if the node is imbalanced. Return the root of the subtree.
+        ProxyId balance(ProxyId a)
+        {
+            if (nodes_[a].height < 2)
+            {
+                return a;
+            }
+
+            const auto b = nodes_[a].child1;
+            const auto c = nodes_[a].child2;
+            const auto diff = nodes_[c].height - nodes_[b].height;
+            if (diff > 1)
+            {
+                return rotate(a, c, false);
+            }
+            if (diff < -1)
+            {
+                return rotate(a, b, true);
+            }
+            return a;
+        }
+
+        // Move the child "up" to the place of "a", and "a" becomes a child of "up"
+        ProxyId rotate(ProxyId a, ProxyId up, bool upIsChild1)
+        {
+            const auto other = upIsChild1 ? nodes_[a].child2 : nodes_[a].child1;
+            const auto f = nodes_[up].child1;
+            const auto g = nodes_[up].child2;
+
+            // Swap "a" and "up"
+            nodes_[up].child1 = a;
+            nodes_[up].parent = nodes_[a].parent;
+            nodes_[a].parent = up;
+
+            const auto upParent = nodes_[up].parent;
+            if (upParent == NONE)
+            {
+                root_ = up;
+            }
+            else if (nodes_[upParent].child1 == a)
+            {
+                nodes_[upParent].child1 = up;
+            }
+            else
+            {
+                nodes_[upParent].child2 = up;
+            }
+
+            // The higher grandchild stays under "up", and the lower one moves under "a"
+            const auto keep = nodes_[f].height > nodes_[g].height ? f : g;
+            const auto move = keep == f ? g : f;
+            nodes_[up].child2 = keep;
+            if (upIsChild1)
+            {
+                nodes_[a].child1 = move;
+            }
+            else
+            {
+                nodes_[a].child2 = move;
+            }
+            nodes_[move].parent = a;
+
+            nodes_[a].box = merge(nodes_[other].box, nodes_[move].box);
+            nodes_[a].height = 1 + std::max(nodes_[other].height, nodes_[move].height);
+            nodes_[up].box = merge(nodes_[a].box, nodes_[keep].box);
+            nodes_[up].height = 1 + std::max(nodes_[a].height, nodes_[keep].height);
+            return up;
+        }
+    };
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,111 @@
+#include "frustum.h"
+#include "boundingvolume.h"
+#include "matrix44.h"
+#include "../platform.h"
+#include <algorithm>
+#include <cmath>
+
+#ifdef KILLME_SSE
+#include <xmmintrin.h>
+#endif
+
+namespace killme
+{
+    Frustum::Frustum(const Matrix44& viewProj)
+    {
+        // Rows are transformed as (x, y, z, 1) * viewProj, so the clip coordinates are dot products with the columns
+        // Inside points satisfy -w <= x <= w, -w <= y <= w and 0 <= z <= w
+        const auto& m = viewProj;
+        const float planes[6][4] = {
+            { m(0, 3) + m(0, 0), m(1, 3) + m(1, 0), m(2, 3) + m(2, 0), m(3, 3) + m(3, 0) },
+            { m(0, 3) - m(0, 0), m(1, 3) - m(1, 0), m(2, 3) - m(2, 0), m(3, 3) - m(3, 0) },
+            { m(0, 3) + m(0, 1), m(1, 3) + m(1, 1), m(2, 3) + m(2, 1), m(3, 3) + m(3, 1) },
+            { m(0, 3) - m(0, 1), m(1, 3) - m(1, 1), m(2, 3) - m(2, 1), m(3, 3) - m(3, 1) },
+            { m(0, 2), m(1, 2), m(2, 2), m(3, 2) },
+            { m(0, 3) - m(0, 2), m(1, 3) - m(1, 2), m(2, 3) - m(2, 2), m(3, 3) - m(3, 2) }
+        };
+
+        for (size_t i = 0; i < 8; ++i)
+        {
+            // Normalize, so that "ax + by + cz + d" is the distance
+            const auto& p = planes[i % 6];
+            const auto len = std::sqrt(p[0] * p[0] + p[1] * p[1] + p[2] * p[2]);
+            const auto invLen = len > 0 ? 1 / len : 0;
+            a_[i] = p[0] * invLen;
+            b_[i] = p[1] * invLen;
+            c_[i] = p[2] * invLen;
+            d_[i] = p[3] * invLen;
+        }
+    }
+
+    bool Frustum::intersects(const BoundingSphere& sphere) const
+    {
+#ifdef KILLME_SSE
+        const auto x = _mm_set1_ps(sphere.center.x);
+        const auto y = _mm_set1_ps(sphere.center.y);
+        const auto z = _mm_set1_ps(sphere.center.z);
+        const auto r = _mm_set1_ps(-sphere.radius);
+
+        int outside = 0;
+        for (size_t i = 0; i < 8; i += 4)
+        {
+            auto dist = _mm_mul_ps(_mm_loadu_ps(a_ + i), x);
+            dist = _mm_add_ps(dist, _mm_mul_ps(_mm_loadu_ps(b_ + i), y));
+            dist = _mm_add_ps(dist, _mm_mul_ps(_mm_loadu_ps(c_ + i), z));
+            dist = _mm_add_ps(dist, _mm_loadu_ps(d_ + i));
+            outside |= _mm_movemask_ps(_mm_cmplt_ps(dist, r));
+        }
+        return outside == 0;
+#else
+        for (size_t i = 0; i < 6; ++i)
+        {
+            const auto dist = a_[i] * sphere.center.x + b_[i] * sphere.center.y + c_[i] * sphere.center.z + d_[i];
+            if (dist < -sphere.radius)
+            {
+                return false;
+            }
+        }
+        return true;
+#endif
+    }
+
+    bool Frustum::intersects(const BoundingBox& box) const
+    {
+        // Test the corner farthest along the normal of each plane
+#ifdef KILLME_SSE
+        const auto lx = _mm_set1_ps(box.lower.x);
+        const auto ly = _mm_set1_ps(box.lower.y);
+        const auto lz = _mm_set1_ps(box.lower.z);
+        const auto ux = _mm_set1_ps(box.upper.x);
+        const auto uy = _mm_set1_ps(box.upper.y);
+        const auto uz = _mm_set1_ps(box.upper.z);
+
+        int outside = 0;
+        for (size_t i = 0; i < 8; i += 4)
+        {
+            const auto a = _mm_loadu_ps(a_ + i);
+            const auto b = _mm_loadu_ps(b_ + i);
+            const auto c = _mm_loadu_ps(c_ + i);
+            auto dist = _mm_max_ps(_mm_mul_ps(a, lx), _mm_mul_ps(a, ux));
+            dist = _mm_add_ps(dist, _mm_max_ps(_mm_mul_ps(b, ly), _mm_mul_ps(b, uy)));
+            dist = _mm_add_ps(dist, _mm_max_ps(_mm_mul_ps(c, lz), _mm_mul_ps(c, uz)));
+            dist = _mm_add_ps(dist, _mm_loadu_ps(d_ + i));
+            outside |= _mm_movemask_ps(_mm_cmplt_ps(dist, _mm_setzero_ps()));
+        }
+        return outside == 0;
+#else
+        for (size_t i = 0; i < 6; ++i)
+        {
+            const auto dist =
+                std::max(a_[i] * box.lower.x, a_[i] * box.upper.x) +
+                std::max(b_[i] * box.lower.y, b_[i] * box.upper.y) +
+                std::max(c_[i] * box.lower.z, c_[i] * box.upper.z) + d_[i];
+            if (dist < 0)
+            {
+                return false;
+            }
+        }
+        return true;
+#endif
+    }
+}
\ No newline at end of file
@@ -0,0 +1,33 @@
+#ifndef _KILLME_FRUSTUM_H_
+#define _KILLME_FRUSTUM_H_
+
+namespace killme
+{
+    class Matrix44;
+    class BoundingBox;
+    class BoundingSphere;
+
+    /** View frustum for culling */
+    /// NOTE: Planes are stored as the structure of arrays, so that a volume is tested with all planes at once.
+    class Frustum
+    {
+    private:
+        // (a, b, c, d) of the planes "ax + by + cz + d >= 0" for inside points
+        // The planes are left, right, bottom, top, near and far. The last two slots repeat the first two.
+        alignas(16) float a_[8];
+        alignas(16) float b_[8];
+        alignas(16) float c_[8];
+        alignas(16) float d_[8];
+
+    public:
+        /** Construct from the view projection matrix (view * projection) */
+        explicit Frustum(const Matrix44& viewProj);
+
+        /** Return whether the volume is inside or intersects the frustum */
+        /// NOTE: Volumes near corners of the frustum may be regarded as intersecting conservatively.
+        bool intersects(const BoundingSphere& sphere) const;
+        bool intersects(const BoundingBox& box) const;
+    };
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,480 @@
+#include "mathstream.h"
+#include "vector3.h"
+#include "quaternion.h"
+#include "../platform.h"
+#include <cmath>
+#include <cassert>
+
+#ifdef KILLME_SSE
+#include <xmmintrin.h>
+#endif
+
+namespace killme
+{
+    namespace
+    {
+        // Single lane for remainders of packed lanes
+        struct Float1
+        {
+            static constexpr size_t WIDTH = 1;
+            float v;
+
+            static Float1 load(const float* p) { return{ *p }; }
+            static Float1 set(float f) { return{ f }; }
+            void store(float* p) const { *p = v; }
+        };
+
+        Float1 operator +(Float1 a, Float1 b) { return{ a.v + b.v }; }
+        Float1 operator -(Float1 a, Float1 b) { return{ a.v - b.v }; }
+        Float1 operator *(Float1 a, Float1 b) { return{ a.v * b.v }; }
+        Float1 operator /(Float1 a, Float1 b) { return{ a.v / b.v }; }
+        Float1 sqrt(Float1 a) { return{ std::sqrt(a.v) }; }
+
+#ifdef KILLME_SSE
+        // Packed 4 lanes
+        /// NOTE: std::vector does not guarantee 16-byte alignment, so we use unaligned access.
+        struct Float4
+        {
+            static constexpr size_t WIDTH = 4;
+            __m128 v;
+
+            static Float4 load(const float* p) { return{ _mm_loadu_ps(p) }; }
+            static Float4 set(float f) { return{ _mm_set1_ps(f) }; }
+            void store(float* p) const { _mm_storeu_ps(p, v); }
+        };
+
+        Float4 operator +(Float4 a, Float4 b) { return{ _mm_add_ps(a.v, b.v) }; }
+        Float4 operator -(Float4 a, Float4 b) { return{ _mm_sub_ps(a.v, b.v) }; }
+        Float4 operator *(Float4 a, Float4 b) { return{ _mm_mul_ps(a.v, b.v) }; }
+        Float4 operator /(Float4 a, Float4 b) { return{ _mm_div_ps(a.v, b.v) }; }
+        Float4 sqrt(Float4 a) { return{ _mm_sqrt_ps(a.v) }; }
+#endif
+
+        // Call kernel(lane, i) for each lanes. The "lane" is a tag of the lane type.
+        template <class Kernel>
+        void forEachLane(size_t n, Kernel kernel)
+        {
+            size_t i = 0;
+#ifdef KILLME_SSE
+            for (; i + Float4::WIDTH <= n; i += Float4::WIDTH)
+            {
+                kernel(Float4(), i);
+            }
+#endif
+            for (; i < n; ++i)
+            {
+                kernel(Float1(), i);
+            }
+        }
+
+        // Cross product of lanes
+        template <class F>
+        void cross(F ax, F ay, F az, F bx, F by, F bz, F& x, F& y, F& z)
+        {
+            x = ay * bz - az * by;
+            y = az * bx - ax * bz;
+            z = ax * by - ay * bx;
+        }
+    }
+
+    Vector3Stream::Vector3Stream(size_t n)
+        : x_(n)
+        , y_(n)
+        , z_(n)
+    {
+    }
+
+    Vector3Stream::Vector3Stream(const Vector3* vs, size_t n)
+        : x_()
+        , y_()
+        , z_()
+    {
+        load(vs, n);
+    }
+
+    size_t Vector3Stream::size() const
+    {
+        return x_.size();
+    }
+
+    void Vector3Stream::resize(size_t n)
+    {
+        x_.resize(n);
+        y_.resize(n);
+        z_.resize(n);
+    }
+
+    void Vector3Stream::push(const Vector3& v)
+    {
+        x_.emplace_back(v.x);
+        y_.emplace_back(v.y);
+        z_.emplace_back(v.z);
+    }
+
+    void Vector3Stream::clear()
+    {
+        x_.clear();
+        y_.clear();
+        z_.clear();
+    }
+
+    Vector3 Vector3Stream::get(size_t i) const
+    {
+        assert(i < size() && "Index out of range.");
+        return{ x_[i], y_[i], z_[i] };
+    }
+
+    void Vector3Stream::set(size_t i, const Vector3& v)
+    {
+        assert(i < size() && "Index out of range.");
+        x_[i] = v.x;
+        y_[i] = v.y;
+        z_[i] = v.z;
+    }
+
+    void Vector3Stream::load(const Vector3* vs, size_t n)
+    {
+        resize(n);
+        for (size_t i = 0; i < n; ++i)
+        {
+            x_[i] = vs[i].x;
+            y_[i] = vs[i].y;
+            z_[i] = vs[i].z;
+        }
+    }
+
+    void Vector3Stream::store(Vector3* dest) const
+    {
+        const auto n = size();
+        for (size_t i = 0; i < n; ++i)
+        {
+            dest[i].x = x_[i];
+            dest[i].y = y_[i];
+            dest[i].z = z_[i];
+        }
+    }
+
+    QuaternionStream::QuaternionStream(size_t n)
+        : w_(n, 1)
+        , x_(n)
+        , y_(n)
+        , z_(n)
+    {
+    }
+
+    QuaternionStream::QuaternionStream(const Quaternion* qs, size_t n)
+        : w_()
+        , x_()
+        , y_()
+        , z_()
+    {
+        load(qs, n);
+    }
+
+    size_t QuaternionStream::size() const
+    {
+        return w_.size();
+    }
+
+    void QuaternionStream::resize(size_t n)
+    {
+        w_.resize(n, 1);
+        x_.resize(n);
+        y_.resize(n);
+        z_.resize(n);
+    }
+
+    void QuaternionStream::push(const Quaternion& q)
+    {
+        w_.emplace_back(q.w);
+        x_.emplace_back(q.x);
+        y_.emplace_back(q.y);
+        z_.emplace_back(q.z);
+    }
+
+    void QuaternionStream::clear()
+    {
+        w_.clear();
+        x_.clear();
+        y_.clear();
+        z_.clear();
+    }
+
+    Quaternion QuaternionStream::get(size_t i) const
+    {
+        assert(i < size() && "Index out of range.");
+        return{ w_[i], x_[i], y_[i], z_[i] };
+    }
+
+    void QuaternionStream::set(size_t i, const Quaternion& q)
+    {
+        assert(i < size() && "Index out of range.");
+        w_[i] = q.w;
+        x_[i] = q.x;
+        y_[i] = q.y;
+        z_[i] = q.z;
+    }
+
+    void QuaternionStream::load(const Quaternion* qs, size_t n)
+    {
+        resize(n);
+        for (size_t i = 0; i < n; ++i)
+        {
+            w_[i] = qs[i].w;
+            x_[i] = qs[i].x;
+            y_[i] = qs[i].y;
+            z_[i] = qs[i].z;
+        }
+    }
+
+    void QuaternionStream::store(Quaternion* dest) const
+    {
+        const auto n = size();
+        for (size_t i = 0; i < n; ++i)
+        {
+            dest[i].w = w_[i];
+            dest[i].x = x_[i];
+            dest[i].y = y_[i];
+            dest[i].z = z_[i];
+        }
+    }
+
+    void add(const Vector3Stream& a, const Vector3Stream& b, Vector3Stream& dest)
+    {
+        assert(a.size() == b.size() && "Mismatch stream size.");
+        dest.resize(a.size());
+        forEachLane(a.size(), [&](auto lane, size_t i)
+        {
+            using F = decltype(lane);
+            (F::load(a.x() + i) + F::load(b.x() + i)).store(dest.x() + i);
+            (F::load(a.y() + i) + F::load(b.y() + i)).store(dest.y() + i);
+            (F::load(a.z() + i) + F::load(b.z() + i)).store(dest.z() + i);
+        });
+    }
+
+    void subtract(const Vector3Stream& a, const Vector3Stream& b, Vector3Stream& dest)
+    {
+        assert(a.size() == b.size() && "Mismatch stream size.");
+        dest.resize(a.size());
+        forEachLane(a.size(), [&](auto lane, size_t i)
+        {
+            using F = decltype(lane);
+            (F::load(a.x() + i) - F::load(b.x() + i)).store(dest.x() + i);
+            (F::load(a.y() + i) - F::load(b.y() + i)).store(dest.y() + i);
+            (F::load(a.z() + i) - F::load(b.z() + i)).store(dest.z() + i);
+        });
+    }
+
+    void scale(const Vector3Stream& v, float k, Vector3Stream& dest)
+    {
+        dest.resize(v.size());
+        forEachLane(v.size(), [&](auto lane, size_t i)
+        {
+            using F = decltype(lane);
+            const auto fk = F::set(k);
+            (F::load(v.x() + i) * fk).store(dest.x() + i);
+            (F::load(v.y() + i) * fk).store(dest.y() + i);
+            (F::load(v.z() + i) * fk).store(dest.z() + i);
+        });
+    }
+
+    void scale(const Vector3Stream& v, const Vector3Stream& k, Vector3Stream& dest)
+    {
+        assert(v.size() == k.size() && "Mismatch stream size.");
+        dest.resize(v.size());
+        forEachLane(v.size(), [&](auto lane, size_t i)
+        {
+            using F = decltype(lane);
+            (F::load(v.x() + i) * F::load(k.x() + i)).store(dest.x() + i);
+            (F::load(v.y() + i) * F::load(k.y() + i)).store(dest.y() + i);
+            (F::load(v.z() + i) * F::load(k.z() + i)).store(dest.z() + i);
+        });
+    }
+
+    void norm(const Vector3Stream& v, float* dest)
+    {
+        forEachLane(v.size(), [&](auto lane, size_t i)
+        {
+            using F = decltype(lane);
+            const auto x = F::load(v.x() + i);
+            const auto y = F::load(v.y() + i);
+            const auto z = F::load(v.z() + i);
+            sqrt(x * x + y * y + z * z).store(dest + i);
+        });
+    }
+
+    void normalize(const Vector3Stream& v, Vector3Stream& dest)
+    {
+        dest.resize(v.size());
+        forEachLane(v.size(), [&](auto lane, size_t i)
+        {
+            using F = decltype(lane);
+            const auto x = F::load(v.x() + i);
+            const auto y = F::load(v.y() + i);
+            const auto z = F::load(v.z() + i);
+            const auto n = sqrt(x * x + y * y + z * z);
+            (x / n).store(dest.x() + i);
+            (y / n).store(dest.y() + i);
+            (z / n).store(dest.z() + i);
+        });
+    }
+
+    void dotProduct(const Vector3Stream& a, const Vector3Stream& b, float* dest)
+    {
+        assert(a.size() == b.size() && "Mismatch stream size.");
+        forEachLane(a.size(), [&](auto lane, size_t i)
+        {
+            using F = decltype(lane);
+            const auto d = F::load(a.x() + i) * F::load(b.x() + i) +
+                F::load(a.y() + i) * F::load(b.y() + i) +
+                F::load(a.z() + i) * F::load(b.z() + i);
+            d.store(dest + i);
+        });
+    }
+
+    void crossProduct(const Vector3Stream& a, const Vector3Stream& b, Vector3Stream& dest)
+    {
+        assert(a.size() == b.size() && "Mismatch stream size.");
+        dest.resize(a.size());
+        forEachLane(a.size(), [&](auto lane, size_t i)
+        {
+            using F = decltype(lane);
+            F x, y, z;
+            cross(F::load(a.x() + i), F::load(a.y() + i), F::load(a.z() + i),
+                F::load(b.x() + i), F::load(b.y() + i), F::load(b.z() + i), x, y, z);
+            x.store(dest.x() + i);
+            y.store(dest.y() + i);
+            z.store(dest.z() + i);
+        });
+    }
+
+    void rotate(const QuaternionStream& q, const Vector3Stream& v, Vector3Stream& dest)
+    {
+        assert(q.size() == v.size() && "Mismatch stream size.");
+        dest.resize(v.size());
+        forEachLane(v.size(), [&](auto lane, size_t i)
+        {
+            using F = decltype(lane);
+
+            // Normalize the quaternion
+            auto qw = F::load(q.w() + i);
+            auto qx = F::load(q.x() + i);
+            auto qy = F::load(q.y() + i);
+            auto qz = F::load(q.z() + i);
+            const auto n = sqrt(qw * qw + qx * qx + qy * qy + qz * qz);
+            qw = qw / n;
+            qx = qx / n;
+            qy = qy / n;
+            qz = qz / n;
+
+            // v + uv * 2w + uuv * 2
+            const auto vx = F::load(v.x() + i);
+            const auto vy = F::load(v.y() + i);
+            const auto vz = F::load(v.z() + i);
+            F uvx, uvy, uvz, uuvx, uuvy, uuvz;
+            cross(qx, qy, qz, vx, vy, vz, uvx, uvy, uvz);
+            cross(qx, qy, qz, uvx, uvy, uvz, uuvx, uuvy, uuvz);
+
+            const auto two = F::set(2);
+            const auto w2 = qw * two;
+            (vx + uvx * w2 + uuvx * two).store(dest.x() + i);
+            (vy + uvy * w2 + uuvy * two).store(dest.y() + i);
+            (vz + uvz * w2 + uuvz * two).store(dest.z() + i);
+        });
+    }
+
+    void multiply(const QuaternionStream& a, const QuaternionStream& b, QuaternionStream& dest)
+    {
+        assert(a.size() == b.size() && "Mismatch stream size.");
+        dest.resize(a.size());
+        forEachLane(a.size(), [&](auto lane, size_t i)
+        {
+            using F = decltype(lane);
+            const auto aw = F::load(a.w() + i);
+            const auto ax = F::load(a.x() + i);
+            const auto ay = F::load(a.y() + i);
+            const auto az = F::load(a.z() + i);
+            const auto bw = F::load(b.w() + i);
+            const auto bx = F::load(b.x() + i);
+            const auto by = F::load(b.y() + i);
+            const auto bz = F::load(b.z() + i);
+            (aw * bw - ax * bx - ay * by - az * bz).store(dest.w() + i);
+            (aw * bx + ax * bw + ay * bz - az * by).store(dest.x() + i);
+            (aw * by + ay * bw + az * bx - ax * bz).store(dest.y() + i);
+            (aw * bz + az * bw + ax * by - ay * bx).store(dest.z() + i);
+        });
+    }
+
+    void normalize(const QuaternionStream& q, QuaternionStream& dest)
+    {
+        dest.resize(q.size());
+        forEachLane(q.size(), [&](auto lane, size_t i)
+        {
+            using F = decltype(lane);
+            const auto w = F::load(q.w() + i);
+            const auto x = F::load(q.x() + i);
+            const auto y = F::load(q.y() + i);
+            const auto z = F::load(q.z() + i);
+            const auto n = sqrt(w * w + x * x + y * y + z * z);
+            (w / n).store(dest.w() + i);
+            (x / n).store(dest.x() + i);
+            (y / n).store(dest.y() + i);
+            (z / n).store(dest.z() + i);
+        });
+    }
+
+    void slerp(const QuaternionStream& a, const QuaternionStream& b, float t, QuaternionStream& dest)
+    {
+        assert(a.size() == b.size() && "Mismatch stream size.");
+        dest.resize(a.size());
+        forEachLane(a.size(), [&](auto lane, size_t i)
+        {
+            using F = decltype(lane);
+            const auto aw = F::load(a.w() + i);
+            const auto ax = F::load(a.x() + i);
+            const auto ay = F::load(a.y() + i);
+            const auto az = F::load(a.z() + i);
+            const auto bw = F::load(b.w() + i);
+            const auto bx = F::load(b.x() + i);
+            const auto by = F::load(b.y() + i);
+            const auto bz = F::load(b.z() + i);
+
+            // Weights are calculated for each lanes as same as killme::slerp()
+            float c[F::WIDTH];
+            float ka[F::WIDTH];
+            float kb[F::WIDTH];
+            (aw * bw + ax * bx + ay * by + az * bz).store(c);
+            for (size_t j = 0; j < F::WIDTH; ++j)
+            {
+                const auto sign = c[j] < 0 ? -1.0f : 1.0f;
+                const auto cj = c[j] * sign;
+                if (cj > 0.9995f)
+                {
+                    ka[j] = 1 - t;
+                    kb[j] = t * sign;
+                }
+                else
+                {
+                    const auto theta = std::acos(cj);
+                    const auto invSin = 1 / std::sin(theta);
+                    ka[j] = std::sin((1 - t) * theta) * invSin;
+                    kb[j] = std::sin(t * theta) * invSin * sign;
+                }
+            }
+
+            const auto fa = F::load(ka);
+            const auto fb = F::load(kb);
+            auto w = aw * fa + bw * fb;
+            auto x = ax * fa + bx * fb;
+            auto y = ay * fa + by * fb;
+            auto z = az * fa + bz * fb;
+
+            // Linear interpolated lanes need normalization. Others are already unit length.
+            const auto n = sqrt(w * w + x * x + y * y + z * z);
+            (w / n).store(dest.w() + i);
+            (x / n).store(dest.x() + i);
+            (y / n).store(dest.y() + i);
+            (z / n).store(dest.z() + i);
+        });
+    }
+}
\ No newline at end of file
@@ -0,0 +1,142 @@
+#ifndef _KILLME_MATHSTREAM_H_
+#define _KILLME_MATHSTREAM_H_
+
+#include <vector>
+
+namespace killme
+{
+    class Vector3;
+    class Quaternion;
+
+    /** Structure of arrays of 3D vectors */
+    class Vector3Stream
+    {
+    private:
+        std::vector<float> x_, y_, z_;
+
+    public:
+        /** Construct as the empty stream */
+        Vector3Stream() = default;
+
+        /** Construct with zero vectors */
+        explicit Vector3Stream(size_t n);
+
+        /** Construct from an array of vectors */
+        Vector3Stream(const Vector3* vs, size_t n);
+
+        /** Construct */
+        Vector3Stream(const Vector3Stream&) = default;
+        Vector3Stream(Vector3Stream&&) = default;
+
+        /** Assignment operator */
+        Vector3Stream& operator =(const Vector3Stream&) = default;
+        Vector3Stream& operator =(Vector3Stream&&) = default;
+
+        /** Return count of vectors */
+        size_t size() const;
+
+        /** Change count of vectors */
+        void resize(size_t n);
+
+        /** Add a vector */
+        void push(const Vector3& v);
+
+        /** Remove all vectors */
+        void clear();
+
+        /** Accessor */
+        Vector3 get(size_t i) const;
+        void set(size_t i, const Vector3& v);
+
+        /** Return the array of each element */
+        const float* x() const { return x_.data(); }
+        const float* y() const { return y_.data(); }
+        const float* z() const { return z_.data(); }
+        float* x() { return x_.data(); }
+        float* y() { return y_.data(); }
+        float* z() { return z_.data(); }
+
+        /** Copy from an array of vectors */
+        void load(const Vector3* vs, size_t n);
+
+        /** Copy into an array of vectors */
+        void store(Vector3* dest) const;
+    };
+
+    /** Structure of arrays of quaternions */
+    class QuaternionStream
+    {
+    private:
+        std::vector<float> w_, x_, y_, z_;
+
+    public:
+        /** Construct as the empty stream */
+        QuaternionStream() = default;
+
+        /** Construct with identical quaternions */
+        explicit QuaternionStream(size_t n);
+
+        /** Construct from an array of quaternions */
+        QuaternionStream(const Quaternion* qs, size_t n);
+
+        /** Construct */
+        QuaternionStream(const QuaternionStream&) = default;
+        QuaternionStream(QuaternionStream&&) = default;
+
+        /** Assignment operator */
+        QuaternionStream& operator =(const QuaternionStream&) = default;
+        QuaternionStream& operator =(QuaternionStream&&) = default;
+
+        /** Return count of quaternions */
+        size_t size() const;
+
+        /** Change count of quaternions */
+        void resize(size_t n);
+
+        /** Add a quaternion */
+        void push(const Quaternion& q);
+
+        /** Remove all quaternions */
+        void clear();
+
+        /** Accessor */
+        Quaternion get(size_t i) const;
+        void set(size_t i, const Quaternion& q);
+
+        /** Return the array of each element */
+        const float* w() const { return w_.data(); }
+        const float* x() const { return x_.data(); }
+        const float* y() const { return y_.data(); }
+        const float* z() const { return z_.data(); }
+        float* w() { return w_.data(); }
+        float* x() { return x_.data(); }
+        float* y() { return y_.data(); }
+        float* z() { return z_.data(); }
+
+        /** Copy from an array of quaternions */
+        void load(const Quaternion* qs, size_t n);
+
+        /** Copy into an array of quaternions */
+        void store(Quaternion* dest) const;
+    };
+
+    /** Vector3 stream operations */
+    /// NOTE: The "dest" is resized to count of sources. The "dest" can be same to a source.
+    void add(const Vector3Stream& a, const Vector3Stream& b, Vector3Stream& dest);
+    void subtract(const Vector3Stream& a, const Vector3Stream& b, Vector3Stream& dest);
+    void scale(const Vector3Stream& v, float k, Vector3Stream& dest);
+    void scale(const Vector3Stream& v, const Vector3Stream& k, Vector3Stream& dest);
+    void norm(const Vector3Stream& v, float* dest);
+    void normalize(const Vector3Stream& v, Vector3Stream& dest);
+    void dotProduct(const Vector3Stream& a, const Vector3Stream& b, float* dest);
+    void crossProduct(const Vector3Stream& a, const Vector3Stream& b, Vector3Stream& dest);
+    void rotate(const QuaternionStream& q, const Vector3Stream& v, Vector3Stream& dest); /// Same to q * v
+
+    /** Quaternion stream operations */
+    /// NOTE: Same to the Vector3 stream operations
+    void multiply(const QuaternionStream& a, const QuaternionStream& b, QuaternionStream& dest); /// a * b
+    void normalize(const QuaternionStream& q, QuaternionStream& dest);
+    void slerp(const QuaternionStream& a, const QuaternionStream& b, float t, QuaternionStream& dest);
+}
+
+#endif
\ No newline at end of file
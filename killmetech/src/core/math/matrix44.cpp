@@ -1,11 +1,155 @@
 #include "matrix44.h"
 #include "vector3.h"
 #include "math.h"
+#include "../platform.h"
 #include <cmath>
 #include <cassert>
 
+#ifdef KILLME_SSE
+#include <xmmintrin.h>
+#endif
+
 namespace killme
 {
+#ifdef KILLME_SSE
+    namespace
+    {
+        // Load and store a row
+        /// NOTE: Heap allocations on Win32 are only 8-byte aligned, so we use unaligned access.
+        __m128 loadRow(const Matrix44& m, size_t r)
+        {
+            return _mm_loadu_ps(&m(r, 0));
+        }
+
+        void storeRow(Matrix44& m, size_t r, __m128 v)
+        {
+            _mm_storeu_ps(&m(r, 0), v);
+        }
+
+        // (v[X], v[Y], v[Z], v[W])
+        template <int X, int Y, int Z, int W>
+        __m128 swizzle(__m128 v)
+        {
+            return _mm_shuffle_ps(v, v, _MM_SHUFFLE(W, Z, Y, X));
+        }
+
+        // (a[X], a[Y], b[Z], b[W])
+        template <int X, int Y, int Z, int W>
+        __m128 shuffle(__m128 a, __m128 b)
+        {
+            return _mm_shuffle_ps(a, b, _MM_SHUFFLE(W, Z, Y, X));
+        }
+
+        // v[0] * r0 + v[1] * r1 + v[2] * r2 + v[3] * r3
+        __m128 combineRows(__m128 v, __m128 r0, __m128 r1, __m128 r2, __m128 r3)
+        {
+            auto result = _mm_mul_ps(swizzle<0, 0, 0, 0>(v), r0);
+            result = _mm_add_ps(result, _mm_mul_ps(swizzle<1, 1, 1, 1>(v), r1));
+            result = _mm_add_ps(result, _mm_mul_ps(swizzle<2, 2, 2, 2>(v), r2));
+            result = _mm_add_ps(result, _mm_mul_ps(swizzle<3, 3, 3, 3>(v), r3));
+            return result;
+        }
+
+        // 2x2 matrix operations. A 2x2 matrix is packed into a register as (m00, m01, m10, m11).
+        // A * B
+        __m128 mat2Mul(__m128 a, __m128 b)
+        {
+            return _mm_add_ps(_mm_mul_ps(a, swizzle<0, 3, 0, 3>(b)),
+                _mm_mul_ps(swizzle<1, 0, 3, 2>(a), swizzle<2, 1, 2, 1>(b)));
+        }
+
+        // adj(A) * B
+        __m128 mat2AdjMul(__m128 a, __m128 b)
+        {
+            return _mm_sub_ps(_mm_mul_ps(swizzle<3, 3, 0, 0>(a), b),
+                _mm_mul_ps(swizzle<1, 1, 2, 2>(a), swizzle<2, 3, 0, 1>(b)));
+        }
+
+        // A * adj(B)
+        __m128 mat2MulAdj(__m128 a, __m128 b)
+        {
+            return _mm_sub_ps(_mm_mul_ps(a, swizzle<3, 0, 3, 0>(b)),
+                _mm_mul_ps(swizzle<1, 0, 3, 2>(a), swizzle<2, 1, 2, 1>(b)));
+        }
+
+        // Blocks of the adjugate matrix and the determinant (in all elements)
+        struct Adjugate
+        {
+            __m128 x, y, z, w;
+            __m128 det;
+        };
+
+        // Calculate the adjugate by the block matrix method
+        Adjugate adjugate(const Matrix44& m)
+        {
+            const auto r0 = loadRow(m, 0);
+            const auto r1 = loadRow(m, 1);
+            const auto r2 = loadRow(m, 2);
+            const auto r3 = loadRow(m, 3);
+
+            // Sub matrices | A B |
+            //              | C D |
+            const auto a = _mm_movelh_ps(r0, r1);
+            const auto b = _mm_movehl_ps(r1, r0);
+            const auto c = _mm_movelh_ps(r2, r3);
+            const auto d = _mm_movehl_ps(r3, r2);
+
+            // (|A|, |B|, |C|, |D|)
+            const auto detSub = _mm_sub_ps(
+                _mm_mul_ps(shuffle<0, 2, 0, 2>(r0, r2), shuffle<1, 3, 1, 3>(r1, r3)),
+                _mm_mul_ps(shuffle<1, 3, 1, 3>(r0, r2), shuffle<0, 2, 0, 2>(r1, r3)));
+            const auto detA = swizzle<0, 0, 0, 0>(detSub);
+            const auto detB = swizzle<1, 1, 1, 1>(detSub);
+            const auto detC = swizzle<2, 2, 2, 2>(detSub);
+            const auto detD = swizzle<3, 3, 3, 3>(detSub);
+
+            const auto dc = mat2AdjMul(d, c);
+            const auto ab = mat2AdjMul(a, b);
+
+            Adjugate adj;
+            adj.x = _mm_sub_ps(_mm_mul_ps(detD, a), mat2Mul(b, dc));
+            adj.w = _mm_sub_ps(_mm_mul_ps(detA, d), mat2Mul(c, ab));
+            adj.y = _mm_sub_ps(_mm_mul_ps(detB, c), mat2MulAdj(d, ab));
+            adj.z = _mm_sub_ps(_mm_mul_ps(detC, b), mat2MulAdj(a, dc));
+
+            // |M| = |A||D| + |B||C| - tr(adj(A)B adj(D)C)
+            auto tr = _mm_mul_ps(ab, swizzle<0, 2, 1, 3>(dc));
+            tr = _mm_add_ps(tr, swizzle<2, 3, 0, 1>(tr));
+            tr = _mm_add_ps(tr, swizzle<1, 0, 3, 2>(tr));
+            adj.det = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(detA, detD), _mm_mul_ps(detB, detC)), tr);
+
+            return adj;
+        }
+
+        // Return adj(M) / det
+        Matrix44 scaleAdjugate(const Adjugate& adj, __m128 det)
+        {
+            const auto invDet = _mm_div_ps(_mm_setr_ps(1, -1, -1, 1), det);
+            const auto x = _mm_mul_ps(adj.x, invDet);
+            const auto y = _mm_mul_ps(adj.y, invDet);
+            const auto z = _mm_mul_ps(adj.z, invDet);
+            const auto w = _mm_mul_ps(adj.w, invDet);
+
+            Matrix44 m;
+            storeRow(m, 0, shuffle<3, 1, 3, 1>(x, y));
+            storeRow(m, 1, shuffle<2, 0, 2, 0>(x, y));
+            storeRow(m, 2, shuffle<3, 1, 3, 1>(z, w));
+            storeRow(m, 3, shuffle<2, 0, 2, 0>(z, w));
+            return m;
+        }
+
+        // Store xyz elements into the Vector3
+        void storeVector3(Vector3& v, __m128 r)
+        {
+            alignas(16) float f[4];
+            _mm_store_ps(f, r);
+            v.x = f[0];
+            v.y = f[1];
+            v.z = f[2];
+        }
+    }
+#endif
+
     const Matrix44 Matrix44::IDENTITY = {
         1, 0, 0, 0,
         0, 1, 0, 0,
@@ -130,6 +274,19 @@ namespace killme
 
     const Matrix44 operator *(const Matrix44& a, const Matrix44& b)
     {
+#ifdef KILLME_SSE
+        const auto b0 = loadRow(b, 0);
+        const auto b1 = loadRow(b, 1);
+        const auto b2 = loadRow(b, 2);
+        const auto b3 = loadRow(b, 3);
+
+        Matrix44 m;
+        for (size_t r = 0; r < 4; ++r)
+        {
+            storeRow(m, r, combineRows(loadRow(a, r), b0, b1, b2, b3));
+        }
+        return m;
+#else
         return {
             a(0, 0) * b(0, 0) + a(0, 1) * b(1, 0) + a(0, 2) * b(2, 0) + a(0, 3) * b(3, 0),
             a(0, 0) * b(0, 1) + a(0, 1) * b(1, 1) + a(0, 2) * b(2, 1) + a(0, 3) * b(3, 1),
@@ -151,6 +308,7 @@ namespace killme
             a(3, 0) * b(0, 2) + a(3, 1) * b(1, 2) + a(3, 2) * b(2, 2) + a(3, 3) * b(3, 2),
             a(3, 0) * b(0, 3) + a(3, 1) * b(1, 3) + a(3, 2) * b(2, 3) + a(3, 3) * b(3, 3)
         };
+#endif
     }
 
     const Matrix44 operator *(const Matrix44& m, float k)
@@ -208,12 +366,27 @@ namespace killme
 
     Matrix44 transpose(const Matrix44& m)
     {
+#ifdef KILLME_SSE
+        auto r0 = loadRow(m, 0);
+        auto r1 = loadRow(m, 1);
+        auto r2 = loadRow(m, 2);
+        auto r3 = loadRow(m, 3);
+        _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+
+        Matrix44 t;
+        storeRow(t, 0, r0);
+        storeRow(t, 1, r1);
+        storeRow(t, 2, r2);
+        storeRow(t, 3, r3);
+        return t;
+#else
         return {
             m(0, 0), m(1, 0), m(2, 0), m(3, 0),
             m(0, 1), m(1, 1), m(2, 1), m(3, 1),
             m(0, 2), m(1, 2), m(2, 2), m(3, 2),
             m(0, 3), m(1, 3), m(2, 3), m(3, 3)
         };
+#endif
     }
 
     float determinant(const Matrix44& m)
@@ -228,12 +401,21 @@ namespace killme
 
     Matrix44 inverse(const Matrix44& m)
     {
+#ifdef KILLME_SSE
+        const auto adj = adjugate(m);
+        assert(!equalf(_mm_cvtss_f32(adj.det), 0) && "Not exist inversed matrix.");
+        return scaleAdjugate(adj, adj.det);
+#else
         return inverse(m, determinant(m));
+#endif
     }
 
     Matrix44 inverse(const Matrix44& m, float det)
     {
         assert(!equalf(det, 0) && "Not exist inversed matrix.");
+#ifdef KILLME_SSE
+        return scaleAdjugate(adjugate(m), _mm_set1_ps(det));
+#else
         const auto invDet = 1 / det;
         return {
             invDet * (m(1, 1) * (m(2, 2) * m(3, 3) - m(2, 3) * m(3, 2)) + m(1, 2) * (m(2, 3) * m(3, 1) - m(2, 1) * m(3, 3)) + m(1, 3) * (m(2, 1) * m(3, 2) - m(2, 2) * m(3, 1))),
@@ -256,10 +438,20 @@ namespace killme
             invDet * (m(3, 0) * (m(0, 2) * m(1, 1) - m(0, 1) * m(1, 2)) + m(3, 1) * (m(0, 0) * m(1, 2) - m(0, 2) * m(1, 0)) + m(3, 2) * (m(0, 1) * m(1, 0) - m(0, 0) * m(1, 1))),
             invDet * (m(0, 0) * (m(1, 1) * m(2, 2) - m(1, 2) * m(2, 1)) + m(0, 1) * (m(1, 2) * m(2, 0) - m(1, 0) * m(2, 2)) + m(0, 2) * (m(1, 0) * m(2, 1) - m(1, 1) * m(2, 0)))
         };
+#endif
     }
 
     Matrix44 makeTransformMatrix(const Vector3& scale, const Quaternion& rot, const Vector3& trans)
     {
+#ifdef KILLME_SSE
+        // Scaling matrix is diagonal, so scale each row of the rotation matrix
+        auto m = to<Matrix44>(rot);
+        storeRow(m, 0, _mm_mul_ps(_mm_set1_ps(scale.x), loadRow(m, 0)));
+        storeRow(m, 1, _mm_mul_ps(_mm_set1_ps(scale.y), loadRow(m, 1)));
+        storeRow(m, 2, _mm_mul_ps(_mm_set1_ps(scale.z), loadRow(m, 2)));
+        storeRow(m, 3, _mm_setr_ps(trans.x, trans.y, trans.z, 1));
+        return m;
+#else
 		auto m = Matrix44::IDENTITY;
 
         // Apply scaling
@@ -276,6 +468,7 @@ namespace killme
         m(3, 2) = trans.z;
 
         return m;
+#endif
     }
 
 	Matrix44 makeProjectionMatrix(float fovX, float aspect, float zn, float zf)
@@ -296,4 +489,83 @@ namespace killme
             0, 0, n43, 0
         };
     }
+
+    void transformMatrices(const Matrix44* src, const Matrix44& m, Matrix44* dest, size_t n)
+    {
+#ifdef KILLME_SSE
+        const auto m0 = loadRow(m, 0);
+        const auto m1 = loadRow(m, 1);
+        const auto m2 = loadRow(m, 2);
+        const auto m3 = loadRow(m, 3);
+
+        for (size_t i = 0; i < n; ++i)
+        {
+            const auto r0 = combineRows(loadRow(src[i], 0), m0, m1, m2, m3);
+            const auto r1 = combineRows(loadRow(src[i], 1), m0, m1, m2, m3);
+            const auto r2 = combineRows(loadRow(src[i], 2), m0, m1, m2, m3);
+            const auto r3 = combineRows(loadRow(src[i], 3), m0, m1, m2, m3);
+            storeRow(dest[i], 0, r0);
+            storeRow(dest[i], 1, r1);
+            storeRow(dest[i], 2, r2);
+            storeRow(dest[i], 3, r3);
+        }
+#else
+        for (size_t i = 0; i < n; ++i)
+        {
+            dest[i] = src[i] * m;
+        }
+#endif
+    }
+
+    void transformPositions(const Vector3* src, const Matrix44& m, Vector3* dest, size_t n)
+    {
+#ifdef KILLME_SSE
+        const auto m0 = loadRow(m, 0);
+        const auto m1 = loadRow(m, 1);
+        const auto m2 = loadRow(m, 2);
+        const auto m3 = loadRow(m, 3);
+
+        for (size_t i = 0; i < n; ++i)
+        {
+            auto r = _mm_mul_ps(_mm_set1_ps(src[i].x), m0);
+            r = _mm_add_ps(r, _mm_mul_ps(_mm_set1_ps(src[i].y), m1));
+            r = _mm_add_ps(r, _mm_mul_ps(_mm_set1_ps(src[i].z), m2));
+            r = _mm_add_ps(r, m3);
+            storeVector3(dest[i], r);
+        }
+#else
+        for (size_t i = 0; i < n; ++i)
+        {
+            const auto v = src[i];
+            dest[i].x = v.x * m(0, 0) + v.y * m(1, 0) + v.z * m(2, 0) + m(3, 0);
+            dest[i].y = v.x * m(0, 1) + v.y * m(1, 1) + v.z * m(2, 1) + m(3, 1);
+            dest[i].z = v.x * m(0, 2) + v.y * m(1, 2) + v.z * m(2, 2) + m(3, 2);
+        }
+#endif
+    }
+
+    void transformDirections(const Vector3* src, const Matrix44& m, Vector3* dest, size_t n)
+    {
+#ifdef KILLME_SSE
+        const auto m0 = loadRow(m, 0);
+        const auto m1 = loadRow(m, 1);
+        const auto m2 = loadRow(m, 2);
+
+        for (size_t i = 0; i < n; ++i)
+        {
+            auto r = _mm_mul_ps(_mm_set1_ps(src[i].x), m0);
+            r = _mm_add_ps(r, _mm_mul_ps(_mm_set1_ps(src[i].y), m1));
+            r = _mm_add_ps(r, _mm_mul_ps(_mm_set1_ps(src[i].z), m2));
+            storeVector3(dest[i], r);
+        }
+#else
+        for (size_t i = 0; i < n; ++i)
+        {
+            const auto v = src[i];
+            dest[i].x = v.x * m(0, 0) + v.y * m(1, 0) + v.z * m(2, 0);
+            dest[i].y = v.x * m(0, 1) + v.y * m(1, 1) + v.z * m(2, 1);
+            dest[i].z = v.x * m(0, 2) + v.y * m(1, 2) + v.z * m(2, 2);
+        }
+#endif
+    }
 }
\ No newline at end of file
@@ -109,6 +109,12 @@ namespace killme
     /** Create the geometric matrix */
     Matrix44 makeTransformMatrix(const Vector3& scale, const Quaternion& rot, const Vector3& trans);
     Matrix44 makeProjectionMatrix(float fovX, float aspect, float zn, float zf); /// Aspect rate calclated by w/h
+
+    /** Batch operations */
+    /// NOTE: "dest" can be same to "src"
+    void transformMatrices(const Matrix44* src, const Matrix44& m, Matrix44* dest, size_t n); /// dest[i] = src[i] * m
+    void transformPositions(const Vector3* src, const Matrix44& m, Vector3* dest, size_t n); /// dest[i] = (src[i], 1) * m
+    void transformDirections(const Vector3* src, const Matrix44& m, Vector3* dest, size_t n); /// dest[i] = (src[i], 0) * m
 }
 
 #endif
\ No newline at end of file
@@ -137,6 +137,26 @@ namespace killme
         return a.w * b.w + a.x * b.x + a.y * b.y + a.z * b.z;
     }
 
+    Quaternion slerp(const Quaternion& a, const Quaternion& b, float t)
+    {
+        // Take the shortest arc
+        auto c = dotProduct(a, b);
+        const auto sign = c < 0 ? -1.0f : 1.0f;
+        c *= sign;
+
+        // Nearly same rotations are interpolated linearly
+        if (c > 0.9995f)
+        {
+            return normalize(a * (1 - t) + b * (sign * t));
+        }
+
+        const auto theta = std::acos(c);
+        const auto invSin = 1 / std::sin(theta);
+        const auto ka = std::sin((1 - t) * theta) * invSin;
+        const auto kb = std::sin(t * theta) * invSin * sign;
+        return a * ka + b * kb;
+    }
+
     Quaternion makeQuaternion(const Vector3& axis, float angle)
     {
         const auto n = normalize(axis);
@@ -66,6 +66,9 @@ namespace killme
     /** Return the dot product value */
     float dotProduct(const Quaternion& a, const Quaternion& b);
 
+    /** Spherical linear interpolation */
+    Quaternion slerp(const Quaternion& a, const Quaternion& b, float t);
+
     /** Create the quaternion from a rotation axis and an angle[rad] */
     Quaternion makeQuaternion(const Vector3& axis, float angle);
 
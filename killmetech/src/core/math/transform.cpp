@@ -5,18 +5,33 @@
 namespace killme
 {
     Transform::Transform()
-        : position_()
-        , orientation_()
-        , scale_(1, 1, 1)
+        : Transform(getDefaultTransformHierarchy())
+    {
+    }
+
+    Transform::Transform(const std::shared_ptr<TransformHierarchy>& hierarchy)
+        : hierarchy_(hierarchy)
+        , id_(hierarchy->create())
         , parent_()
         , children_()
-        , needUpdate_(false)
-        , worldPosition_()
-        , worldOrientation_()
-        , worldScale_(1, 1, 1)
     {
     }
 
+    Transform::~Transform()
+    {
+        hierarchy_->destroy(id_);
+    }
+
+    std::shared_ptr<TransformHierarchy> Transform::getHierarchy() const
+    {
+        return hierarchy_;
+    }
+
+    TransformHierarchy::NodeId Transform::getHierarchyId() const
+    {
+        return id_;
+    }
+
     std::shared_ptr<const Transform> Transform::getParent() const
     {
         return parent_.lock();
@@ -30,7 +45,10 @@ namespace killme
     void Transform::setParent(const std::weak_ptr<Transform>& parent)
     {
         parent_ = parent;
-        needUpdate_ = true;
+
+        const auto p = parent.lock();
+        assert((!p || p->hierarchy_ == hierarchy_) && "Transform nodes belong to different hierarchies.");
+        hierarchy_->setParent(id_, p ? p->id_ : TransformHierarchy::NONE);
     }
 
     void Transform::addChild(const std::shared_ptr<Transform>& child)
@@ -44,6 +62,7 @@ namespace killme
         if (children_.erase(child) > 0)
         {
             child->parent_.reset();
+            hierarchy_->setParent(child->id_, TransformHierarchy::NONE);
         }
     }
 
@@ -54,19 +73,17 @@ namespace killme
 
     Vector3 Transform::getPosition() const
     {
-        return position_;
+        return hierarchy_->getPosition(id_);
     }
 
     Vector3 Transform::getWorldPosition() const
     {
-        update();
-        return worldPosition_;
+        return hierarchy_->getWorldPosition(id_);
     }
 
     void Transform::setPosition(const Vector3& pos)
     {
-        position_ = pos;
-        needUpdate_ = true;
+        hierarchy_->setPosition(id_, pos);
     }
 
     void Transform::setWorldPosition(const Vector3& wpos)
@@ -84,19 +101,17 @@ namespace killme
 
     Quaternion Transform::getOrientation() const
     {
-        return orientation_;
+        return hierarchy_->getOrientation(id_);
     }
 
     Quaternion Transform::getWorldOrientation() const
     {
-        update();
-        return worldOrientation_;
+        return hierarchy_->getWorldOrientation(id_);
     }
 
     void Transform::setOrientation(const Quaternion& q)
     {
-        orientation_ = q;
-        needUpdate_ = true;
+        hierarchy_->setOrientation(id_, q);
     }
 
     void Transform::setWorldOrientation(const Quaternion& wq)
@@ -114,19 +129,17 @@ namespace killme
 
     Vector3 Transform::getScale() const
     {
-        return scale_;
+        return hierarchy_->getScale(id_);
     }
 
     Vector3 Transform::getWorldScale() const
     {
-        update();
-        return worldScale_;
+        return hierarchy_->getWorldScale(id_);
     }
 
     void Transform::setScale(const Vector3& k)
     {
-        scale_ = k;
-        needUpdate_ = true;
+        hierarchy_->setScale(id_, k);
     }
 
     void Transform::setWorldScale(const Vector3& wk)
@@ -144,76 +157,27 @@ namespace killme
 
     Matrix44 Transform::getMatrix() const
     {
-        return makeTransformMatrix(scale_, orientation_, position_);
+        return makeTransformMatrix(getScale(), getOrientation(), getPosition());
     }
 
     Matrix44 Transform::getWorldMatrix() const
     {
-        update();
-        return makeTransformMatrix(worldScale_, worldOrientation_, worldPosition_);
+        return hierarchy_->getWorldMatrix(id_);
     }
 
     void Transform::translate(const Vector3& offset)
     {
-        setPosition(position_ + offset);
+        setPosition(getPosition() + offset);
     }
 
     void Transform::rotate(const Quaternion& q)
     {
-        setOrientation(q * orientation_);
+        setOrientation(q * getOrientation());
     }
 
     void Transform::scale(const Vector3& k)
     {
-        setScale(killme::scale(scale_, k));
-    }
-
-    void Transform::setUpdateNeed(bool need)
-    {
-        needUpdate_ = need;
-    }
-
-    void Transform::update() const
-    {
-        std::stack<const Transform*> pass;
-        pass.emplace(this);
-        
-        auto parent = getParent();
-        while (parent)
-        {
-            pass.emplace(parent.get());
-            parent = parent->getParent();
-        }
-        while (!pass.empty() && !pass.top()->needUpdate_)
-        {
-            pass.pop();
-        }
-
-        if (pass.empty())
-        {
-            return;
-        }
-
-        if (!pass.top()->getParent())
-        {
-            pass.top()->worldPosition_ = pass.top()->position_;
-            pass.top()->worldOrientation_ = pass.top()->orientation_;
-            pass.top()->worldScale_ = pass.top()->scale_;
-            pass.top()->needUpdate_ = false;
-            pass.pop();
-        }
-
-        while (!pass.empty())
-        {
-            const auto node = pass.top();
-            parent = node->getParent();
-            node->worldPosition_ = parent->worldPosition_ +
-                parent->worldOrientation_ * killme::scale(node->position_, parent->worldScale_);
-            node->worldOrientation_ = node->orientation_ * parent->worldOrientation_;
-            node->worldScale_ = killme::scale(parent->worldScale_, node->scale_);
-            node->needUpdate_ = false;
-            pass.pop();
-        }
+        setScale(killme::scale(getScale(), k));
     }
 
     void removeChildNode(const std::shared_ptr<Transform>& parent, const std::shared_ptr<Transform>& child)
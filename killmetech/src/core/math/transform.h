@@ -3,6 +3,7 @@
 
 #include "vector3.h"
 #include "quaternion.h"
+#include "transformhierarchy.h"
 #include "../utility.h"
 #include <unordered_set>
 #include <memory>
@@ -13,26 +14,34 @@ namespace killme
     class Matrix44;
 
     /** Transform node */
+    /// NOTE: Transform values are stored in a TransformHierarchy. A transform node is a handle of a node in the hierarchy.
     class Transform
     {
     private:
-        Vector3 position_;
-        Quaternion orientation_;
-        Vector3 scale_;
+        std::shared_ptr<TransformHierarchy> hierarchy_;
+        TransformHierarchy::NodeId id_;
         std::weak_ptr<Transform> parent_;
         std::unordered_set<std::shared_ptr<Transform>> children_;
 
-        mutable bool needUpdate_;
-        mutable Vector3 worldPosition_;
-        mutable Quaternion worldOrientation_;
-        mutable Vector3 worldScale_;
-
     public:
-        /** Construct */
+        /** Construct in the default hierarchy */
         Transform();
 
+        /** Construct in a hierarchy */
+        explicit Transform(const std::shared_ptr<TransformHierarchy>& hierarchy);
+
         /** For drived classes */
-        virtual ~Transform() = default;
+        virtual ~Transform();
+
+        /** Transform node is noncopyable */
+        Transform(const Transform&) = delete;
+        Transform& operator =(const Transform&) = delete;
+
+        /** Return the hierarchy that stores this node */
+        std::shared_ptr<TransformHierarchy> getHierarchy() const;
+
+        /** Return the identifier in the hierarchy */
+        TransformHierarchy::NodeId getHierarchyId() const;
 
         /** Return the parent */
         std::shared_ptr<const Transform> getParent() const;
@@ -110,13 +119,6 @@ namespace killme
 
         /** Local relative scaling */
         void scale(const Vector3& k);
-
-    protected:
-        /** Set update need */
-        void setUpdateNeed(bool need);
-
-    private:
-        void update() const;
     };
 
     /** Add a child node */
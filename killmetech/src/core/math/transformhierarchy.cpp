@@ -0,0 +1,541 @@
+#include "transformhierarchy.h"
+#include "../threadpool.h"
+#include <algorithm>
+#include <cassert>
+
+namespace killme
+{
+    namespace
+    {
+        // Minimum count of nodes processed in a task
+        const size_t MIN_PARALLEL_GRAIN = 256;
+
+        thread_local bool accessForbidden = false;
+
+        // Reorder elements into new order. The scratch receives the old buffer, so capacities are reused.
+        template <class T>
+        void permute(std::vector<T>& v, const std::vector<size_t>& order, std::vector<T>& scratch)
+        {
+            scratch.clear();
+            for (const auto i : order)
+            {
+                scratch.emplace_back(v[i]);
+            }
+            v.swap(scratch);
+        }
+    }
+
+    const TransformHierarchy::NodeId TransformHierarchy::NONE;
+
+    TransformHierarchy::TransformHierarchy()
+        : nodes_()
+        , freeNodes_()
+        , numNodes_(0)
+        , ids_()
+        , parentSlots_()
+        , subtreeSizes_()
+        , positions_()
+        , orientations_()
+        , scales_()
+        , worldPositions_()
+        , worldOrientations_()
+        , worldScales_()
+        , worldMatrices_()
+        , dirties_()
+        , orderValid_(true)
+        , dirtyBegin_(0)
+        , dirtyEnd_(0)
+        , segments_()
+        , splits_()
+        , path_()
+        , order_()
+        , stack_()
+        , vectorScratch_()
+        , quaternionScratch_()
+        , matrixScratch_()
+        , flagScratch_()
+        , ownerThread_(std::this_thread::get_id())
+    {
+    }
+
+    TransformHierarchy::NodeId TransformHierarchy::create()
+    {
+        assert(!accessForbidden && "Transforms must not be accessed from this thread now.");
+        assert(std::this_thread::get_id() == ownerThread_ && "Transform nodes must be edited on the owner thread of the hierarchy.");
+        NodeId id;
+        if (freeNodes_.empty())
+        {
+            id = nodes_.size();
+            nodes_.emplace_back();
+        }
+        else
+        {
+            id = freeNodes_.back();
+            freeNodes_.pop_back();
+        }
+
+        // A new root node is appended to the tail, so the order is still valid
+        const auto slot = ids_.size();
+        nodes_[id] = { slot, NONE, NONE, NONE, NONE, true };
+        ids_.emplace_back(id);
+        parentSlots_.emplace_back(NONE);
+        subtreeSizes_.emplace_back(1);
+        positions_.emplace_back();
+        orientations_.emplace_back();
+        scales_.emplace_back(1.0f, 1.0f, 1.0f);
+        worldPositions_.emplace_back();
+        worldOrientations_.emplace_back();
+        worldScales_.emplace_back(1.0f, 1.0f, 1.0f);
+        worldMatrices_.emplace_back();
+        dirties_.emplace_back(0);
+        ++numNodes_;
+
+        return id;
+    }
+
+    void TransformHierarchy::destroy(NodeId id)
+    {
+        assert(!accessForbidden && "Transforms must not be accessed from this thread now.");
+        assert(std::this_thread::get_id() == ownerThread_ && "Transform nodes must be edited on the owner thread of the hierarchy.");
+        assert(id < nodes_.size() && nodes_[id].alive && "Invalid transform node.");
+
+        orderValid_ = false;
+
+        // The children become root nodes
+        auto child = nodes_[id].firstChild;
+        while (child != NONE)
+        {
+            const auto next = nodes_[child].nextSibling;
+            nodes_[child].parent = NONE;
+            nodes_[child].prevSibling = NONE;
+            nodes_[child].nextSibling = NONE;
+            markDirty(child);
+            child = next;
+        }
+        nodes_[id].firstChild = NONE;
+
+        unlink(id);
+
+        // The slot is released by next rebuild of the order
+        const auto slot = nodes_[id].slot;
+        ids_[slot] = NONE;
+        dirties_[slot] = 0;
+        nodes_[id].alive = false;
+        freeNodes_.emplace_back(id);
+        --numNodes_;
+    }
+
+    size_t TransformHierarchy::getNumNodes() const
+    {
+        return numNodes_;
+    }
+
+    void TransformHierarchy::setParent(NodeId id, NodeId parent)
+    {
+        assert(!accessForbidden && "Transforms must not be accessed from this thread now.");
+        assert(std::this_thread::get_id() == ownerThread_ && "Transform nodes must be edited on the owner thread of the hierarchy.");
+        assert(id < nodes_.size() && nodes_[id].alive && "Invalid transform node.");
+        assert((parent == NONE || (parent < nodes_.size() && nodes_[parent].alive)) && "Invalid parent transform node.");
+
+        if (nodes_[id].parent == parent)
+        {
+            return;
+        }
+
+#ifndef NDEBUG
+        for (auto n = parent; n != NONE; n = nodes_[n].parent)
+        {
+            assert(n != id && "Circular transform hierarchy.");
+        }
+#endif
+
+        unlink(id);
+
+        if (parent != NONE)
+        {
+            auto& node = nodes_[id];
+            node.parent = parent;
+            node.nextSibling = nodes_[parent].firstChild;
+            if (node.nextSibling != NONE)
+            {
+                nodes_[node.nextSibling].prevSibling = id;
+            }
+            nodes_[parent].firstChild = id;
+        }
+
+        orderValid_ = false;
+        markDirty(id);
+    }
+
+    TransformHierarchy::NodeId TransformHierarchy::getParent(NodeId id) const
+    {
+        return nodes_[id].parent;
+    }
+
+    Vector3 TransformHierarchy::getPosition(NodeId id) const
+    {
+        return positions_[nodes_[id].slot];
+    }
+
+    void TransformHierarchy::setPosition(NodeId id, const Vector3& pos)
+    {
+        positions_[nodes_[id].slot] = pos;
+        markDirty(id);
+    }
+
+    Quaternion TransformHierarchy::getOrientation(NodeId id) const
+    {
+        return orientations_[nodes_[id].slot];
+    }
+
+    void TransformHierarchy::setOrientation(NodeId id, const Quaternion& q)
+    {
+        orientations_[nodes_[id].slot] = q;
+        markDirty(id);
+    }
+
+    Vector3 TransformHierarchy::getScale(NodeId id) const
+    {
+        return scales_[nodes_[id].slot];
+    }
+
+    void TransformHierarchy::setScale(NodeId id, const Vector3& k)
+    {
+        scales_[nodes_[id].slot] = k;
+        markDirty(id);
+    }
+
+    Vector3 TransformHierarchy::getWorldPosition(NodeId id)
+    {
+        resolve(id);
+        return worldPositions_[nodes_[id].slot];
+    }
+
+    Quaternion TransformHierarchy::getWorldOrientation(NodeId id)
+    {
+        resolve(id);
+        return worldOrientations_[nodes_[id].slot];
+    }
+
+    Vector3 TransformHierarchy::getWorldScale(NodeId id)
+    {
+        resolve(id);
+        return worldScales_[nodes_[id].slot];
+    }
+
+    Matrix44 TransformHierarchy::getWorldMatrix(NodeId id)
+    {
+        resolve(id);
+        return worldMatrices_[nodes_[id].slot];
+    }
+
+    bool TransformHierarchy::isDirty(NodeId id) const
+    {
+        if (orderValid_)
+        {
+            return dirties_[nodes_[id].slot] != 0;
+        }
+
+        // Dirty flags are not propagated to descendants until rebuild of the order
+        for (auto n = id; n != NONE; n = nodes_[n].parent)
+        {
+            if (dirties_[nodes_[n].slot])
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void TransformHierarchy::update()
+    {
+        if (!orderValid_)
+        {
+            rebuildOrder();
+        }
+
+        // Parents are always recomputed before their children
+        for (auto i = dirtyBegin_; i < dirtyEnd_; ++i)
+        {
+            if (dirties_[i])
+            {
+                computeWorld(i, parentSlots_[i]);
+                dirties_[i] = 0;
+            }
+        }
+
+        dirtyBegin_ = 0;
+        dirtyEnd_ = 0;
+    }
+
+    void TransformHierarchy::update(ThreadPool& pool)
+    {
+        if (!orderValid_)
+        {
+            rebuildOrder();
+        }
+
+        const auto numDirties = dirtyEnd_ - dirtyBegin_;
+        const auto grain = std::max<size_t>(MIN_PARALLEL_GRAIN, numDirties / ((pool.getNumThreads() + 1) * 8));
+
+        // Collect the top dirty subtrees
+        segments_.clear();
+        splits_.clear();
+        auto i = dirtyBegin_;
+        while (i < dirtyEnd_)
+        {
+            if (dirties_[i])
+            {
+                splits_.emplace_back(i);
+                i += subtreeSizes_[i];
+            }
+            else
+            {
+                ++i;
+            }
+        }
+
+        // Split large subtrees. The root of a split subtree is recomputed here before its children.
+        while (!splits_.empty())
+        {
+            const auto slot = splits_.back();
+            splits_.pop_back();
+
+            const auto end = slot + subtreeSizes_[slot];
+            if (subtreeSizes_[slot] <= grain)
+            {
+                segments_.emplace_back(slot);
+                continue;
+            }
+
+            computeWorld(slot, parentSlots_[slot]);
+            dirties_[slot] = 0;
+            for (auto child = slot + 1; child < end; child += subtreeSizes_[child])
+            {
+                splits_.emplace_back(child);
+            }
+        }
+
+        // Each subtree refers only to itself and to already recomputed ancestors
+        pool.parallelFor(segments_.size(), [&](size_t k)
+        {
+            const auto begin = segments_[k];
+            const auto end = begin + subtreeSizes_[begin];
+            for (auto slot = begin; slot < end; ++slot)
+            {
+                computeWorld(slot, parentSlots_[slot]);
+                dirties_[slot] = 0;
+            }
+        });
+
+        dirtyBegin_ = 0;
+        dirtyEnd_ = 0;
+    }
+
+    void TransformHierarchy::markDirty(NodeId id)
+    {
+        assert(!accessForbidden && "Transforms must not be accessed from this thread now.");
+        const auto slot = nodes_[id].slot;
+        if (dirties_[slot])
+        {
+            return;
+        }
+
+        if (!orderValid_)
+        {
+            // Propagated to descendants by rebuild of the order
+            dirties_[slot] = 1;
+            return;
+        }
+
+        // Descendants are the contiguous range after the node
+        const auto end = slot + subtreeSizes_[slot];
+        std::fill(std::begin(dirties_) + slot, std::begin(dirties_) + end, static_cast<unsigned char>(1));
+
+        if (dirtyBegin_ == dirtyEnd_)
+        {
+            dirtyBegin_ = slot;
+            dirtyEnd_ = end;
+        }
+        else
+        {
+            dirtyBegin_ = std::min(dirtyBegin_, slot);
+            dirtyEnd_ = std::max(dirtyEnd_, end);
+        }
+    }
+
+    void TransformHierarchy::resolve(NodeId id)
+    {
+        assert(!accessForbidden && "Transforms must not be accessed from this thread now.");
+        assert(id < nodes_.size() && nodes_[id].alive && "Invalid transform node.");
+
+        if (orderValid_ && !dirties_[nodes_[id].slot])
+        {
+            return;
+        }
+
+        // Collect the path from the nearest clean ancestor.
+        // If the order is invalid, dirty flags are not reliable so the path reaches to the root.
+        path_.clear();
+        for (auto n = id; n != NONE; n = nodes_[n].parent)
+        {
+            if (orderValid_ && !dirties_[nodes_[n].slot])
+            {
+                break;
+            }
+            path_.emplace_back(n);
+        }
+
+        for (auto it = path_.rbegin(); it != path_.rend(); ++it)
+        {
+            const auto& node = nodes_[*it];
+            computeWorld(node.slot, node.parent == NONE ? NONE : nodes_[node.parent].slot);
+            if (orderValid_)
+            {
+                dirties_[node.slot] = 0;
+            }
+        }
+    }
+
+    void TransformHierarchy::computeWorld(size_t slot, size_t parentSlot)
+    {
+        if (parentSlot == NONE)
+        {
+            worldPositions_[slot] = positions_[slot];
+            worldOrientations_[slot] = orientations_[slot];
+            worldScales_[slot] = scales_[slot];
+        }
+        else
+        {
+            worldPositions_[slot] = worldPositions_[parentSlot] +
+                worldOrientations_[parentSlot] * killme::scale(positions_[slot], worldScales_[parentSlot]);
+            worldOrientations_[slot] = orientations_[slot] * worldOrientations_[parentSlot];
+            worldScales_[slot] = killme::scale(worldScales_[parentSlot], scales_[slot]);
+        }
+        worldMatrices_[slot] = makeTransformMatrix(worldScales_[slot], worldOrientations_[slot], worldPositions_[slot]);
+    }
+
+    void TransformHierarchy::unlink(NodeId id)
+    {
+        auto& node = nodes_[id];
+        if (node.parent == NONE)
+        {
+            return;
+        }
+
+        if (node.prevSibling == NONE)
+        {
+            nodes_[node.parent].firstChild = node.nextSibling;
+        }
+        else
+        {
+            nodes_[node.prevSibling].nextSibling = node.nextSibling;
+        }
+        if (node.nextSibling != NONE)
+        {
+            nodes_[node.nextSibling].prevSibling = node.prevSibling;
+        }
+
+        node.parent = NONE;
+        node.prevSibling = NONE;
+        node.nextSibling = NONE;
+    }
+
+    void TransformHierarchy::rebuildOrder()
+    {
+        // Depth first order from each root. Destroyed slots are dropped.
+        auto& order = order_;
+        auto& stack = stack_;
+        order.clear();
+        stack.clear();
+        for (NodeId root = 0; root < nodes_.size(); ++root)
+        {
+            if (!nodes_[root].alive || nodes_[root].parent != NONE)
+            {
+                continue;
+            }
+
+            stack.emplace_back(root);
+            while (!stack.empty())
+            {
+                const auto id = stack.back();
+                stack.pop_back();
+                order.emplace_back(nodes_[id].slot);
+                for (auto child = nodes_[id].firstChild; child != NONE; child = nodes_[child].nextSibling)
+                {
+                    stack.emplace_back(child);
+                }
+            }
+        }
+        assert(order.size() == numNodes_ && "Transform hierarchy is broken.");
+
+        permute(ids_, order, path_);
+        permute(positions_, order, vectorScratch_);
+        permute(orientations_, order, quaternionScratch_);
+        permute(scales_, order, vectorScratch_);
+        permute(worldPositions_, order, vectorScratch_);
+        permute(worldOrientations_, order, quaternionScratch_);
+        permute(worldScales_, order, vectorScratch_);
+        permute(worldMatrices_, order, matrixScratch_);
+        permute(dirties_, order, flagScratch_);
+
+        const auto n = order.size();
+        parentSlots_.assign(n, NONE);
+        subtreeSizes_.assign(n, 1);
+        dirtyBegin_ = 0;
+        dirtyEnd_ = 0;
+
+        for (size_t i = 0; i < n; ++i)
+        {
+            auto& node = nodes_[ids_[i]];
+            node.slot = i;
+
+            // Parents are already placed
+            if (node.parent != NONE)
+            {
+                parentSlots_[i] = nodes_[node.parent].slot;
+                dirties_[i] |= dirties_[parentSlots_[i]];
+            }
+
+            if (dirties_[i])
+            {
+                if (dirtyBegin_ == dirtyEnd_)
+                {
+                    dirtyBegin_ = i;
+                }
+                dirtyEnd_ = i + 1;
+            }
+        }
+
+        for (auto i = n; i-- > 0;)
+        {
+            if (parentSlots_[i] != NONE)
+            {
+                subtreeSizes_[parentSlots_[i]] += subtreeSizes_[i];
+            }
+        }
+
+        orderValid_ = true;
+    }
+
+    std::shared_ptr<TransformHierarchy> getDefaultTransformHierarchy()
+    {
+        static const auto hierarchy = std::make_shared<TransformHierarchy>();
+        return hierarchy;
+    }
+    TransformAccessGuard::TransformAccessGuard()
+        : wasForbidden_(accessForbidden)
+    {
+        accessForbidden = true;
+    }
+
+    TransformAccessGuard::~TransformAccessGuard()
+    {
+        accessForbidden = wasForbidden_;
+    }
+
+    bool isTransformAccessForbidden()
+    {
+        return accessForbidden;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,161 @@
+#ifndef _KILLME_TRANSFORMHIERARCHY_H_
+#define _KILLME_TRANSFORMHIERARCHY_H_
+
+#include "vector3.h"
+#include "quaternion.h"
+#include "matrix44.h"
+#include <vector>
+#include <memory>
+#include <thread>
+
+namespace killme
+{
+    class ThreadPool;
+
+    /** Flattened store of transform nodes */
+    /// NOTE: Local and world values are stored in contiguous arrays sorted parent-before-child (depth first order).
+    ///       So the descendants of a node are always the contiguous range after the node,
+    ///       and dirty world values are recomputed by one linear pass in update().
+    ///       Nodes are created, destroyed and reparented only on the thread that constructed the hierarchy, which is asserted.
+    class TransformHierarchy
+    {
+    public:
+        /** Node identifier */
+        /// NOTE: An identifier is stable while the node is alive. Slots in arrays are not.
+        using NodeId = size_t;
+
+        /** Invalid node identifier */
+        static const NodeId NONE = static_cast<NodeId>(-1);
+
+    private:
+        struct Node
+        {
+            size_t slot;
+            NodeId parent;
+            NodeId firstChild;
+            NodeId prevSibling;
+            NodeId nextSibling;
+            bool alive;
+        };
+
+        std::vector<Node> nodes_;
+        std::vector<NodeId> freeNodes_;
+        size_t numNodes_;
+
+        // Arrays in depth first order
+        std::vector<NodeId> ids_;
+        std::vector<size_t> parentSlots_;
+        std::vector<size_t> subtreeSizes_;
+        std::vector<Vector3> positions_;
+        std::vector<Quaternion> orientations_;
+        std::vector<Vector3> scales_;
+        std::vector<Vector3> worldPositions_;
+        std::vector<Quaternion> worldOrientations_;
+        std::vector<Vector3> worldScales_;
+        std::vector<Matrix44> worldMatrices_;
+        std::vector<unsigned char> dirties_;
+
+        bool orderValid_;
+        size_t dirtyBegin_;
+        size_t dirtyEnd_;
+
+        // Scratch buffers for parallel update
+        std::vector<size_t> segments_;
+        std::vector<size_t> splits_;
+
+        // Scratch buffers for resolves and rebuilds of the order. Permuted arrays are swapped with them.
+        std::vector<NodeId> path_;
+        std::vector<size_t> order_;
+        std::vector<NodeId> stack_;
+        std::vector<Vector3> vectorScratch_;
+        std::vector<Quaternion> quaternionScratch_;
+        std::vector<Matrix44> matrixScratch_;
+        std::vector<unsigned char> flagScratch_;
+
+        std::thread::id ownerThread_;
+
+    public:
+        /** Construct */
+        TransformHierarchy();
+
+        /** Create a root node */
+        NodeId create();
+
+        /** Destroy a node */
+        /// NOTE: The children of destroyed node become root nodes.
+        void destroy(NodeId id);
+
+        /** Return count of nodes */
+        size_t getNumNodes() const;
+
+        /** Change the parent */
+        /// NOTE: If you pass NONE as parent, the node becomes a root node.
+        void setParent(NodeId id, NodeId parent);
+
+        /** Return the parent */
+        NodeId getParent(NodeId id) const;
+
+        /** Local values */
+        Vector3 getPosition(NodeId id) const;
+        void setPosition(NodeId id, const Vector3& pos);
+        Quaternion getOrientation(NodeId id) const;
+        void setOrientation(NodeId id, const Quaternion& q);
+        Vector3 getScale(NodeId id) const;
+        void setScale(NodeId id, const Vector3& k);
+
+        /** World values */
+        /// NOTE: If the node is dirty, only the path from the nearest clean ancestor is recomputed.
+        Vector3 getWorldPosition(NodeId id);
+        Quaternion getWorldOrientation(NodeId id);
+        Vector3 getWorldScale(NodeId id);
+        Matrix44 getWorldMatrix(NodeId id);
+
+        /** Whether the world values of a node need recompute or not */
+        bool isDirty(NodeId id) const;
+
+        /** Recompute all dirty world values */
+        void update();
+
+        /** Recompute all dirty world values on worker threads */
+        /// NOTE: Dirty subtrees are independent each other, so they are distributed to threads.
+        ///       Large subtrees are split into the subtrees of children. Results are same to update().
+        void update(ThreadPool& pool);
+
+    private:
+        void markDirty(NodeId id);
+        void resolve(NodeId id);
+        void computeWorld(size_t slot, size_t parentSlot);
+        void unlink(NodeId id);
+        void rebuildOrder();
+    };
+
+    /** Return the transform hierarchy used by default */
+    /// NOTE: The hierarchy is constructed by the first call, and the calling thread owns it.
+    ///       Runtime::startup() calls this on the game thread, so transforms are created and destroyed on that thread.
+    std::shared_ptr<TransformHierarchy> getDefaultTransformHierarchy();
+
+    /** Forbid the calling thread to modify transform hierarchies while this is alive */
+    /// NOTE: Even getters of world values update shared caches, so hierarchies are not thread safe.
+    ///       Code that runs concurrently with other code, like parallel ticks, is run in this scope,
+    ///       and modifications and resolves of world values are asserted.
+    class TransformAccessGuard
+    {
+    private:
+        bool wasForbidden_;
+
+    public:
+        /** Forbid */
+        TransformAccessGuard();
+
+        /** Restore */
+        ~TransformAccessGuard();
+
+        TransformAccessGuard(const TransformAccessGuard&) = delete;
+        TransformAccessGuard& operator =(const TransformAccessGuard&) = delete;
+    };
+
+    /** Whether the calling thread is forbidden to modify transform hierarchies */
+    bool isTransformAccessForbidden();
+}
+
+#endif
\ No newline at end of file
@@ -11,4 +11,9 @@
 #define KILLME_DEBUG
 #endif
 
+/** Whether SSE intrinsics are available or not */
+#if defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1) || defined(__SSE__)
+#define KILLME_SSE
+#endif
+
 #endif
\ No newline at end of file
@@ -0,0 +1,92 @@
+#include "threadpool.h"
+
+namespace killme
+{
+    ThreadPool::ThreadPool(size_t numThreads)
+        : workers_()
+        , tasks_()
+        , mutex_()
+        , condition_()
+        , waitCondition_()
+        , numWaiters_(0)
+        , stopped_(false)
+    {
+        for (size_t i = 0; i < numThreads; ++i)
+        {
+            workers_.emplace_back([this]
+            {
+                auto finished = false;
+                while (true)
+                {
+                    std::function<void()> task;
+                    {
+                        std::unique_lock<std::mutex> lock(mutex_);
+
+                        // The finished task may have made a waited future ready
+                        if (finished && numWaiters_ > 0)
+                        {
+                            waitCondition_.notify_all();
+                        }
+
+                        condition_.wait(lock, [&] { return stopped_ || !tasks_.empty(); });
+                        if (tasks_.empty())
+                        {
+                            return;
+                        }
+                        task = std::move(tasks_.front());
+                        tasks_.pop();
+                    }
+                    task();
+                    finished = true;
+                }
+            });
+        }
+    }
+
+    ThreadPool::~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopped_ = true;
+        }
+        condition_.notify_all();
+
+        for (auto& worker : workers_)
+        {
+            worker.join();
+        }
+    }
+
+    size_t ThreadPool::getNumThreads() const
+    {
+        return workers_.size();
+    }
+
+    bool ThreadPool::runPendingTask()
+    {
+        std::function<void()> task;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (tasks_.empty())
+            {
+                return false;
+            }
+            task = std::move(tasks_.front());
+            tasks_.pop();
+        }
+        task();
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (numWaiters_ > 0)
+        {
+            waitCondition_.notify_all();
+        }
+        return true;
+    }
+
+    size_t getDefaultNumWorkerThreads()
+    {
+        const auto n = std::thread::hardware_concurrency();
+        return n > 1 ? n - 1 : 0;
+    }
+}
\ No newline at end of file
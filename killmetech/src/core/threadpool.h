@@ -0,0 +1,141 @@
+#ifndef _KILLME_THREADPOOL_H_
+#define _KILLME_THREADPOOL_H_
+
+#include <vector>
+#include <queue>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <future>
+#include <functional>
+#include <memory>
+#include <atomic>
+#include <exception>
+#include <algorithm>
+#include <chrono>
+
+namespace killme
+{
+    /** Fixed count worker threads */
+    class ThreadPool
+    {
+    private:
+        std::vector<std::thread> workers_;
+        std::queue<std::function<void()>> tasks_;
+        std::mutex mutex_;
+        std::condition_variable condition_;
+        std::condition_variable waitCondition_; // Notified when a task is posted or finished while someone waits
+        size_t numWaiters_;
+        bool stopped_;
+
+    public:
+        /** Construct with count of worker threads */
+        explicit ThreadPool(size_t numThreads);
+
+        /** Wait for all posted tasks and join the worker threads */
+        ~ThreadPool();
+
+        /** Thread pool is noncopyable */
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator =(const ThreadPool&) = delete;
+
+        /** Return count of worker threads */
+        size_t getNumThreads() const;
+
+        /** Run a task on a worker thread */
+        template <class F>
+        auto post(F f)
+            -> std::future<decltype(f())>
+        {
+            using Result = decltype(f());
+            const auto task = std::make_shared<std::packaged_task<Result()>>(std::move(f));
+            auto future = task->get_future();
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                tasks_.emplace([task] { (*task)(); });
+                if (numWaiters_ > 0)
+                {
+                    waitCondition_.notify_all();
+                }
+            }
+            condition_.notify_one();
+            return future;
+        }
+
+        /** Call fun(i) for each i in [0, n) on the worker threads and the calling thread */
+        /// NOTE: Indices are distributed dynamically. Exceptions are rethrown after all calls are finished.
+        template <class Fun>
+        void parallelFor(size_t n, Fun fun)
+        {
+            std::atomic<size_t> next(0);
+            const auto work = [&]
+            {
+                for (auto i = next++; i < n; i = next++)
+                {
+                    fun(i);
+                }
+            };
+
+            std::vector<std::future<void>> futures;
+            const auto numTasks = std::min(workers_.size(), n > 0 ? n - 1 : 0);
+            for (size_t i = 0; i < numTasks; ++i)
+            {
+                futures.emplace_back(post(work));
+            }
+
+            std::exception_ptr error;
+            try
+            {
+                work();
+            }
+            catch (...)
+            {
+                error = std::current_exception();
+            }
+
+            for (auto& f : futures)
+            {
+                wait(f);
+            }
+            if (error)
+            {
+                std::rethrow_exception(error);
+            }
+            for (auto& f : futures)
+            {
+                f.get();
+            }
+        }
+
+        /** Wait for a future. Pending tasks are run on the calling thread while waiting. */
+        /// NOTE: This prevents deadlock when a task waits for other tasks. The caller never blocks while tasks are pending,
+        ///       so nested waits keep running the tasks posted by the waited ones. std::future and std::shared_future are supported.
+        template <class Future>
+        void wait(const Future& f)
+        {
+            const auto ready = [&] { return f.wait_for(std::chrono::seconds(0)) == std::future_status::ready; };
+            while (!ready())
+            {
+                if (runPendingTask())
+                {
+                    continue;
+                }
+
+                // Sleep until a task is posted or finished. The timeout covers futures completed out of the pool.
+                std::unique_lock<std::mutex> lock(mutex_);
+                ++numWaiters_;
+                waitCondition_.wait_for(lock, std::chrono::milliseconds(1), [&] { return !tasks_.empty() || ready(); });
+                --numWaiters_;
+            }
+        }
+
+        /** Run a pending task on the calling thread. Return false if no task is pending. */
+        bool runPendingTask();
+    };
+
+    /** Return count of worker threads suitable for this machine */
+    /// NOTE: The calling thread is excluded.
+    size_t getDefaultNumWorkerThreads();
+}
+
+#endif
\ No newline at end of file
@@ -12,19 +12,31 @@ namespace killme
 {
     /** Variant type */
     /// TODO: Not support hold reference value
+    /// NOTE: Trivially copyable values up to BUFFER_SIZE bytes are stored inline without heap allocation.
     class Variant
     {
+    public:
+        /** Size of the inline storage */
+        static constexpr size_t BUFFER_SIZE = 64;
+
     private:
         template <class T>
         using FixedType = std::remove_const_t<std::remove_reference_t<T>>;
 
-        // Holder
+        using Storage = std::aligned_storage_t<BUFFER_SIZE, alignof(double)>;
+
+        template <class T>
+        using IsInline = std::integral_constant<bool,
+            std::is_trivially_copyable<T>::value && sizeof(T) <= BUFFER_SIZE && alignof(T) <= alignof(Storage)>;
+
+        template <class T>
+        using EnableIfValue = std::enable_if_t<!std::is_same<FixedType<T>, Variant>::value>;
+
+        // Holder for heap stored values
         struct Holder
         {
             virtual ~Holder() noexcept = default;
             virtual Holder* copy() const = 0;
-            virtual TypeNumber type() const noexcept = 0;
-            virtual size_t sizeOf() const noexcept = 0;
             virtual const void* ptr() const noexcept = 0;
         };
 
@@ -37,61 +49,86 @@ namespace killme
             TypedHolder(U&& val) : value(std::forward<U>(val)) {}
 
             Holder* copy() const { return new TypedHolder<T>(value); }
-            TypeNumber type() const noexcept { return typeNumber<T>(); }
-            size_t sizeOf() const noexcept { return sizeof(T); }
             const void* ptr() const noexcept { return &value; }
         };
 
+        TypeNumber type_;
+        size_t size_;
         std::shared_ptr<Holder> holder_;
+        Storage buffer_;
 
     public:
         /** Construct */
-        Variant() noexcept = default;
+        Variant() noexcept
+            : type_(nullptr)
+            , size_(0)
+            , holder_()
+            , buffer_()
+        {
+        }
 
         /** Construct with a value  */
         /// TOOD: We does not use explicit
-        template <class T, class U = FixedType<T>>
+        template <class T, class U = FixedType<T>, class = EnableIfValue<T>>
         explicit Variant(T&& value)
-            : holder_(std::make_shared<TypedHolder<U>>(std::forward<T>(value)))
+            : Variant()
         {
+            store<U>(std::forward<T>(value), IsInline<U>());
         }
 
         /** Copy constructor */
-        Variant(const Variant& lhs) noexcept
-            : holder_()
+        Variant(const Variant& lhs)
+            : Variant()
         {
             *this = lhs;
         }
 
         /** Move constructor */
         Variant(Variant&& rhs) noexcept
-            : holder_(std::move(rhs.holder_))
+            : Variant()
         {
+            *this = std::move(rhs);
         }
 
         /** Assignment operator with a value */
-        template <class T, class U = FixedType<T>>
+        template <class T, class U = FixedType<T>, class = EnableIfValue<T>>
         Variant& operator =(T&& value)
         {
-            holder_ = std::make_shared<TypedHolder<U>>(std::forward<T>(value));
+            store<U>(std::forward<T>(value), IsInline<U>());
             return *this;
         }
 
         /** Copy assignment operator */
         Variant& operator =(const Variant& lhs)
         {
-            holder_ = lhs.holder_;
-            if (holder_)
+            if (this == &lhs)
+            {
+                return *this;
+            }
+
+            type_ = lhs.type_;
+            size_ = lhs.size_;
+            if (lhs.holder_)
+            {
+                holder_.reset(lhs.holder_->copy());
+            }
+            else
             {
-                holder_.reset(holder_->copy());
+                holder_.reset();
             }
+            buffer_ = lhs.buffer_;
             return *this;
         }
 
         /** Move assignment operator */
         Variant& operator =(Variant&& rhs) noexcept
         {
+            type_ = rhs.type_;
+            size_ = rhs.size_;
             holder_ = std::move(rhs.holder_);
+            buffer_ = rhs.buffer_;
+            rhs.type_ = nullptr;
+            rhs.size_ = 0;
             return *this;
         }
 
@@ -103,7 +140,7 @@ namespace killme
             {
                 return false;
             }
-            return std::dynamic_pointer_cast<TypedHolder<U>>(holder_)->value == a;
+            return *static_cast<const U*>(ptr()) == a;
         }
 
         // Cast
@@ -112,7 +149,7 @@ namespace killme
         {
             assert(hasValue() && "Variant has not value.");
             assert(killme::is<U>(*this) && "Variant type not match.");
-            return static_cast<const U&>(std::dynamic_pointer_cast<TypedHolder<U>>(holder_)->value);
+            return static_cast<const U&>(*static_cast<const U*>(ptr()));
         }
 
         /** ditto */
@@ -139,17 +176,13 @@ namespace killme
         /** Return true if Variant has a value */
         bool hasValue() const noexcept
         {
-            return !!holder_;
+            return type_ != nullptr;
         }
 
         /** Return size of the hold value */
         size_t sizeOf() const noexcept
         {
-            if (!hasValue())
-            {
-                return 0;
-            }
-            return holder_->sizeOf();
+            return size_;
         }
 
         /** Return pointer of the hold value */
@@ -159,14 +192,34 @@ namespace killme
             {
                 return nullptr;
             }
-            return holder_->ptr();
+            return holder_ ? holder_->ptr() : &buffer_;
         }
 
         // For killme::is()
         template <class T>
         bool isSame() const noexcept
         {
-            return hasValue() && typeNumber<T>() == holder_->type();
+            return hasValue() && typeNumber<T>() == type_;
+        }
+
+    private:
+        template <class U, class T>
+        void store(T&& value, std::true_type)
+        {
+            // The value may be a part of this variant
+            U temp(std::forward<T>(value));
+            holder_.reset();
+            new(&buffer_) U(temp);
+            type_ = typeNumber<U>();
+            size_ = sizeof(U);
+        }
+
+        template <class U, class T>
+        void store(T&& value, std::false_type)
+        {
+            holder_ = std::make_shared<TypedHolder<U>>(std::forward<T>(value));
+            type_ = typeNumber<U>();
+            size_ = sizeof(U);
         }
     };
 
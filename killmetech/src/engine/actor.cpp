@@ -132,6 +132,26 @@ namespace killme
         tickable_ = enable;
     }
 
+    void Actor::setTickGroup(TickGroup group)
+    {
+        if (tickGroup_ == group)
+        {
+            return;
+        }
+
+        tickGroup_ = group;
+        if (isActive_ && tickable_)
+        {
+            // Move to the scheduler of the new group
+            tickingProcess_ = getOwnerLevel().registerTicking(*this);
+        }
+    }
+
+    TickGroup Actor::getTickGroup() const
+    {
+        return tickGroup_;
+    }
+
     Actor::Actor()
         : inLevel_()
         , name_()
@@ -139,6 +159,7 @@ namespace killme
         , conceptComponents_()
         , rootTransform_()
         , tickable_(false)
+        , tickGroup_(TickGroup::prePhysics)
         , isActive_(false)
         , tickingProcess_()
     {
@@ -36,6 +36,7 @@ namespace killme
         std::vector<std::shared_ptr<ActorComponent>> conceptComponents_;
         std::shared_ptr<TransformComponent> rootTransform_;
         bool tickable_;
+        TickGroup tickGroup_;
         bool isActive_;
         Process tickingProcess_;
 
@@ -109,6 +110,12 @@ namespace killme
         /** If set to true, this actor ticked every frame */
         void setTickable(bool enable);
 
+        /** Set the tick group. The default is TickGroup::prePhysics. */
+        void setTickGroup(TickGroup group);
+
+        /** Return the tick group */
+        TickGroup getTickGroup() const;
+
     protected:
         /** Construct */
         Actor();
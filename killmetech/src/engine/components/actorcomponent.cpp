@@ -77,10 +77,52 @@ namespace killme
         tickable_ = enable;
     }
 
+    void ActorComponent::setTickGroup(TickGroup group)
+    {
+        if (tickGroup_ == group)
+        {
+            return;
+        }
+
+        tickGroup_ = group;
+        if (isActive_ && tickable_)
+        {
+            // Move to the scheduler of the new group
+            tickingProcess_ = getOwnerLevel().registerTicking(*this);
+        }
+    }
+
+    TickGroup ActorComponent::getTickGroup() const
+    {
+        return tickGroup_;
+    }
+
+    void ActorComponent::setParallelTickable(bool enable)
+    {
+        if (parallelTickable_ == enable)
+        {
+            return;
+        }
+
+        parallelTickable_ = enable;
+        if (isActive_ && tickable_)
+        {
+            // Move to the other group
+            tickingProcess_ = getOwnerLevel().registerTicking(*this);
+        }
+    }
+
+    bool ActorComponent::isParallelTickable() const
+    {
+        return parallelTickable_;
+    }
+
     ActorComponent::ActorComponent()
         : owner_(nullptr)
         , isActive_(false)
         , tickable_(false)
+        , parallelTickable_(false)
+        , tickGroup_(TickGroup::prePhysics)
         , tickingProcess_()
     {
     }
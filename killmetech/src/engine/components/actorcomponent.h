@@ -28,6 +28,8 @@ namespace killme
         Actor* owner_;
         bool isActive_;
         bool tickable_;
+        bool parallelTickable_;
+        TickGroup tickGroup_;
         Process tickingProcess_;
 
     public:
@@ -59,6 +61,21 @@ namespace killme
         /** If set to true, this component ticked every frame */
         void setTickable(bool enable);
 
+        /** Set the tick group. The default is TickGroup::prePhysics. */
+        void setTickGroup(TickGroup group);
+
+        /** Return the tick group */
+        TickGroup getTickGroup() const;
+
+        /** If set to true, this component is ticked on worker threads with other such components */
+        /// NOTE: onTick() must be thread safe against other parallel tickable components.
+        ///       It must not access transforms, because world values are resolved lazily into shared caches.
+        ///       This is asserted by TransformAccessGuard. Move transforms in a serial tick instead.
+        void setParallelTickable(bool enable);
+
+        /** Return whether this component is ticked on worker threads */
+        bool isParallelTickable() const;
+
     protected:
         /** Construct */
         ActorComponent();
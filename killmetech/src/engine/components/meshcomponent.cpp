@@ -19,16 +19,27 @@ namespace killme
     void MeshComponent::onTranslated()
     {
         inst_->setPosition(getWorldPosition());
+        updateBounds();
     }
 
     void MeshComponent::onRotated()
     {
         inst_->setOrientation(getWorldOrientation());
+        updateBounds();
     }
 
     void MeshComponent::onScaled()
     {
         inst_->setScale(getWorldScale());
+        updateBounds();
+    }
+
+    void MeshComponent::updateBounds()
+    {
+        if (isActive())
+        {
+            getOwnerLevel().getGraphicsWorld().updateMeshInstance(inst_);
+        }
     }
 
     void MeshComponent::onActivate()
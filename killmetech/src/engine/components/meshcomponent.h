@@ -29,6 +29,8 @@ namespace killme
         Resource<Mesh> getMesh();
 
     private:
+        void updateBounds();
+
         void onTranslated();
         void onRotated();
         void onScaled();
@@ -19,11 +19,21 @@ namespace killme
     void PointLightComponent::setAttenuation(float range, float constant, float liner, float quadratic)
     {
         light_->setAttenuation(range, constant, liner, quadratic);
+        updateBounds();
     }
 
     void PointLightComponent::onTranslated()
     {
         light_->setPosition(getWorldPosition());
+        updateBounds();
+    }
+
+    void PointLightComponent::updateBounds()
+    {
+        if (isActive())
+        {
+            getOwnerLevel().getGraphicsWorld().updateLight(light_);
+        }
     }
 
     void PointLightComponent::onActivate()
@@ -28,6 +28,8 @@ namespace killme
         void setAttenuation(float range, float constant, float liner, float quadratic);
 
     private:
+        void updateBounds();
+
         void onTranslated();
 
         void onActivate();
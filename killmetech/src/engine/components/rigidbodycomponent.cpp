@@ -22,10 +22,11 @@ namespace killme
 
     void RigidBodyComponent::Listener::onMoved(const Vector3& pos, const Quaternion& q)
     {
-        owner->setMoveRecievable(false);
-        owner->setWorldPosition(pos);
-        owner->setWorldOrientation(q);
-        owner->setMoveRecievable(true);
+        // Committed after the simulation step. The body itself needs no feedback.
+        auto& batch = owner->getOwnerLevel().getMoveBatch();
+        batch.setWorldPosition(*owner, pos);
+        batch.setWorldOrientation(*owner, q);
+        batch.mute(*owner);
     }
 
     void RigidBodyComponent::Listener::onCollided(RigidBody& collider)
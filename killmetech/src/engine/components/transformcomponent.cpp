@@ -1,6 +1,6 @@
 #include "transformcomponent.h"
-#include <vector>
-#include <utility>
+#include <algorithm>
+#include <cassert>
 
 namespace killme
 {
@@ -36,110 +36,374 @@ namespace killme
         return preWorldPosition_;
     }
 
-    void TransformComponent::setPosition(const Vector3& pos)
+    namespace
     {
-        std::vector<std::pair<TransformComponent*, Vector3>> ignore;
-        std::vector<TransformComponent*> receive;
+        // Commit a single move with the batch reused in each thread
+        template <class Set>
+        void commitSingleMove(Set set)
+        {
+            thread_local TransformMoveBatch scratch;
 
-        depthTraverse(*this, [&](TransformComponent& n) {
-            if (&n != this && n.isIgnoringParentMove())
+            // A move in callbacks of the scratch batch is committed immediately by a new batch
+            if (scratch.isCommitting())
             {
-                ignore.emplace_back(&n, n.getWorldPosition());
-                return false;
+                TransformMoveBatch batch;
+                set(batch);
+                batch.commit();
             }
-            if (n.isMoveRecievable())
+            else
             {
-                receive.emplace_back(&n);
+                set(scratch);
+                scratch.commit();
             }
-            return true;
-        });
+        }
+    }
 
-        Transform::setPosition(pos);
+    void TransformComponent::setPosition(const Vector3& pos)
+    {
+        // Leaves need no traversal
+        if (getNumChildren() == 0)
+        {
+            Transform::setPosition(pos);
+            if (moveReceivable_)
+            {
+                onTranslated();
+            }
+            return;
+        }
+        commitSingleMove([&](TransformMoveBatch& batch) { batch.setPosition(*this, pos); });
+    }
 
-        for (const auto& i : ignore)
+    void TransformComponent::setOrientation(const Quaternion& q)
+    {
+        if (getNumChildren() == 0)
         {
-            const auto lpos = worldPositionToLocal(*i.first->getParent(), i.second);
-            i.first->Transform::setPosition(lpos);
-            i.first->setUpdateNeed(false);
+            Transform::setOrientation(q);
+            if (moveReceivable_)
+            {
+                onRotated();
+            }
+            return;
         }
-        for (const auto r : receive)
+        commitSingleMove([&](TransformMoveBatch& batch) { batch.setOrientation(*this, q); });
+    }
+
+    void TransformComponent::setScale(const Vector3& k)
+    {
+        if (getNumChildren() == 0)
         {
-            r->onTranslated();
+            Transform::setScale(k);
+            if (moveReceivable_)
+            {
+                onScaled();
+            }
+            return;
         }
+        commitSingleMove([&](TransformMoveBatch& batch) { batch.setScale(*this, k); });
     }
 
-    void TransformComponent::setOrientation(const Quaternion& q)
+    void TransformComponent::onBeginFrame()
+    {
+        preWorldPosition_ = getWorldPosition();
+    }
+
+    Vector3 getWorldVelocity(const TransformComponent& transform, float dt_s)
+    {
+        const auto v = transform.getWorldPosition() - transform.getPreWorldPosition();
+        return v / dt_s;
+    }
+
+    namespace
+    {
+        const size_t NO_FIXUP = static_cast<size_t>(-1);
+        const size_t NO_MOVE = static_cast<size_t>(-1);
+
+        size_t getDepth(const Transform& node)
+        {
+            size_t depth = 0;
+            for (auto parent = node.getParent(); parent; parent = parent->getParent())
+            {
+                ++depth;
+            }
+            return depth;
+        }
+    }
+
+    TransformMoveBatch::TransformMoveBatch()
+        : moves_()
+        , moveIndices_()
+        , committing_(false)
+        , numCommits_(0)
+        , applying_()
+        , applyingIndices_()
+        , visits_()
+        , receivers_()
+        , fixups_()
+        , stack_()
+    {
+    }
+
+    void TransformMoveBatch::setPosition(TransformComponent& component, const Vector3& pos)
+    {
+        auto& move = findMove(component);
+        move.flags = (move.flags & ~WORLD_POSITION) | LOCAL_POSITION;
+        move.position = pos;
+    }
+
+    void TransformMoveBatch::setOrientation(TransformComponent& component, const Quaternion& q)
+    {
+        auto& move = findMove(component);
+        move.flags = (move.flags & ~WORLD_ORIENTATION) | LOCAL_ORIENTATION;
+        move.orientation = q;
+    }
+
+    void TransformMoveBatch::setScale(TransformComponent& component, const Vector3& k)
+    {
+        auto& move = findMove(component);
+        move.flags |= LOCAL_SCALE;
+        move.scale = k;
+    }
+
+    void TransformMoveBatch::setWorldPosition(TransformComponent& component, const Vector3& wpos)
+    {
+        auto& move = findMove(component);
+        move.flags = (move.flags & ~LOCAL_POSITION) | WORLD_POSITION;
+        move.position = wpos;
+    }
+
+    void TransformMoveBatch::setWorldOrientation(TransformComponent& component, const Quaternion& wq)
+    {
+        auto& move = findMove(component);
+        move.flags = (move.flags & ~LOCAL_ORIENTATION) | WORLD_ORIENTATION;
+        move.orientation = wq;
+    }
+
+    void TransformMoveBatch::mute(TransformComponent& component)
+    {
+        findMove(component).flags |= MUTED;
+    }
+
+    bool TransformMoveBatch::isEmpty() const
+    {
+        return moves_.empty();
+    }
+
+    bool TransformMoveBatch::isCommitting() const
+    {
+        return committing_;
+    }
+
+    void TransformMoveBatch::commit()
     {
-        std::vector<std::pair<TransformComponent*, Quaternion>> ignore;
-        std::vector<TransformComponent*> receive;
+        assert(!committing_ && "Move batch is already committing.");
+        committing_ = true;
+        ++numCommits_;
 
-        depthTraverse(*this, [&](TransformComponent& n) {
-            if (&n != this && n.isIgnoringParentMove())
+        // Moves set in callbacks are stored into new buffers
+        applying_.swap(moves_);
+        applyingIndices_.swap(moveIndices_);
+
+        // Traverse moved subtrees before any change to take snapshots of ignoring components
+        for (const auto& move : applying_)
+        {
+            unsigned moved = 0;
+            if (move.flags & (LOCAL_POSITION | WORLD_POSITION))
             {
-                ignore.emplace_back(&n, n.getWorldOrientation());
-                return false;
+                moved |= TRANSLATED;
             }
-            if (n.isMoveRecievable())
+            if (move.flags & (LOCAL_ORIENTATION | WORLD_ORIENTATION))
             {
-                receive.emplace_back(&n);
+                moved |= ROTATED;
             }
-            return true;
-        });
+            if (move.flags & LOCAL_SCALE)
+            {
+                moved |= SCALED;
+            }
+            traverse(*move.component, moved, (move.flags & MUTED) != 0);
+        }
 
-        Transform::setOrientation(q);
+        // Ignoring components keep their world values, unless they are moved explicitly
+        for (auto& fixup : fixups_)
+        {
+            const auto id = fixup.component->getHierarchyId();
+            if (id < applyingIndices_.size() && applyingIndices_[id] != NO_MOVE)
+            {
+                const auto flags = applying_[applyingIndices_[id]].flags;
+                if (flags & (LOCAL_POSITION | WORLD_POSITION))
+                {
+                    fixup.flags &= ~TRANSLATED;
+                }
+                if (flags & (LOCAL_ORIENTATION | WORLD_ORIENTATION))
+                {
+                    fixup.flags &= ~ROTATED;
+                }
+                if (flags & LOCAL_SCALE)
+                {
+                    fixup.flags &= ~SCALED;
+                }
+            }
+        }
 
-        for (const auto& i : ignore)
+        // Apply local moves
+        for (const auto& move : applying_)
         {
-            const auto lq = worldOrientationToLocal(*i.first->getParent(), i.second);
-            i.first->Transform::setOrientation(lq);
-            i.first->setUpdateNeed(false);
+            if (move.flags & LOCAL_POSITION)
+            {
+                move.component->Transform::setPosition(move.position);
+            }
+            if (move.flags & LOCAL_ORIENTATION)
+            {
+                move.component->Transform::setOrientation(move.orientation);
+            }
+            if (move.flags & LOCAL_SCALE)
+            {
+                move.component->Transform::setScale(move.scale);
+            }
+
+            if (move.flags & (WORLD_POSITION | WORLD_ORIENTATION))
+            {
+                Fixup fixup = { move.component, 0, 0, move.position, move.orientation, Vector3() };
+                fixup.flags |= (move.flags & WORLD_POSITION) ? TRANSLATED : 0;
+                fixup.flags |= (move.flags & WORLD_ORIENTATION) ? ROTATED : 0;
+                fixups_.emplace_back(fixup);
+            }
         }
-        for (const auto r : receive)
+
+        // Apply world values from parents to children
+        for (auto& fixup : fixups_)
         {
-            r->onRotated();
+            fixup.depth = getDepth(*fixup.component);
         }
-    }
+        std::stable_sort(std::begin(fixups_), std::end(fixups_), [](const Fixup& a, const Fixup& b)
+        {
+            return a.depth < b.depth;
+        });
 
-    void TransformComponent::setScale(const Vector3& k)
-    {
-        std::vector<std::pair<TransformComponent*, Vector3>> ignore;
-        std::vector<TransformComponent*> receive;
+        for (const auto& fixup : fixups_)
+        {
+            const auto node = fixup.component;
+            const auto parent = node->getParent();
+            if (fixup.flags & TRANSLATED)
+            {
+                node->Transform::setPosition(parent ? worldPositionToLocal(*parent, fixup.position) : fixup.position);
+            }
+            if (fixup.flags & ROTATED)
+            {
+                node->Transform::setOrientation(parent ? worldOrientationToLocal(*parent, fixup.orientation) : fixup.orientation);
+            }
+            if (fixup.flags & SCALED)
+            {
+                node->Transform::setScale(parent ? worldScaleToLocal(*parent, fixup.scale) : fixup.scale);
+            }
+        }
 
-        depthTraverse(*this, [&](TransformComponent& n) {
-            if (&n != this && n.isIgnoringParentMove())
+        // Call callbacks
+        for (const auto receiver : receivers_)
+        {
+            const auto notified = visits_[receiver->getHierarchyId()].notified;
+            if (notified & TRANSLATED)
             {
-                ignore.emplace_back(&n, n.getWorldScale());
-                return false;
+                receiver->onTranslated();
             }
-            if (n.isMoveRecievable())
+            if (notified & ROTATED)
             {
-                receive.emplace_back(&n);
+                receiver->onRotated();
             }
-            return true;
-        });
+            if (notified & SCALED)
+            {
+                receiver->onScaled();
+            }
+        }
 
-        Transform::setScale(k);
+        // Clear only the used indices. Visits are cleared by the count of commits.
+        for (const auto& move : applying_)
+        {
+            applyingIndices_[move.id] = NO_MOVE;
+        }
+        applying_.clear();
+        receivers_.clear();
+        fixups_.clear();
+        committing_ = false;
+    }
+
+    TransformMoveBatch::Move& TransformMoveBatch::findMove(TransformComponent& component)
+    {
+        assert(!isTransformAccessForbidden() && "Transforms must not be accessed from this thread now.");
+        assert(component.getHierarchy() == getDefaultTransformHierarchy() && "The component is not in the default hierarchy.");
 
-        for (const auto& i : ignore)
+        const auto id = component.getHierarchyId();
+        if (id >= moveIndices_.size())
         {
-            const auto lk = worldScaleToLocal(*i.first->getParent(), i.second);
-            i.first->Transform::setScale(lk);
-            i.first->setUpdateNeed(false);
+            moveIndices_.resize(id + 1, NO_MOVE);
         }
-        for (const auto r : receive)
+        if (moveIndices_[id] != NO_MOVE)
         {
-            r->onScaled();
+            return moves_[moveIndices_[id]];
         }
+
+        moveIndices_[id] = moves_.size();
+        moves_.push_back({ &component, id, 0, Vector3(), Quaternion(), Vector3(1, 1, 1) });
+        return moves_.back();
     }
 
-    void TransformComponent::onBeginFrame()
+    TransformMoveBatch::Visit& TransformMoveBatch::findVisit(TransformComponent& component)
     {
-        preWorldPosition_ = getWorldPosition();
+        const auto id = component.getHierarchyId();
+        if (id >= visits_.size())
+        {
+            visits_.resize(id + 1, Visit{ 0, 0, 0, NO_FIXUP });
+        }
+
+        auto& visit = visits_[id];
+        if (visit.commit != numCommits_)
+        {
+            visit = Visit{ numCommits_, 0, 0, NO_FIXUP };
+        }
+        return visit;
     }
 
-    Vector3 getWorldVelocity(const TransformComponent& transform, float dt_s)
+    void TransformMoveBatch::traverse(TransformComponent& root, unsigned moved, bool muted)
     {
-        const auto v = transform.getWorldPosition() - transform.getPreWorldPosition();
-        return v / dt_s;
+        stack_.clear();
+        stack_.emplace_back(&root);
+
+        while (!stack_.empty())
+        {
+            const auto node = stack_.back();
+            stack_.pop_back();
+
+            auto& visit = findVisit(*node);
+            if (node != &root && node->isIgnoringParentMove())
+            {
+                if (visit.fixup == NO_FIXUP)
+                {
+                    visit.fixup = fixups_.size();
+                    fixups_.push_back({ node, 0, 0, node->getWorldPosition(), node->getWorldOrientation(), node->getWorldScale() });
+                }
+                fixups_[visit.fixup].flags |= moved;
+                continue;
+            }
+
+            // Already traversed by other moves
+            if ((visit.reached & moved) == moved)
+            {
+                continue;
+            }
+            visit.reached |= moved;
+
+            if (node->isMoveRecievable() && !(node == &root && muted))
+            {
+                if (visit.notified == 0)
+                {
+                    receivers_.emplace_back(node);
+                }
+                visit.notified |= moved;
+            }
+
+            for (const auto& child : node->getChildren())
+            {
+                stack_.emplace_back(static_cast<TransformComponent*>(child.get()));
+            }
+        }
     }
 }
\ No newline at end of file
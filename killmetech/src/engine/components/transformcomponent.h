@@ -5,10 +5,13 @@
 #include "../actor.h"
 #include "../../core/math/transform.h"
 #include "../../core/math/vector3.h"
+#include "../../core/math/quaternion.h"
+#include <vector>
 
 namespace killme
 {
     class Process;
+    class TransformMoveBatch;
 
     /** The transform component defines transform into an actor. */
     class TransformComponent : public ActorComponent, public Transform
@@ -17,6 +20,8 @@ namespace killme
             KILLME_HOOK_LEVEL_EVENT(LEVEL_BeginFrame, &TransformComponent::onBeginFrame)
         KILLME_COMPONENT_DEFINE_END
 
+        friend class TransformMoveBatch;
+
     private:
         Vector3 preWorldPosition_;
         bool moveReceivable_;
@@ -41,6 +46,8 @@ namespace killme
         /** Return world relative position when frame begin */
         Vector3 getPreWorldPosition() const;
 
+        /** Set local relative values, and call callbacks of this and descendants */
+        /// NOTE: Leaves are moved directly, and others are moved by a batch reused in each thread.
         void setPosition(const Vector3& pos);
         void setOrientation(const Quaternion& q);
         void setScale(const Vector3& k);
@@ -54,6 +61,106 @@ namespace killme
         void onBeginFrame();
     };
 
+    /** Coalesce moves of transform components */
+    /// NOTE: Moves are applied on commit(). Each subtree is traversed once and
+    ///       each of onTranslated(), onRotated() and onScaled() is called at most once per component.
+    ///       Components must be alive until commit(). Moves set in the callbacks are not applied by the running commit().
+    ///       Bookkeeping arrays are indexed by the hierarchy id, so components must be in the default hierarchy.
+    class TransformMoveBatch
+    {
+    private:
+        enum : unsigned
+        {
+            LOCAL_POSITION = 1 << 0,
+            LOCAL_ORIENTATION = 1 << 1,
+            LOCAL_SCALE = 1 << 2,
+            WORLD_POSITION = 1 << 3,
+            WORLD_ORIENTATION = 1 << 4,
+            MUTED = 1 << 5
+        };
+
+        enum : unsigned
+        {
+            TRANSLATED = 1 << 0,
+            ROTATED = 1 << 1,
+            SCALED = 1 << 2
+        };
+
+        struct Move
+        {
+            TransformComponent* component;
+            TransformHierarchy::NodeId id;
+            unsigned flags;
+            Vector3 position;
+            Quaternion orientation;
+            Vector3 scale;
+        };
+
+        struct Visit
+        {
+            size_t commit; // Visits of previous commits are stale
+            unsigned reached;
+            unsigned notified;
+            size_t fixup;
+        };
+
+        struct Fixup
+        {
+            TransformComponent* component;
+            size_t depth;
+            unsigned flags;
+            Vector3 position;
+            Quaternion orientation;
+            Vector3 scale;
+        };
+
+        std::vector<Move> moves_;
+        std::vector<size_t> moveIndices_; // By the hierarchy id
+        bool committing_;
+        size_t numCommits_;
+
+        // Scratch buffers reused by each commit
+        std::vector<Move> applying_;
+        std::vector<size_t> applyingIndices_;
+        std::vector<Visit> visits_; // By the hierarchy id
+        std::vector<TransformComponent*> receivers_;
+        std::vector<Fixup> fixups_;
+        std::vector<TransformComponent*> stack_;
+
+    public:
+        /** Construct */
+        TransformMoveBatch();
+
+        /** Set local relative values */
+        void setPosition(TransformComponent& component, const Vector3& pos);
+        void setOrientation(TransformComponent& component, const Quaternion& q);
+        void setScale(TransformComponent& component, const Vector3& k);
+
+        /** Set world relative values */
+        /// NOTE: World values are converted to local on commit(), after parents are moved.
+        void setWorldPosition(TransformComponent& component, const Vector3& wpos);
+        void setWorldOrientation(TransformComponent& component, const Quaternion& wq);
+
+        /** Suppress callbacks of a moved component itself */
+        /// NOTE: Callbacks of its descendants are not suppressed.
+        void mute(TransformComponent& component);
+
+        /** Whether there are no moves or not */
+        bool isEmpty() const;
+
+        /** Whether commit() is running or not */
+        bool isCommitting() const;
+
+        /** Apply all moves and call callbacks */
+        /// NOTE: Moves set in the callbacks are kept for next commit().
+        void commit();
+
+    private:
+        Move& findMove(TransformComponent& component);
+        Visit& findVisit(TransformComponent& component);
+        void traverse(TransformComponent& root, unsigned moved, bool muted);
+    };
+
     /** Return world relative world from pre frame */
     Vector3 getWorldVelocity(const TransformComponent& transform, float dt_s);
 
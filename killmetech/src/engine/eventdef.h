@@ -2,6 +2,7 @@
 #define _KILLME_EVENTDEF_H_
 
 #include "../events/event.h"
+#include "../events/eventtype.h"
 #include "../events/eventdispatcher.h"
 #include "../core/variant.h"
 #include <vector>
@@ -11,7 +12,7 @@
 #include <cassert>
 
 /** Event define utilities */
-#define KILLME_DEFINE_EVENT(name) const std::string name = #name
+#define KILLME_DEFINE_EVENT(name) const killme::EventType name(#name)
 #define KILLME_DEFINE_LEVEL_EVENT(name, ...) KILLME_DEFINE_EVENT(LEVEL_##name)
 #define KILLME_DEFINE_ACTOR_EVENT(name, ...) KILLME_DEFINE_EVENT(ACTOR_##name)
 #define KILLME_DEFINE_COMPONENT_EVENT(name, ...) KILLME_DEFINE_EVENT(COMPONENT_##name)
@@ -66,57 +67,30 @@ namespace killme
 
     namespace detail
     {
+        // Make a listener calling a hook function. Typed emit() with the same parameter types calls it directly.
         template <class C, class R, class... Args>
-        struct UnpackEventCall
+        EventListener makeHookListener(R(*fun)(Args...), C&)
         {
-            template <class Fun>
-            static R call(Fun fun, C& c, const Event& e)
-            {
-                return impl(fun, c, e, makeIndexSequence<sizeof...(Args)>());
-            }
-
-            template <size_t... Indices>
-            static R impl(R(*fun)(Args...), C&, const Event& e, IndexSequence<Indices...>)
-            {
-                return fun(to<NthType<Indices, Args...>>(e[Indices])...);
-            }
-
-            template <size_t... Indices>
-            static R impl(R(C::*fun)(Args...), C& c, const Event& e, IndexSequence<Indices...>)
-            {
-                return (c.*fun)(to<NthType<Indices, Args...>>(e[Indices])...);
-            }
-
-            template <size_t... Indices>
-            static R impl(R(C::*fun)(Args...) const, C& c, const Event& e, IndexSequence<Indices...>)
-            {
-                return (c.*fun)(to<NthType<Indices, Args...>>(e[Indices])...);
-            }
-        };
-
-        template <class C, class R, class... Args>
-        R unpackEventCall(R(*fun)(Args...), C& c, const Event& e)
-        {
-            return UnpackEventCall<C, R, Args...>::call(fun, c, e);
+            return makeTypedEventListener<std::decay_t<Args>...>([fun](const std::decay_t<Args>&... args) { fun(args...); });
         }
 
         template <class C, class R, class... Args>
-        R unpackEventCall(R(C::*fun)(Args...), C& c, const Event& e)
+        EventListener makeHookListener(R(C::*fun)(Args...), C& c)
         {
-            return UnpackEventCall<C, R, Args...>::call(fun, c, e);
+            return makeTypedEventListener<std::decay_t<Args>...>([fun, &c](const std::decay_t<Args>&... args) { (c.*fun)(args...); });
         }
 
         template <class C, class R, class... Args>
-        R unpackEventCall(R(C::*fun)(Args...) const, C& c, const Event& e)
+        EventListener makeHookListener(R(C::*fun)(Args...) const, C& c)
         {
-            return UnpackEventCall<C, R, Args...>::call(fun, c, e);
+            return makeTypedEventListener<std::decay_t<Args>...>([fun, &c](const std::decay_t<Args>&... args) { (c.*fun)(args...); });
         }
 
         struct EventHookInfo
         {
             bool levelEvent;
-            std::string type;
-            std::function<void(const Event&)> hook;
+            EventType type;
+            EventListener listener;
         };
 
         extern void* enabler;
@@ -138,11 +112,11 @@ namespace killme
 
 /** Define a level event hook */
 #define KILLME_HOOK_LEVEL_EVENT(type, fun) \
-    { true, type, [&](const killme::Event& e) { killme::detail::unpackEventCall(fun, *this, e); } },
+    { true, type, killme::detail::makeHookListener(fun, *this) },
 
 /** Define an actor event hook */
 #define KILLME_HOOK_ACTOR_EVENT(type, fun) \
-    { false, type, [&](const killme::Event& e) { killme::detail::unpackEventCall(fun, *this, e); } },
+    { false, type, killme::detail::makeHookListener(fun, *this) },
 
 /** End event hooks definition */
 #define KILLME_EVENT_HOOKS_END \
@@ -152,7 +126,7 @@ namespace killme
         auto it = std::cbegin(this->KILLME_EVENT_HOOK_INFORMATIONS); \
         const auto end = std::cend(this->KILLME_EVENT_HOOK_INFORMATIONS); \
         while (it != end) { \
-            if (it->levelEvent) { this->KILLME_EVENT_HOOK_CONNECTIONS.emplace_back(this->connect(it->type, it->hook)); } \
+            if (it->levelEvent) { this->KILLME_EVENT_HOOK_CONNECTIONS.emplace_back(this->connect(it->type, it->listener)); } \
             else { assert(false && "You can not hook actor events from level by KILLME_CONNECT_EVENT_HOOKS macro."); } \
             ++it; \
         } \
@@ -162,8 +136,8 @@ namespace killme
         auto it = std::cbegin(this->KILLME_EVENT_HOOK_INFORMATIONS); \
         const auto end = std::cend(this->KILLME_EVENT_HOOK_INFORMATIONS); \
         while (it != end) { \
-            if (it->levelEvent) { this->KILLME_EVENT_HOOK_CONNECTIONS.emplace_back(this->getOwnerLevel().connect(it->type, it->hook)); } \
-            else { this->KILLME_EVENT_HOOK_CONNECTIONS.emplace_back(this->connect(it->type, it->hook)); } \
+            if (it->levelEvent) { this->KILLME_EVENT_HOOK_CONNECTIONS.emplace_back(this->getOwnerLevel().connect(it->type, it->listener)); } \
+            else { this->KILLME_EVENT_HOOK_CONNECTIONS.emplace_back(this->connect(it->type, it->listener)); } \
             ++it; \
         } \
     } \
@@ -172,8 +146,8 @@ namespace killme
         auto it = std::cbegin(this->KILLME_EVENT_HOOK_INFORMATIONS); \
         const auto end = std::cend(this->KILLME_EVENT_HOOK_INFORMATIONS); \
         while (it != end) { \
-            if (it->levelEvent) { this->KILLME_EVENT_HOOK_CONNECTIONS.emplace_back(this->getOwnerLevel().connect(it->type, it->hook)); } \
-            else { this->KILLME_EVENT_HOOK_CONNECTIONS.emplace_back(this->getOwnerActor().connect(it->type, it->hook)); } \
+            if (it->levelEvent) { this->KILLME_EVENT_HOOK_CONNECTIONS.emplace_back(this->getOwnerLevel().connect(it->type, it->listener)); } \
+            else { this->KILLME_EVENT_HOOK_CONNECTIONS.emplace_back(this->getOwnerActor().connect(it->type, it->listener)); } \
             ++it; \
         } \
     } \
@@ -11,20 +11,14 @@ namespace killme
 
     void GraphicsSystem::startup(HWND window)
     {
-        RECT clientRect;
-        GetClientRect(window, &clientRect);
-
-        const auto clientWidth = clientRect.right - clientRect.left;
-        const auto clientHeight = clientRect.bottom - clientRect.top;
-
-        clientViewport_.topLeftX = 0;
-        clientViewport_.topLeftY = 0;
-        clientViewport_.width = static_cast<float>(clientWidth);
-        clientViewport_.height = static_cast<float>(clientHeight);
-        clientViewport_.minDepth = 0;
-        clientViewport_.maxDepth = 1;
-
         renderSystem_ = std::make_unique<RenderSystem>(window);
+        updateClientViewport();
+    }
+
+    void GraphicsSystem::startup(size_t width, size_t height)
+    {
+        renderSystem_ = std::make_unique<RenderSystem>(width, height);
+        updateClientViewport();
     }
 
     void GraphicsSystem::shutdown()
@@ -74,4 +68,14 @@ namespace killme
     {
         renderSystem_->presentBackBuffer();
     }
+
+    void GraphicsSystem::updateClientViewport()
+    {
+        clientViewport_.topLeftX = 0;
+        clientViewport_.topLeftY = 0;
+        clientViewport_.width = static_cast<float>(renderSystem_->getClientWidth());
+        clientViewport_.height = static_cast<float>(renderSystem_->getClientHeight());
+        clientViewport_.minDepth = 0;
+        clientViewport_.maxDepth = 1;
+    }
 }
\ No newline at end of file
@@ -22,6 +22,9 @@ namespace killme
         /** Initialize the graphics subsystem */
         void startup(HWND window);
 
+        /** Initialize the graphics subsystem with the null device for the headless rendering */
+        void startup(size_t width, size_t height);
+
         /** Finalize the graphics subsystem */
         void shutdown();
 
@@ -42,6 +45,9 @@ namespace killme
 
         /** Present current back buffer into screen */
         void presentBackBuffer();
+
+    private:
+        void updateClientViewport();
     };
 
     extern GraphicsSystem graphicsSystem;
@@ -20,7 +20,7 @@ namespace killme
     {
 #define KILLME_CASE_VKEY(vkc, key) case vkc: return std::make_tuple(Keycode::key, static_cast<size_t>(Keycode::key), LEVEL_##key)
         // Convert WINAPI keycode to KillMeTech API key code
-        std::tuple<Keycode, size_t, std::string> toKeycode(WPARAM vkc)
+        std::tuple<Keycode, size_t, EventType> toKeycode(WPARAM vkc)
         {
             switch (vkc)
             {
@@ -63,7 +63,8 @@ namespace killme
     {
         while (!eventQueue_.empty())
         {
-            level.emit(eventQueue_.front());
+            const auto& e = eventQueue_.front();
+            level.emit(std::get<0>(e), std::get<1>(e), std::get<2>(e));
             eventQueue_.pop();
         }
     }
@@ -2,10 +2,11 @@
 #define _KILLME_INPUTMANAGER_H_
 
 #include "keycode.h"
-#include "../events/event.h"
+#include "../events/eventtype.h"
 #include <Windows.h>
 #include <array>
 #include <queue>
+#include <tuple>
 
 namespace killme
 {
@@ -16,7 +17,7 @@ namespace killme
     {
     private:
         std::array<bool, NUM_KEY_CODES> keyStatus_;
-        std::queue<Event> eventQueue_;
+        std::queue<std::tuple<EventType, bool, bool>> eventQueue_;
 
     public:
         /** Construct */
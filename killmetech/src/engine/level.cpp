@@ -1,12 +1,15 @@
 #include "level.h"
 #include "actor.h"
 #include "components/actorcomponent.h"
+#include "components/transformcomponent.h"
 #include "audiosystem.h"
 #include "graphicssystem.h"
 #include "../processes/process.h"
 #include "../physics/physicsworld.h"
 #include "../audio/audioworld.h"
 #include "../scene/scene.h"
+#include "../core/math/transformhierarchy.h"
+#include "../core/threadpool.h"
 
 namespace killme
 {
@@ -56,6 +59,16 @@ namespace killme
         return *graphicsWorld_;
     }
 
+    ThreadPool& Level::getThreadPool()
+    {
+        return *threadPool_;
+    }
+
+    TransformMoveBatch& Level::getMoveBatch()
+    {
+        return *moveBatch_;
+    }
+
     void Level::begin()
     {
         KILLME_CONNECT_EVENT_HOOKS();
@@ -70,11 +83,23 @@ namespace killme
 
     void Level::tick(float dt_s)
     {
-        onTick(dt_s);
-        tickingActors_.update(dt_s);
-        tickingComponents_.update(dt_s);
-        physicsWorld_->stepSimulation(dt_s);
-        audioWorld_->simulate();
+        tickDelta_ = dt_s;
+        tickGraph_.run(*threadPool_);
+    }
+
+    TaskGraph& Level::getTickGraph()
+    {
+        return tickGraph_;
+    }
+
+    TaskGraph::TaskId Level::getTickTask(TickGroup group) const
+    {
+        return tickTasks_[static_cast<size_t>(group)];
+    }
+
+    float Level::getTickDelta() const
+    {
+        return tickDelta_;
     }
 
     void Level::draw(const FrameResource& frame)
@@ -82,14 +107,48 @@ namespace killme
         graphicsWorld_->renderScene(frame);
     }
 
+    void Level::dispatchPosted()
+    {
+        EventDispatcher::dispatchPosted();
+
+        // Listeners may spawn or despawn actors, and may dispatch posted events again.
+        // So iterate a local array, and give back its capacity afterwards.
+        std::vector<std::shared_ptr<Actor>> actors;
+        actors.swap(dispatchingActors_);
+        for (const auto& actor : actors_)
+        {
+            actors.emplace_back(actor.second);
+        }
+        for (const auto& actor : actors)
+        {
+            actor->dispatchPosted();
+        }
+        actors.clear();
+        if (dispatchingActors_.capacity() < actors.capacity())
+        {
+            dispatchingActors_.swap(actors);
+        }
+    }
+
     Process Level::registerTicking(Actor& actor)
     {
-        return tickingActors_.startProcess([&](float dt_s) { actor.tick(dt_s); });
+        auto& scheduler = tickingActors_[static_cast<size_t>(actor.getTickGroup())];
+        return scheduler.startProcess([&](float dt_s) { actor.tick(dt_s); });
     }
 
     Process Level::registerTicking(ActorComponent& component)
     {
-        return tickingComponents_.startProcess([&](float dt_s) { component.tick(dt_s); });
+        auto& scheduler = tickingComponents_[static_cast<size_t>(component.getTickGroup())];
+        if (component.isParallelTickable())
+        {
+            // Transforms are not thread safe
+            return scheduler.startProcess([&](float dt_s)
+            {
+                TransformAccessGuard guard;
+                component.tick(dt_s);
+            }, ProcessGroup::parallel);
+        }
+        return scheduler.startProcess([&](float dt_s) { component.tick(dt_s); }, ProcessGroup::serial);
     }
 
     Level::Level()
@@ -98,11 +157,83 @@ namespace killme
         , audioWorld_()
         , physicsWorld_()
         , graphicsWorld_()
+        , threadPool_()
+        , moveBatch_()
+        , dispatchingActors_()
         , tickingActors_()
         , tickingComponents_()
+        , tickGraph_()
+        , tickTasks_()
+        , tickDelta_(0)
     {
         physicsWorld_ = std::make_unique<PhysicsWorld>();
         audioWorld_ = std::make_unique<AudioWorld>(audioSystem.getDeviceDetails());
         graphicsWorld_ = std::make_unique<Scene>(graphicsSystem.getRenderSystem());
+        threadPool_ = std::make_unique<ThreadPool>(getDefaultNumWorkerThreads());
+        moveBatch_ = std::make_unique<TransformMoveBatch>();
+        buildTickGraph();
+    }
+
+    void Level::buildTickGraph()
+    {
+        const auto tickGroup = [this](TickGroup group)
+        {
+            const auto i = static_cast<size_t>(group);
+            return [this, i]
+            {
+                tickingActors_[i].update(tickDelta_);
+                tickingComponents_[i].update(*threadPool_, tickDelta_);
+            };
+        };
+
+        // Ticks and user code run on the calling thread. Only the physics step and the audio simulation run on workers.
+        const auto prePhysics = tickGraph_.addTask("PrePhysics", [=]
+        {
+            onTick(tickDelta_);
+            tickGroup(TickGroup::prePhysics)();
+        }, TaskThread::calling);
+        const auto physics = tickGraph_.addTask("Physics", [=]
+        {
+            // The physics step records moves of bodies concurrently
+            TransformAccessGuard guard;
+            tickGroup(TickGroup::physics)();
+        }, TaskThread::calling);
+        const auto postPhysics = tickGraph_.addTask("PostPhysics", tickGroup(TickGroup::postPhysics), TaskThread::calling);
+        const auto preRender = tickGraph_.addTask("PreRender", tickGroup(TickGroup::preRender), TaskThread::calling);
+
+        const auto stepPhysics = tickGraph_.addTask("StepPhysics", [this]
+        {
+            physicsWorld_->stepSimulation(tickDelta_);
+        });
+        const auto simulateAudio = tickGraph_.addTask("SimulateAudio", [this]
+        {
+            audioWorld_->simulate();
+        });
+        const auto commitPhysics = tickGraph_.addTask("CommitPhysics", [this]
+        {
+            // Apply moves of bodies before collision listeners may deactivate or destroy the moved components
+            moveBatch_->commit();
+            physicsWorld_->notifyCollisions();
+        }, TaskThread::calling);
+        const auto updateTransforms = tickGraph_.addTask("UpdateTransforms", [this]
+        {
+            // Recompute world transforms moved in this frame
+            getDefaultTransformHierarchy()->update(*threadPool_);
+        }, TaskThread::calling);
+
+        tickGraph_.precede(prePhysics, physics);
+        tickGraph_.precede(prePhysics, stepPhysics);
+        tickGraph_.precede(prePhysics, simulateAudio);
+        tickGraph_.precede(physics, commitPhysics);
+        tickGraph_.precede(stepPhysics, commitPhysics);
+        tickGraph_.precede(simulateAudio, commitPhysics);
+        tickGraph_.precede(commitPhysics, postPhysics);
+        tickGraph_.precede(postPhysics, updateTransforms);
+        tickGraph_.precede(updateTransforms, preRender);
+
+        tickTasks_[static_cast<size_t>(TickGroup::prePhysics)] = prePhysics;
+        tickTasks_[static_cast<size_t>(TickGroup::physics)] = physics;
+        tickTasks_[static_cast<size_t>(TickGroup::postPhysics)] = postPhysics;
+        tickTasks_[static_cast<size_t>(TickGroup::preRender)] = preRender;
     }
 }
\ No newline at end of file
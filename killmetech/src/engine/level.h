@@ -3,10 +3,12 @@
 
 #include "eventdef.h"
 #include "../processes/processscheduler.h"
+#include "../processes/taskgraph.h"
 #include "../events/eventdispatcher.h"
 #include "../core/utility.h"
 #include <memory>
 #include <unordered_map>
+#include <vector>
 #include <utility>
 #include <string>
 #include <cassert>
@@ -23,8 +25,24 @@ namespace killme
     class AudioWorld;
     class PhysicsWorld;
     class Scene;
+    class ThreadPool;
+    class TransformMoveBatch;
     struct FrameResource;
 
+    /** Tick groups of a level */
+    /// NOTE: Groups are ticked in this order on the calling thread of Level::tick().
+    ///       The physics group is ticked concurrently with the physics step and the audio simulation,
+    ///       so it must not move transforms or bodies, nor add or remove bodies, emitters and listeners, which is asserted.
+    ///       Moves of bodies by the physics step are applied after the physics group.
+    ///       The audio simulation uses positions as of the end of the pre-physics group.
+    enum class TickGroup
+    {
+        prePhysics,
+        physics,
+        postPhysics,
+        preRender
+    };
+
     /** Level */
     class Level : public EventDispatcher
     {
@@ -38,9 +56,17 @@ namespace killme
         std::unique_ptr<AudioWorld> audioWorld_;
         std::unique_ptr<PhysicsWorld> physicsWorld_;
         std::unique_ptr<Scene> graphicsWorld_;
+        std::unique_ptr<ThreadPool> threadPool_;
+        std::unique_ptr<TransformMoveBatch> moveBatch_;
+        std::vector<std::shared_ptr<Actor>> dispatchingActors_;
 
-        ProcessScheduler<float> tickingActors_;
-        ProcessScheduler<float> tickingComponents_;
+        static const size_t NUM_TICK_GROUPS = 4;
+        ProcessScheduler<float> tickingActors_[NUM_TICK_GROUPS];
+        ProcessScheduler<float> tickingComponents_[NUM_TICK_GROUPS];
+
+        TaskGraph tickGraph_;
+        TaskGraph::TaskId tickTasks_[NUM_TICK_GROUPS];
+        float tickDelta_;
 
     public:
         /** Destruct */
@@ -78,6 +104,13 @@ namespace killme
         /** Return the graphics world of this level */
         Scene& getGraphicsWorld();
 
+        /** Return the worker threads of this level */
+        ThreadPool& getThreadPool();
+
+        /** Return the move batch committed after the physics simulation in each tick */
+        /// NOTE: Moves set to this batch in the move callbacks of the commit are applied in the next tick.
+        TransformMoveBatch& getMoveBatch();
+
         /** Begin this level */
         void begin();
 
@@ -85,15 +118,29 @@ namespace killme
         void end();
 
         /** Advance time of this level */
+        /// NOTE: onTick() and the tick groups run on the calling thread. The physics step and the audio simulation run on the thread pool of this level.
         void tick(float dt_s);
 
+        /** Return the task graph run by tick(). You can add tasks and dependencies between ticks. */
+        /// NOTE: Tasks which depend on the calling thread must be added with TaskThread::calling.
+        TaskGraph& getTickGraph();
+
+        /** Return the task of the tick graph that ticks a tick group */
+        TaskGraph::TaskId getTickTask(TickGroup group) const;
+
+        /** Return the delta time of the current tick */
+        float getTickDelta() const;
+
         /** Draw current level */
         void draw(const FrameResource& frame);
 
-        /** Register an actor for ticking */
+        /** Dispatch events posted to this level and to the actors */
+        void dispatchPosted();
+
+        /** Register an actor for ticking in the tick group of the actor */
         Process registerTicking(Actor& actor);
 
-        /** Register a component for ticking */
+        /** Register a component for ticking in the tick group of the component */
         Process registerTicking(ActorComponent& component);
 
     protected:
@@ -109,6 +156,9 @@ namespace killme
 
         /** Called on tick level */
         virtual void onTick(float dt_s) {}
+
+        // Build the default tasks of the tick graph
+        void buildTickGraph();
     };
 }
 
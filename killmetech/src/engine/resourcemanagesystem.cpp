@@ -14,12 +14,22 @@
 #include "../renderer/commandlist.h"
 #include "../renderer/commandqueue.h"
 #include "../renderer/gpuresource.h"
+#include "../windows/console.h"
+#include "../core/platform.h"
 #include "../core/string.h"
+#include <exception>
+#include <chrono>
 
 namespace killme
 {
     ResourceManageSystem resourceManager;
 
+    namespace
+    {
+        // Parsed .material files are cached in this directory
+        const std::string MATERIAL_CACHE_DIRECTORY = "cache";
+    }
+
     ResourceManager& ResourceManageSystem::getManager()
     {
         return *manager_;
@@ -30,14 +40,18 @@ namespace killme
         manager_ = std::make_unique<ResourceManager>();
         fbxImporter_ = std::make_unique<FbxMeshImporter>();
 
-        registerLoader("vhlsl", [](const std::string& path) { return compileHlslShader<VertexShader>(toCharSet(path)); });
-        registerLoader("phlsl", [](const std::string& path) { return compileHlslShader<PixelShader>(toCharSet(path)); });
-        registerLoader("ghlsl", [](const std::string& path) { return compileHlslShader<GeometryShader>(toCharSet(path)); });
-        registerLoader("material", [&](const std::string& path){ return loadMaterial(graphicsSystem.getDevice(), getManager(), path); });
-        registerLoader("bmp", [&](const std::string& path)
+        // Loaders receive bytes in the mounted packs or the memory mapped loose file
+        registerDataLoader("vhlsl", [](const std::string& path, const ResourceData& data) { return compileHlslShader<VertexShader>(path, data.data, data.size); });
+        registerDataLoader("phlsl", [](const std::string& path, const ResourceData& data) { return compileHlslShader<PixelShader>(path, data.data, data.size); });
+        registerDataLoader("ghlsl", [](const std::string& path, const ResourceData& data) { return compileHlslShader<GeometryShader>(path, data.data, data.size); });
+        registerDataLoader("material", [&](const std::string& path, const ResourceData& data)
+        {
+            return loadMaterial(graphicsSystem.getDevice(), getManager(), path, reinterpret_cast<const char*>(data.data), data.size, data.writeTime, MATERIAL_CACHE_DIRECTORY);
+        });
+        registerDataLoader("bmp", [&](const std::string&, const ResourceData& data)
         {
             auto& device = graphicsSystem.getDevice();
-            const auto img = decodeBmpImage(path);
+            const auto img = decodeBmpImage(data.data, data.size);
 
             TextureDescription desc;
             desc.width = img->getWidth();
@@ -60,11 +74,37 @@ namespace killme
             return tex;
         });
         registerLoader("fbx", [&](const std::string& path) { return fbxImporter_->import(graphicsSystem.getDevice(), getManager(), path); });
-        registerLoader("wav", [](const std::string& path) { return loadWavAudio(toCharSet(path)); });
+        registerDataLoader("wav", [](const std::string&, const ResourceData& data) { return loadWavAudio(data.data, data.size); });
+
+#ifdef KILLME_DEBUG
+        // Reload modified materials, shaders and textures while running
+        manager_->enableHotReload(std::chrono::milliseconds(500), [](const ResourceId& id, std::exception_ptr error)
+        {
+            if (!error)
+            {
+                console.writeln(toCharSet("Reloaded " + id.getPath() + ".").c_str());
+                return;
+            }
+
+            try
+            {
+                std::rethrow_exception(error);
+            }
+            catch (const std::exception& e)
+            {
+                console.writeln(toCharSet("Failed to reload " + id.getPath() + ".\n" + e.what()).c_str());
+            }
+        });
+#endif
     }
 
     void ResourceManageSystem::shutdown()
     {
+        if (const auto store = manager_->getStore().lock())
+        {
+            store->waitForLoading();
+        }
+
         unregisterLoader("wav");
         unregisterLoader("fbx");
         unregisterLoader("bmp");
@@ -82,8 +122,23 @@ namespace killme
         manager_->registerLoader(ext, loader);
     }
 
+    void ResourceManageSystem::registerDataLoader(const std::string& ext, ResourceDataLoader loader)
+    {
+        manager_->registerDataLoader(ext, loader);
+    }
+
     void ResourceManageSystem::unregisterLoader(const std::string& ext)
     {
         manager_->unregisterLoader(ext);
     }
+
+    void mountResourcePack(const std::string& path)
+    {
+        resourceManager.getManager().mountPack(path);
+    }
+
+    std::vector<ResourceFuture> prefetchResources(const std::vector<std::string>& paths)
+    {
+        return resourceManager.getManager().prefetch(paths);
+    }
 }
\ No newline at end of file
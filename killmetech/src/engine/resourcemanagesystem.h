@@ -5,6 +5,7 @@
 #include "../resources/resourcemanager.h"
 #include <string>
 #include <memory>
+#include <vector>
 
 namespace killme
 {
@@ -29,6 +30,7 @@ namespace killme
 
         /** Resource loader register */
         void registerLoader(const std::string& ext, ResourceLoader loader);
+        void registerDataLoader(const std::string& ext, ResourceDataLoader loader);
         void unregisterLoader(const std::string& ext);
     };
 
@@ -42,6 +44,22 @@ namespace killme
         r.access();
         return r;
     }
+
+    /** Return media resource accessor, and start loading on the loading threads */
+    /// NOTE: Resource<T>::access() returns the placeholder until loaded.
+    template <class T>
+    Resource<T> loadResourceAsync(const std::string& path, const std::shared_ptr<T>& placeholder)
+    {
+        const Resource<T> r(resourceManager.getManager(), path, placeholder);
+        r.access();
+        return r;
+    }
+
+    /** Mount a resource pack built by buildResourcePack() */
+    void mountResourcePack(const std::string& path);
+
+    /** Start loading resources on the loading threads. Call in Level::onBegin() with the manifest of the level. */
+    std::vector<ResourceFuture> prefetchResources(const std::vector<std::string>& paths);
 }
 
 #endif
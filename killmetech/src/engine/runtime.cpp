@@ -7,6 +7,7 @@
 #include "inputmanager.h"
 #include "debug.h"
 #include "../windows/winsupport.h"
+#include "../core/math/transformhierarchy.h"
 #include "../core/exception.h"
 #include <cassert>
 
@@ -89,6 +90,9 @@ namespace killme
                 windowWidth, windowHeight, NULL, NULL, instance, NULL),
             "Failed to create the window."));
 
+        // Transforms are created on this thread, so it owns the default hierarchy
+        getDefaultTransformHierarchy();
+
         // Initialize subsystems
         resourceManager.startup();
         audioSystem.startup();
@@ -222,8 +226,10 @@ namespace killme
 
                 // Tick frame
                 level.emit(LEVEL_BeginFrame);
+                level.dispatchPosted();
                 inputManager.emitInputEvents(level);
                 level.tick(dt_s);
+                level.dispatchPosted();
                 graphicsSystem.clearBackBuffer();
                 level.draw(graphicsSystem.getCurrentFrameResource());
                 KILLME_DEBUG_DRAW(level.getGraphicsWorld(), graphicsSystem.getCurrentFrameResource());
@@ -1,6 +1,7 @@
 #ifndef _KILLME_EVENT_H_
 #define _KILLME_EVENT_H_
 
+#include "eventtype.h"
 #include "../core/variant.h"
 #include <string>
 #include <vector>
@@ -25,13 +26,13 @@ namespace killme
     class Event
     {
     private:
-        std::string type_;
+        EventType type_;
         std::vector<Variant> params_;
 
     public:
         /** Construct */
         template <class... Params>
-        Event(const std::string& type, Params&&... params)
+        Event(const EventType& type, Params&&... params)
             : type_(type)
             , params_()
         {
@@ -39,12 +40,25 @@ namespace killme
             detail::variantArray(params_, std::forward<Params>(params)...);
         }
 
+        /** ditto */
+        template <class... Params>
+        Event(const std::string& type, Params&&... params)
+            : Event(EventType(type), std::forward<Params>(params)...)
+        {
+        }
+
         /** Return the event type */
-        std::string getType() const
+        EventType getType() const
         {
             return type_;
         }
 
+        /** Return count of parameters */
+        size_t getNumParams() const
+        {
+            return params_.size();
+        }
+
         /** Accesses to i'th parameter */
         const Variant& operator [](size_t i) const
         {
@@ -1,66 +1,326 @@
 #include "eventdispatcher.h"
 #include "../core/utility.h"
-#include "../core/string.h"
-#include <unordered_map>
 #include <vector>
 #include <tuple>
+#include <algorithm>
+#include <atomic>
+#include <new>
+#include <type_traits>
 
 namespace killme
 {
     namespace detail
     {
+        // The event is constructed in the storage while the node is posted
+        struct PostedEvent
+        {
+            std::aligned_storage_t<sizeof(Event), alignof(Event)> storage;
+            PostedEvent* next;
+
+            Event& event() { return *reinterpret_cast<Event*>(&storage); }
+            const Event& event() const { return *reinterpret_cast<const Event*>(&storage); }
+        };
+
+        // Dispatched nodes are recycled by all dispatchers.
+        // The consumer pushes them by CAS, and a producer takes all of them at once into the cache of its thread,
+        // so that nodes are never popped one by one concurrently (no ABA problem).
+        struct PostedEventPool
+        {
+            std::atomic<PostedEvent*> recycled;
+
+            PostedEventPool() : recycled(nullptr) {}
+            ~PostedEventPool() { deleteNodes(recycled.exchange(nullptr)); }
+
+            static void deleteNodes(PostedEvent* node)
+            {
+                while (node)
+                {
+                    const auto next = node->next;
+                    delete node;
+                    node = next;
+                }
+            }
+        };
+
+        PostedEventPool& getPostedEventPool()
+        {
+            static PostedEventPool pool;
+            return pool;
+        }
+
+        struct PostedEventCache
+        {
+            PostedEvent* head;
+
+            PostedEventCache() : head(nullptr) {}
+            ~PostedEventCache() { PostedEventPool::deleteNodes(head); }
+        };
+
+        PostedEvent* obtainPostedEvent(Event&& e)
+        {
+            thread_local PostedEventCache cache;
+            if (!cache.head)
+            {
+                cache.head = getPostedEventPool().recycled.exchange(nullptr, std::memory_order_acquire);
+            }
+
+            auto node = cache.head;
+            if (node)
+            {
+                cache.head = node->next;
+            }
+            else
+            {
+                node = new PostedEvent;
+            }
+            new(&node->storage) Event(std::move(e));
+            return node;
+        }
+
+        // Destroy the events and recycle the nodes at once
+        void releasePostedEvents(PostedEvent* const* nodes, size_t n)
+        {
+            if (n == 0)
+            {
+                return;
+            }
+
+            for (size_t i = 0; i < n; ++i)
+            {
+                nodes[i]->event().~Event();
+                nodes[i]->next = i + 1 < n ? nodes[i + 1] : nullptr;
+            }
+
+            auto& recycled = getPostedEventPool().recycled;
+            auto& tail = nodes[n - 1]->next;
+            tail = recycled.load(std::memory_order_relaxed);
+            while (!recycled.compare_exchange_weak(tail, nodes[0], std::memory_order_release, std::memory_order_relaxed))
+            {
+            }
+        }
+
         struct DispatcherImpl
         {
-            std::unordered_multimap<std::string, std::pair<size_t, EventDispatcher::EventHook>> hookMap_;
-            std::vector<std::tuple<std::string, size_t, EventDispatcher::EventHook>> connects_;
-            std::vector<std::tuple<std::string, size_t>> disconnects_;
+            // Listener arrays indexed by the event type id
+            std::vector<std::vector<std::pair<size_t, EventListener>>> listeners_;
+            std::vector<std::tuple<size_t, size_t, EventListener>> connects_;
+            std::vector<std::tuple<size_t, size_t>> disconnects_;
+            size_t emitDepth_;
 
             UniqueCounter<size_t> uniqueId_;
 
+            // Posted events in reverse order. Producers push by CAS, the consumer takes all at once.
+            std::atomic<PostedEvent*> posted_;
+            std::vector<PostedEvent*> dispatching_;
+
         public:
-            size_t connect(const std::string& type, EventDispatcher::EventHook hook)
+            DispatcherImpl()
+                : listeners_()
+                , connects_()
+                , disconnects_()
+                , emitDepth_(0)
+                , uniqueId_()
+                , posted_(nullptr)
+                , dispatching_()
+            {
+            }
+
+            ~DispatcherImpl()
+            {
+                auto node = posted_.exchange(nullptr);
+                while (node)
+                {
+                    const auto next = node->next;
+                    node->event().~Event();
+                    delete node;
+                    node = next;
+                }
+            }
+
+            void post(Event&& e)
+            {
+                const auto node = obtainPostedEvent(std::move(e));
+                node->next = posted_.load(std::memory_order_relaxed);
+                while (!posted_.compare_exchange_weak(node->next, node, std::memory_order_release, std::memory_order_relaxed))
+                {
+                }
+            }
+
+            void dispatchPosted()
+            {
+                if (!posted_.load(std::memory_order_relaxed))
+                {
+                    return;
+                }
+
+                // Restore post order, and group by type stably
+                auto node = posted_.exchange(nullptr, std::memory_order_acquire);
+                const auto begin = dispatching_.size();
+                while (node)
+                {
+                    dispatching_.emplace_back(node);
+                    node = node->next;
+                }
+                std::reverse(std::begin(dispatching_) + begin, std::end(dispatching_));
+                std::stable_sort(std::begin(dispatching_) + begin, std::end(dispatching_), [](const PostedEvent* a, const PostedEvent* b)
+                {
+                    return a->event().getType().getId() < b->event().getType().getId();
+                });
+
+                // Release events even if a listener throws
+                struct Cleanup
+                {
+                    std::vector<PostedEvent*>& events;
+                    size_t begin;
+                    ~Cleanup()
+                    {
+                        releasePostedEvents(events.data() + begin, events.size() - begin);
+                        events.resize(begin);
+                    }
+                } cleanup = { dispatching_, begin };
+
+                // Each listener array is walked once per group
+                auto first = begin;
+                while (first < dispatching_.size())
+                {
+                    const auto type = dispatching_[first]->event().getType().getId();
+                    auto last = first + 1;
+                    while (last < dispatching_.size() && dispatching_[last]->event().getType().getId() == type)
+                    {
+                        ++last;
+                    }
+
+                    if (const auto listeners = beginEmit(type))
+                    {
+                        EmitScope scope(*this);
+                        const auto n = listeners->size();
+                        for (size_t i = 0; i < n; ++i)
+                        {
+                            const auto& hook = (*listeners)[i].second.hook;
+                            for (auto j = first; j < last; ++j)
+                            {
+                                hook(dispatching_[j]->event());
+                            }
+                        }
+                    }
+
+                    first = last;
+                }
+            }
+
+            size_t connect(size_t type, const EventListener& listener)
             {
                 const auto id = uniqueId_();
-                connects_.emplace_back(type, id, hook);
+                connects_.emplace_back(type, id, listener);
                 return id;
             }
 
-            void disconnect(const std::string& type, size_t id)
+            void disconnect(size_t type, size_t id)
             {
                 disconnects_.emplace_back(type, id);
             }
 
             void emit(const Event& e)
             {
-                for (const auto& t : connects_)
+                const auto listeners = beginEmit(e.getType().getId());
+                if (!listeners)
                 {
-                    hookMap_.emplace(std::get<0>(t), std::make_pair(std::get<1>(t), std::get<2>(t)));
+                    return;
                 }
-                for (const auto& t : disconnects_)
+
+                EmitScope scope(*this);
+                const auto n = listeners->size();
+                for (size_t i = 0; i < n; ++i)
                 {
-                    auto range = hookMap_.equal_range(std::get<0>(t));
-                    while (range.first != range.second)
+                    (*listeners)[i].second.hook(e);
+                }
+            }
+
+            void emit(const EventType& type, const TypedEmission& emission)
+            {
+                const auto listeners = beginEmit(type.getId());
+                if (!listeners)
+                {
+                    return;
+                }
+
+                // The boxed event is made only if a listener has no matched typed hook
+                std::unique_ptr<Event> boxed;
+
+                EmitScope scope(*this);
+                const auto n = listeners->size();
+                for (size_t i = 0; i < n; ++i)
+                {
+                    const auto& listener = (*listeners)[i].second;
+                    if (listener.typedHook && listener.typedHookType == emission.hookType)
                     {
-                        if (range.first->second.first == std::get<1>(t))
-                        {
-                            range.first = hookMap_.erase(range.first);
-                        }
-                        else
+                        emission.invoke(listener.typedHook.get(), emission.params);
+                    }
+                    else
+                    {
+                        if (!boxed)
                         {
-                            ++range.first;
+                            boxed = std::make_unique<Event>(emission.box(type, emission.params));
                         }
+                        listener.hook(*boxed);
                     }
                 }
+            }
 
-                connects_.clear();
-                disconnects_.clear();
+        private:
+            // Listener arrays are not modified while emitting
+            struct EmitScope
+            {
+                DispatcherImpl& impl;
+                explicit EmitScope(DispatcherImpl& i) : impl(i) { ++impl.emitDepth_; }
+                ~EmitScope() { --impl.emitDepth_; }
+            };
+
+            const std::vector<std::pair<size_t, EventListener>>* beginEmit(size_t type)
+            {
+                if (emitDepth_ == 0 && (!connects_.empty() || !disconnects_.empty()))
+                {
+                    flush();
+                }
+
+                if (type >= listeners_.size() || listeners_[type].empty())
+                {
+                    return nullptr;
+                }
+                return &listeners_[type];
+            }
 
-                auto range = hookMap_.equal_range(toLowers(e.getType()));
-                while (range.first != range.second)
+            void flush()
+            {
+                for (auto& t : connects_)
                 {
-                    range.first->second.second(e);
-                    ++range.first;
+                    const auto type = std::get<0>(t);
+                    if (type >= listeners_.size())
+                    {
+                        listeners_.resize(type + 1);
+                    }
+                    listeners_[type].emplace_back(std::get<1>(t), std::move(std::get<2>(t)));
+                }
+                for (const auto& t : disconnects_)
+                {
+                    const auto type = std::get<0>(t);
+                    if (type >= listeners_.size())
+                    {
+                        continue;
+                    }
+
+                    auto& listeners = listeners_[type];
+                    const auto id = std::get<1>(t);
+                    const auto it = std::find_if(std::begin(listeners), std::end(listeners),
+                        [&](const std::pair<size_t, EventListener>& l) { return l.first == id; });
+                    if (it != std::end(listeners))
+                    {
+                        listeners.erase(it);
+                    }
                 }
+
+                connects_.clear();
+                disconnects_.clear();
             }
         };
 
@@ -73,6 +333,11 @@ namespace killme
         }
     }
 
+    EventListener makeEventListener(std::function<void(const Event&)> hook)
+    {
+        return{ std::move(hook), nullptr, nullptr };
+    }
+
     EventConnection::EventConnection(const std::shared_ptr<detail::Disconnector>& disconnector)
         : disconnector_(disconnector)
     {
@@ -88,20 +353,44 @@ namespace killme
     {
     }
 
-    EventConnection EventDispatcher::connect(const std::string& type, EventHook hook)
+    EventConnection EventDispatcher::connect(const EventType& type, const EventListener& listener)
     {
-        const auto lowers = toLowers(type);
-        const auto id = impl_->connect(lowers, hook);
+        const auto id = impl_->connect(type.getId(), listener);
 
         const auto disconnector = std::make_shared<detail::Disconnector>();
         disconnector->id = id;
-        disconnector->type = lowers;
+        disconnector->type = type.getId();
         disconnector->dispatcher = impl_;
         return EventConnection(disconnector);
     }
 
+    EventConnection EventDispatcher::connect(const EventType& type, EventHook hook)
+    {
+        return connect(type, makeEventListener(std::move(hook)));
+    }
+
+    EventConnection EventDispatcher::connect(const std::string& type, EventHook hook)
+    {
+        return connect(EventType(type), std::move(hook));
+    }
+
     void EventDispatcher::emit(const Event& e)
     {
         impl_->emit(e);
     }
+
+    void EventDispatcher::post(Event e)
+    {
+        impl_->post(std::move(e));
+    }
+
+    void EventDispatcher::dispatchPosted()
+    {
+        impl_->dispatchPosted();
+    }
+
+    void EventDispatcher::emitTyped(const EventType& type, const detail::TypedEmission& emission)
+    {
+        impl_->emit(type, emission);
+    }
 }
\ No newline at end of file
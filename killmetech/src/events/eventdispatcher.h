@@ -2,10 +2,14 @@
 #define _KILLME_EVENTDISPATCHER_H_
 
 #include "event.h"
+#include "eventtype.h"
+#include "../core/utility.h"
 #include <string>
 #include <memory>
 #include <functional>
 #include <utility>
+#include <tuple>
+#include <type_traits>
 
 namespace killme
 {
@@ -16,12 +20,86 @@ namespace killme
         struct Disconnector
         {
             std::weak_ptr<DispatcherImpl> dispatcher;
-            std::string type;
+            size_t type;
             size_t id;
             ~Disconnector();
         };
     }
 
+    /** Typed event hook */
+    template <class... Params>
+    using TypedEventHook = std::function<void(const Params&...)>;
+
+    /** Listener of an event type */
+    /// NOTE: The typed hook is called by typed emit() with same parameter types, without boxing parameters into Variant.
+    ///       Otherwise the hook is called with an Event.
+    struct EventListener
+    {
+        std::function<void(const Event&)> hook;
+        std::shared_ptr<const void> typedHook;
+        TypeNumber typedHookType;
+    };
+
+    namespace detail
+    {
+        template <class... Params, size_t... Indices>
+        void callTypedHook(const TypedEventHook<Params...>& hook, const Event& e, IndexSequence<Indices...>)
+        {
+            hook(to<Params>(e[Indices])...);
+        }
+
+        // Parameters of typed emit()
+        struct TypedEmission
+        {
+            TypeNumber hookType;
+            void(*invoke)(const void* hook, const void* params);
+            Event(*box)(const EventType& type, const void* params);
+            const void* params;
+        };
+
+        template <class... Params, size_t... Indices>
+        void invokeTypedHookImpl(const void* hook, const void* params, IndexSequence<Indices...>)
+        {
+            const auto& tuple = *static_cast<const std::tuple<Params...>*>(params);
+            (*static_cast<const TypedEventHook<Params...>*>(hook))(std::get<Indices>(tuple)...);
+        }
+
+        template <class... Params>
+        void invokeTypedHook(const void* hook, const void* params)
+        {
+            invokeTypedHookImpl<Params...>(hook, params, makeIndexSequence<sizeof...(Params)>());
+        }
+
+        template <class... Params, size_t... Indices>
+        Event boxTypedEventImpl(const EventType& type, const void* params, IndexSequence<Indices...>)
+        {
+            const auto& tuple = *static_cast<const std::tuple<Params...>*>(params);
+            return Event(type, std::get<Indices>(tuple)...);
+        }
+
+        template <class... Params>
+        Event boxTypedEvent(const EventType& type, const void* params)
+        {
+            return boxTypedEventImpl<Params...>(type, params, makeIndexSequence<sizeof...(Params)>());
+        }
+    }
+
+    /** Make a listener from an event hook */
+    EventListener makeEventListener(std::function<void(const Event&)> hook);
+
+    /** Make a listener from a typed event hook */
+    template <class... Params, class Fun>
+    EventListener makeTypedEventListener(Fun fun)
+    {
+        using Hook = TypedEventHook<Params...>;
+        const auto typed = std::make_shared<const Hook>(std::move(fun));
+        const auto hook = [typed](const Event& e)
+        {
+            detail::callTypedHook(*typed, e, makeIndexSequence<sizeof...(Params)>());
+        };
+        return{ hook, typed, typeNumber<Hook>() };
+    }
+
     /** Handler of an event hook */
     class EventConnection
     {
@@ -61,18 +139,60 @@ namespace killme
         /** For drived classes */
         virtual ~EventDispatcher() = default;
 
+        /** Add an event listener */
+        EventConnection connect(const EventType& type, const EventListener& listener);
+
         /** Add an event hook */
+        EventConnection connect(const EventType& type, EventHook hook);
+
+        /** ditto */
         EventConnection connect(const std::string& type, EventHook hook);
 
         /** Dispatch an event */
         void emit(const Event& e);
 
+        /** Dispatch an event with parameters */
+        /// NOTE: Parameters are passed to typed hooks without boxing. Other hooks receive a boxed Event.
+        ///       The parameters are stored by value, so that no reference to a temporary is left in the emission.
+        template <class... Params>
+        void emit(const EventType& type, Params&&... params)
+        {
+            const std::tuple<std::decay_t<Params>...> tuple(std::forward<Params>(params)...);
+            const detail::TypedEmission emission =
+            {
+                typeNumber<TypedEventHook<std::decay_t<Params>...>>(),
+                &detail::invokeTypedHook<std::decay_t<Params>...>,
+                &detail::boxTypedEvent<std::decay_t<Params>...>,
+                &tuple
+            };
+            emitTyped(type, emission);
+        }
+
         /** ditto */
         template <class... Params>
         void emit(const std::string& type, Params&&... params)
         {
-            emit(Event(type, std::forward<Params>(params)...));
+            emit(EventType(type), std::forward<Params>(params)...);
+        }
+
+        /** Enqueue an event. It is dispatched by dispatchPosted(). */
+        /// NOTE: post() is thread safe and lock free. Other functions must be called from a single thread.
+        ///       Queue nodes are recycled after dispatched, so posting at a steady rate does not allocate them.
+        void post(Event e);
+
+        /** ditto */
+        template <class... Params>
+        void post(const EventType& type, Params&&... params)
+        {
+            post(Event(type, std::forward<Params>(params)...));
         }
+
+        /** Dispatch all posted events */
+        /// NOTE: Events are grouped by type, and each listener receives the events of a group in post order.
+        virtual void dispatchPosted();
+
+    private:
+        void emitTyped(const EventType& type, const detail::TypedEmission& emission);
     };
 }
 
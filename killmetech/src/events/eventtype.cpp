@@ -0,0 +1,62 @@
+#include "eventtype.h"
+#include "../core/string.h"
+#include <unordered_map>
+#include <vector>
+#include <mutex>
+
+namespace killme
+{
+    namespace
+    {
+        struct EventTypeRegistry
+        {
+            std::mutex mutex;
+            std::unordered_map<std::string, size_t> ids;
+            std::vector<std::string> names;
+        };
+
+        // Event types are constructed in static initialization, so the registry is a function local static
+        EventTypeRegistry& getRegistry()
+        {
+            static EventTypeRegistry registry;
+            return registry;
+        }
+    }
+
+    EventType::EventType(const std::string& name)
+        : id_()
+    {
+        // Ids are never changed, so the cache is valid forever
+        thread_local std::unordered_map<std::string, size_t> cache;
+        const auto cached = cache.find(name);
+        if (cached != std::cend(cache))
+        {
+            id_ = cached->second;
+            return;
+        }
+
+        const auto lowers = toLowers(name);
+        auto& registry = getRegistry();
+
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        const auto it = registry.ids.find(lowers);
+        if (it != std::cend(registry.ids))
+        {
+            id_ = it->second;
+        }
+        else
+        {
+            id_ = registry.names.size();
+            registry.ids.emplace(lowers, id_);
+            registry.names.emplace_back(lowers);
+        }
+        cache.emplace(name, id_);
+    }
+
+    std::string EventType::getName() const
+    {
+        auto& registry = getRegistry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        return registry.names[id_];
+    }
+}
\ No newline at end of file
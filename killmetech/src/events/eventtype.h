@@ -0,0 +1,40 @@
+#ifndef _KILLME_EVENTTYPE_H_
+#define _KILLME_EVENTTYPE_H_
+
+#include <string>
+
+namespace killme
+{
+    /** Interned event type */
+    /// NOTE: Each name is mapped to a small integer once, when the type is constructed.
+    ///       Names are case insensitive. Each thread caches the names it has constructed,
+    ///       so constructing from the same name again, like the string overloads of EventDispatcher, does not lock.
+    class EventType
+    {
+    private:
+        size_t id_;
+
+    public:
+        /** Construct with a name */
+        explicit EventType(const std::string& name);
+
+        /** Return the interned id */
+        size_t getId() const noexcept { return id_; }
+
+        /** Return the name */
+        std::string getName() const;
+    };
+
+    /** Equivalent tests */
+    inline bool operator ==(const EventType& a, const EventType& b) noexcept
+    {
+        return a.getId() == b.getId();
+    }
+
+    inline bool operator !=(const EventType& a, const EventType& b) noexcept
+    {
+        return !(a == b);
+    }
+}
+
+#endif
\ No newline at end of file
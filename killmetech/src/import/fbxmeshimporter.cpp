@@ -18,6 +18,7 @@ namespace killme
 {
     FbxMeshImporter::FbxMeshImporter()
         : fbxManager_(makeFbxUnique(FbxManager::Create()))
+        , mutex_()
     {
         const auto ios = FbxIOSettings::Create(fbxManager_.get(), IOSROOT);
         fbxManager_->SetIOSettings(ios);
@@ -542,7 +543,10 @@ namespace killme
                     device.reuseCommandListAfterExecution(commands);
 
                     const Resource<Material> material(resources, "media/box.material");
-                    parsedMesh->createSubmesh(fbxMesh->GetName(), vertexData, material);
+                    const auto numPositions = cache.positions.size() / 3;
+                    parsedMesh->createSubmesh(fbxMesh->GetName(), vertexData, material,
+                        makeBoundingBox(cache.positions.data(), numPositions),
+                        makeBoundingSphere(cache.positions.data(), numPositions));
                 }
 
                 const auto numChildren = top->GetChildCount();
@@ -558,6 +562,8 @@ namespace killme
 
     std::shared_ptr<Mesh> FbxMeshImporter::import(RenderDevice& device, ResourceManager& resources, const std::string& path)
     {
+        std::lock_guard<std::mutex> lock(mutex_);
+
         // Get fullpath
         /// TODO: _fullpath() is windows only
         char fullpash[512];
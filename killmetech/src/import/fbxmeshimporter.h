@@ -4,6 +4,7 @@
 #include "fbxsupport.h"
 #include <fbxsdk.h>
 #include <memory>
+#include <mutex>
 #include <string>
 
 namespace killme
@@ -17,12 +18,14 @@ namespace killme
     {
     private:
         FbxUniquePtr<FbxManager> fbxManager_;
+        std::mutex mutex_;
 
     public:
         /** Constructs */
         FbxMeshImporter();
 
         /** Imports a mesh */
+        /// NOTE: Imports are serialized, because the fbx manager is not thread safe.
         std::shared_ptr<Mesh> import(RenderDevice& device, ResourceManager& resources, const std::string& path);
     };
 }
@@ -57,6 +57,9 @@ namespace killme
         , solver_()
         , world_()
         , rigidBodies_()
+        , collidedObjects_()
+        , debugDrawer_()
+        , simulating_(false)
     {
         config_ = std::make_unique<btDefaultCollisionConfiguration>();
         dispather_ = std::make_unique<btCollisionDispatcher>(config_.get());
@@ -78,12 +81,14 @@ namespace killme
 
     void PhysicsWorld::debugDraw(const std::shared_ptr<PhysicsDebugDrawer>& drawer)
     {
+        assert(!simulating_ && "The physics world must not be modified during the simulation.");
         debugDrawer_ = drawer;
         world_->setDebugDrawer(debugDrawer_.get());
     }
 
     void PhysicsWorld::addRigidBody(const std::shared_ptr<RigidBody>& body)
     {
+        assert(!simulating_ && "The physics world must not be modified during the simulation.");
         const auto added = rigidBodies_.emplace(body);
         if (added.second)
         {
@@ -93,6 +98,7 @@ namespace killme
 
     void PhysicsWorld::removeRigidBody(const std::shared_ptr<RigidBody>& body)
     {
+        assert(!simulating_ && "The physics world must not be modified during the simulation.");
         const auto n = rigidBodies_.erase(body);
         if (n > 0)
         {
@@ -103,13 +109,23 @@ namespace killme
     void PhysicsWorld::stepSimulation(float dt_s)
     {
         static const auto FIXED_TIME_STEP = 0.01666666754f;
-        std::unordered_map<RigidBody*, std::unordered_set<RigidBody*>> collidedObjects;
 
-        world_->setWorldUserInfo(&collidedObjects);
+        simulating_ = true;
+        collidedObjects_.clear();
+        world_->setWorldUserInfo(&collidedObjects_);
         world_->stepSimulation(dt_s, static_cast<int>(dt_s / FIXED_TIME_STEP + 1.0001f), FIXED_TIME_STEP);
         world_->setWorldUserInfo(nullptr);
 
-        for (const auto& objA : collidedObjects)
+        if (debugDrawer_)
+        {
+            world_->debugDrawWorld();
+        }
+        simulating_ = false;
+    }
+
+    void PhysicsWorld::notifyCollisions()
+    {
+        for (const auto& objA : collidedObjects_)
         {
             for (const auto& objB : objA.second)
             {
@@ -117,10 +133,6 @@ namespace killme
                 objB->notifyCollision(*objA.first);
             }
         }
-
-        if (debugDrawer_)
-        {
-            world_->debugDrawWorld();
-        }
+        collidedObjects_.clear();
     }
 }
\ No newline at end of file
@@ -8,7 +8,9 @@
 #include <BulletDynamics/Dynamics/btDynamicsWorld.h>
 #include <LinearMath/btIDebugDraw.h>
 #include <memory>
+#include <unordered_map>
 #include <unordered_set>
+#include <atomic>
 
 namespace killme
 {
@@ -41,8 +43,10 @@ namespace killme
         std::unique_ptr<btDynamicsWorld> world_;
 
         std::unordered_set<std::shared_ptr<RigidBody>> rigidBodies_;
+        std::unordered_map<RigidBody*, std::unordered_set<RigidBody*>> collidedObjects_;
 
         std::shared_ptr<btIDebugDraw> debugDrawer_;
+        std::atomic<bool> simulating_;
 
     public:
         /** Construct */
@@ -61,7 +65,12 @@ namespace killme
         void removeRigidBody(const std::shared_ptr<RigidBody>& body);
 
         /** Advance world time */
+        /// NOTE: Collisions are notified by notifyCollisions(), so that moves of bodies can be applied before that.
+        ///       This may be called on a worker thread. The world must not be modified until this returns, which is asserted.
         void stepSimulation(float dt_s);
+
+        /** Notify collisions detected in the last step */
+        void notifyCollisions();
     };
 }
 
@@ -1,6 +1,8 @@
 #include "rigidbody.h"
 #include "collisionshape.h"
 #include "bulletsupport.h"
+#include "../core/math/transformhierarchy.h"
+#include <cassert>
 
 namespace killme
 {
@@ -51,6 +53,7 @@ namespace killme
 
     void RigidBody::setPosition(const Vector3& pos)
     {
+        assert(!isTransformAccessForbidden() && "Rigid bodies must not be moved from this thread now.");
         auto trans = body_->getCenterOfMassTransform();
         trans.setOrigin(to<btVector3>(pos));
         body_->setCenterOfMassTransform(trans);
@@ -59,6 +62,7 @@ namespace killme
 
     void RigidBody::setOrientation(const Quaternion& q)
     {
+        assert(!isTransformAccessForbidden() && "Rigid bodies must not be moved from this thread now.");
         auto trans = body_->getCenterOfMassTransform();
         trans.setRotation(to<btQuaternion>(q));
         body_->setCenterOfMassTransform(trans);
@@ -2,12 +2,13 @@
 #define _KILLME_PROCESSSCHEDULER_H_
 
 #include "process.h"
-#include "../core/utility.h"
+#include "../core/threadpool.h"
 #include <functional>
-#include <unordered_map>
 #include <vector>
 #include <utility>
 #include <memory>
+#include <mutex>
+#include <algorithm>
 
 namespace killme
 {
@@ -15,49 +16,154 @@ namespace killme
     template <class... Args>
     using ProcessFun = std::function<void(Args...)>;
 
+    /** Execution group of a process */
+    enum class ProcessGroup
+    {
+        serial, /// Called in order on the updating thread
+        parallel /// Called on worker threads concurrently with other parallel processes
+    };
+
     /** Process store */
+    /// NOTE: Processes are stored densely per group and removed by swap with the last one.
+    ///       A process id is an index of the handle table, so it keeps valid while the process is alive.
     template <class... Args>
     class ProcessStore
     {
     private:
-        std::unordered_map<size_t, ProcessFun<Args...>> processes_;
+        static const size_t NONE = static_cast<size_t>(-1);
+
+        // Count of parallel processes per task of the thread pool
+        static const size_t PARALLEL_CHUNK_SIZE = 64;
+
+        struct Group
+        {
+            std::vector<ProcessFun<Args...>> funs;
+            std::vector<size_t> ids;
+        };
+
+        struct Handle
+        {
+            ProcessGroup group;
+            size_t slot;
+        };
+
+        Group groups_[2];
+        std::vector<Handle> handles_;
+        std::vector<size_t> freeIds_;
+
+        // Starts and kills are deferred, and may be requested from parallel processes
+        std::mutex mutex_;
         std::vector<std::pair<size_t, ProcessFun<Args...>>> starts_;
         std::vector<size_t> kills_;
 
-        UniqueCounter<size_t> id_;
-
     public:
-        size_t startProcess(ProcessFun<Args...> fun)
+        size_t startProcess(ProcessFun<Args...> fun, ProcessGroup group)
         {
-            const auto id = id_();
-            starts_.emplace_back(id, fun);
+            std::lock_guard<std::mutex> lock(mutex_);
+            size_t id;
+            if (freeIds_.empty())
+            {
+                id = handles_.size();
+                handles_.push_back(Handle{ group, NONE });
+            }
+            else
+            {
+                id = freeIds_.back();
+                freeIds_.pop_back();
+                handles_[id] = Handle{ group, NONE };
+            }
+
+            starts_.emplace_back(id, std::move(fun));
             return id;
         }
 
         void killProcess(size_t id)
         {
+            std::lock_guard<std::mutex> lock(mutex_);
             kills_.emplace_back(id);
         }
 
-        template <class... Types>
-        void update(Types&&... args)
+        void update(const Args&... args)
         {
-            for (const auto& start : starts_)
+            flush();
+            for (const auto& group : groups_)
             {
-                processes_.emplace(start.first, start.second);
+                for (const auto& fun : group.funs)
+                {
+                    fun(args...);
+                }
             }
-            for (const auto& kill : kills_)
+        }
+
+        void update(ThreadPool& pool, const Args&... args)
+        {
+            flush();
+
+            for (const auto& fun : getGroup(ProcessGroup::serial).funs)
             {
-                processes_.erase(kill);
+                fun(args...);
             }
 
-            starts_.clear();
-            kills_.clear();
+            const auto& funs = getGroup(ProcessGroup::parallel).funs;
+            const auto numChunks = (funs.size() + PARALLEL_CHUNK_SIZE - 1) / PARALLEL_CHUNK_SIZE;
+            if (numChunks <= 1)
+            {
+                for (const auto& fun : funs)
+                {
+                    fun(args...);
+                }
+                return;
+            }
+
+            pool.parallelFor(numChunks, [&](size_t chunk)
+            {
+                const auto begin = chunk * PARALLEL_CHUNK_SIZE;
+                const auto end = std::min(begin + PARALLEL_CHUNK_SIZE, funs.size());
+                for (auto i = begin; i < end; ++i)
+                {
+                    funs[i](args...);
+                }
+            });
+        }
+
+    private:
+        Group& getGroup(ProcessGroup group)
+        {
+            return groups_[static_cast<size_t>(group)];
+        }
 
-            for (const auto& p : processes_)
+        void flush()
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (auto& start : starts_)
+            {
+                auto& handle = handles_[start.first];
+                auto& group = getGroup(handle.group);
+                handle.slot = group.funs.size();
+                group.funs.emplace_back(std::move(start.second));
+                group.ids.emplace_back(start.first);
+            }
+            for (const auto id : kills_)
             {
-                p.second(std::forward<Types>(args)...);
+                // Swap with the last process, and fix the handle of the moved one
+                auto& handle = handles_[id];
+                auto& group = getGroup(handle.group);
+                const auto last = group.funs.size() - 1;
+                if (handle.slot != last)
+                {
+                    group.funs[handle.slot] = std::move(group.funs[last]);
+                    group.ids[handle.slot] = group.ids[last];
+                    handles_[group.ids[last]].slot = handle.slot;
+                }
+                group.funs.pop_back();
+                group.ids.pop_back();
+
+                handle.slot = NONE;
+                freeIds_.emplace_back(id);
             }
+
+            starts_.clear();
+            kills_.clear();
         }
     };
 
@@ -94,20 +200,26 @@ namespace killme
         }
 
         /** Create a process */
-        Process startProcess(ProcessFun<Args...> fun)
+        /// NOTE: A parallel process must be thread safe against other parallel processes.
+        Process startProcess(ProcessFun<Args...> fun, ProcessGroup group = ProcessGroup::serial)
         {
-            const auto id = store_->startProcess(fun);
+            const auto id = store_->startProcess(std::move(fun), group);
             const auto killer = std::make_shared<detail::Killer<Args...>>();
             killer->store = store_;
             killer->id = id;
             return Process(killer);
         }
 
-        /** Update processes */
-        template <class... Types>
-        void update(Types&&... args)
+        /** Update all processes on the calling thread */
+        void update(const Args&... args)
+        {
+            store_->update(args...);
+        }
+
+        /** Update processes. Parallel processes are run in chunks on the thread pool after serial processes. */
+        void update(ThreadPool& pool, const Args&... args)
         {
-            store_->update(std::forward<Types>(args)...);
+            store_->update(pool, args...);
         }
     };
 }
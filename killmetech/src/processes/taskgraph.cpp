@@ -0,0 +1,248 @@
+#include "taskgraph.h"
+#include "../core/threadpool.h"
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include <cassert>
+
+namespace killme
+{
+    namespace
+    {
+        // Shared by the running tasks, so it lives until the last task is finished
+        struct RunState
+        {
+            std::unique_ptr<std::atomic<size_t>[]> numWaits;
+            std::unique_ptr<std::atomic<bool>[]> skipped;
+            std::atomic<size_t> numRemains;
+            std::mutex errorMutex;
+            std::exception_ptr error;
+
+            // Ready tasks of TaskThread::calling and the end of the run
+            std::mutex mutex;
+            std::condition_variable condition;
+            std::vector<TaskGraph::TaskId> callingTasks;
+            bool finished;
+        };
+    }
+
+    TaskGraph::TaskGraph()
+        : nodes_()
+        , checked_(true)
+    {
+    }
+
+    TaskGraph::TaskId TaskGraph::addTask(const std::string& name, std::function<void()> fun, TaskThread thread)
+    {
+        nodes_.push_back(Node{ name, std::move(fun), thread, {}, 0 });
+        return nodes_.size() - 1;
+    }
+
+    void TaskGraph::setTask(TaskId task, std::function<void()> fun)
+    {
+        assert(task < nodes_.size() && "Invalid task.");
+        nodes_[task].fun = std::move(fun);
+    }
+
+    void TaskGraph::precede(TaskId before, TaskId after)
+    {
+        assert(before < nodes_.size() && after < nodes_.size() && "Invalid task.");
+        assert(before != after && "A task can not depend on itself.");
+        nodes_[before].successors.emplace_back(after);
+        ++nodes_[after].numPredecessors;
+        checked_ = false;
+    }
+
+    std::string TaskGraph::getName(TaskId task) const
+    {
+        assert(task < nodes_.size() && "Invalid task.");
+        return nodes_[task].name;
+    }
+
+    TaskThread TaskGraph::getThread(TaskId task) const
+    {
+        assert(task < nodes_.size() && "Invalid task.");
+        return nodes_[task].thread;
+    }
+
+    size_t TaskGraph::getNumTasks() const
+    {
+        return nodes_.size();
+    }
+
+    void TaskGraph::run(ThreadPool& pool)
+    {
+        if (nodes_.empty())
+        {
+            return;
+        }
+        if (!checked_)
+        {
+            assert(isAcyclic() && "The task graph has a cycle.");
+            checked_ = true;
+        }
+
+        const auto state = std::make_shared<RunState>();
+        state->numWaits = std::make_unique<std::atomic<size_t>[]>(nodes_.size());
+        state->skipped = std::make_unique<std::atomic<bool>[]>(nodes_.size());
+        state->numRemains = nodes_.size();
+        state->finished = false;
+        for (size_t i = 0; i < nodes_.size(); ++i)
+        {
+            state->numWaits[i] = nodes_[i].numPredecessors;
+            state->skipped[i] = false;
+        }
+
+        // Run a task, then run one of the ready successors on the same thread and hand over others
+        // The last task may destroy this function, so only local copies are used after finishing
+        std::function<void(TaskId, bool)> execute;
+        execute = [&pool, &execute, state, this](TaskId task, bool onCallingThread)
+        {
+            const auto s = state;
+            const auto numTasks = nodes_.size();
+            while (true)
+            {
+                const auto& node = nodes_[task];
+                auto skip = s->skipped[task].load();
+                if (!skip && node.fun)
+                {
+                    try
+                    {
+                        node.fun();
+                    }
+                    catch (...)
+                    {
+                        std::lock_guard<std::mutex> lock(s->errorMutex);
+                        if (!s->error)
+                        {
+                            s->error = std::current_exception();
+                        }
+                        skip = true;
+                    }
+                }
+
+                auto next = numTasks;
+                for (const auto succ : node.successors)
+                {
+                    if (skip)
+                    {
+                        s->skipped[succ] = true;
+                    }
+                    if (--s->numWaits[succ] != 0)
+                    {
+                        continue;
+                    }
+
+                    // The calling thread does not take tasks of the pool, so that workers run them concurrently
+                    const auto onCalling = nodes_[succ].thread == TaskThread::calling;
+                    if (next == numTasks && onCalling == onCallingThread)
+                    {
+                        next = succ;
+                    }
+                    else if (onCalling)
+                    {
+                        std::lock_guard<std::mutex> lock(s->mutex);
+                        s->callingTasks.emplace_back(succ);
+                        s->condition.notify_one();
+                    }
+                    else
+                    {
+                        pool.post([&execute, succ] { execute(succ, false); });
+                    }
+                }
+
+                if (--s->numRemains == 0)
+                {
+                    std::lock_guard<std::mutex> lock(s->mutex);
+                    s->finished = true;
+                    s->condition.notify_one();
+                    return;
+                }
+                if (next == numTasks)
+                {
+                    return;
+                }
+                task = next;
+            }
+        };
+
+        for (TaskId i = 0; i < nodes_.size(); ++i)
+        {
+            if (nodes_[i].numPredecessors != 0)
+            {
+                continue;
+            }
+
+            if (nodes_[i].thread == TaskThread::calling)
+            {
+                state->callingTasks.emplace_back(i);
+            }
+            else
+            {
+                pool.post([&execute, i] { execute(i, false); });
+            }
+        }
+
+        // Run tasks of the calling thread. While none is ready, help the pool, or sleep if it has no pending tasks.
+        while (true)
+        {
+            std::unique_lock<std::mutex> lock(state->mutex);
+            if (state->finished)
+            {
+                break;
+            }
+            if (state->callingTasks.empty())
+            {
+                lock.unlock();
+                if (!pool.runPendingTask())
+                {
+                    lock.lock();
+                    state->condition.wait(lock, [&] { return state->finished || !state->callingTasks.empty(); });
+                }
+                continue;
+            }
+
+            const auto task = state->callingTasks.back();
+            state->callingTasks.pop_back();
+            lock.unlock();
+            execute(task, true);
+        }
+
+        if (state->error)
+        {
+            std::rethrow_exception(state->error);
+        }
+    }
+
+    bool TaskGraph::isAcyclic() const
+    {
+        std::vector<size_t> numWaits(nodes_.size());
+        std::vector<TaskId> ready;
+        for (TaskId i = 0; i < nodes_.size(); ++i)
+        {
+            numWaits[i] = nodes_[i].numPredecessors;
+            if (numWaits[i] == 0)
+            {
+                ready.emplace_back(i);
+            }
+        }
+
+        size_t numVisits = 0;
+        while (!ready.empty())
+        {
+            const auto task = ready.back();
+            ready.pop_back();
+            ++numVisits;
+            for (const auto succ : nodes_[task].successors)
+            {
+                if (--numWaits[succ] == 0)
+                {
+                    ready.emplace_back(succ);
+                }
+            }
+        }
+        return numVisits == nodes_.size();
+    }
+}
\ No newline at end of file
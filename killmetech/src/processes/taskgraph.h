@@ -0,0 +1,72 @@
+#ifndef _KILLME_TASKGRAPH_H_
+#define _KILLME_TASKGRAPH_H_
+
+#include <string>
+#include <vector>
+#include <functional>
+
+namespace killme
+{
+    class ThreadPool;
+
+    /** Threads which a task runs on */
+    enum class TaskThread
+    {
+        any, /// A worker thread or the calling thread of TaskGraph::run()
+        calling /// Only the calling thread of TaskGraph::run(), for code that depends on the thread
+    };
+
+    /** Graph of tasks ordered by dependencies */
+    /// NOTE: Tasks without a path between them may run concurrently.
+    ///       The graph must not be modified while running.
+    class TaskGraph
+    {
+    public:
+        using TaskId = size_t;
+
+    private:
+        struct Node
+        {
+            std::string name;
+            std::function<void()> fun;
+            TaskThread thread;
+            std::vector<TaskId> successors;
+            size_t numPredecessors;
+        };
+
+        std::vector<Node> nodes_;
+        bool checked_;
+
+    public:
+        /** Construct */
+        TaskGraph();
+
+        /** Add a task */
+        TaskId addTask(const std::string& name, std::function<void()> fun, TaskThread thread = TaskThread::any);
+
+        /** Replace the function of a task */
+        void setTask(TaskId task, std::function<void()> fun);
+
+        /** Declare that the task "before" finishes before the task "after" starts */
+        void precede(TaskId before, TaskId after);
+
+        /** Return the name of a task */
+        std::string getName(TaskId task) const;
+
+        /** Return the threads which a task runs on */
+        TaskThread getThread(TaskId task) const;
+
+        /** Return count of tasks */
+        size_t getNumTasks() const;
+
+        /** Run all tasks on the thread pool and the calling thread, and wait for them */
+        /// NOTE: If a task throws, tasks depending on it are skipped, and the first exception is rethrown.
+        ///       While no task of TaskThread::calling is ready, the calling thread runs pending tasks of the pool.
+        void run(ThreadPool& pool);
+
+    private:
+        bool isAcyclic() const;
+    };
+}
+
+#endif
\ No newline at end of file
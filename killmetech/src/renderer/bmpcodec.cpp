@@ -1,8 +1,9 @@
 #include "image.h"
 #include "../core/math/math.h"
 #include "../core/exception.h"
+#include "../windows/mappedfile.h"
 #include <string>
-#include <cstdio>
+#include <cstring>
 #include <cstdint>
 
 namespace killme
@@ -57,25 +58,30 @@ namespace killme
 
     std::shared_ptr<Image> decodeBmpImage(const std::string& path)
     {
-        auto file = enforce<ImageLoadException>(std::fopen(path.c_str(), "rb"), "Failed to open file (" + path + ").");
-        KILLME_SCOPE_EXIT{ fclose(file); };
+        const MappedFile file(path);
+        return decodeBmpImage(file.getData(), file.getSize());
+    }
 
+    std::shared_ptr<Image> decodeBmpImage(const unsigned char* data, size_t size)
+    {
         // Read file header and info header
         BmpFileHeader fileHeader;
         BmpInfoHeader infoHeader;
-        enforce<ImageLoadException>(std::fread(&fileHeader, sizeof(fileHeader), 1, file) == 1, "Invalid .bmp file format.");
-        enforce<ImageLoadException>(std::fread(&infoHeader, sizeof(infoHeader), 1, file) == 1, "Invalid .bmp file format.");
+        enforce<ImageLoadException>(size >= sizeof(fileHeader) + sizeof(infoHeader), "Invalid .bmp file format.");
+        std::memcpy(&fileHeader, data, sizeof(fileHeader));
+        std::memcpy(&infoHeader, data + sizeof(fileHeader), sizeof(infoHeader));
         enforce<ImageLoadException>(checkFormat(fileHeader, infoHeader), "Not supportted .bmp file format.");
 
         // Read color map
         auto image = std::make_shared<Image>(infoHeader.width, infoHeader.height);
         const auto stride = ceiling(infoHeader.width * (infoHeader.bitCount / 8), 4);
-        std::vector<uint8_t> buffer(stride);
+        const size_t offset = sizeof(fileHeader) + sizeof(infoHeader);
+        enforce<ImageLoadException>(size - offset >= static_cast<size_t>(stride) * infoHeader.height, "Invalid .bmp file format.");
 
+        auto it = data + offset;
         for (int32_t y = infoHeader.height - 1; y >= 0; --y)
         {
-            enforce<ImageLoadException>(std::fread(buffer.data(), stride, 1, file) == 1, "Invalid .bmp file format.");
-            auto it = std::cbegin(buffer);
+            const auto row = it;
             for (int32_t x = 0; x < infoHeader.width; ++x)
             {
                 image->at(x, y).b = *it; ++it;
@@ -83,6 +89,7 @@ namespace killme
                 image->at(x, y).r = *it; ++it;
                 image->at(x, y).a = 1;
             }
+            it = row + stride;
         }
 
         return image;
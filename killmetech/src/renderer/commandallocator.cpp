@@ -7,17 +7,27 @@ namespace killme
 {
     void CommandAllocator::initialize()
     {
+        protected_ = false;
+        if (getOwnerDevice()->isNull())
+        {
+            return;
+        }
+
         ID3D12CommandAllocator* allocator;
         enforce<Direct3DException>(
             SUCCEEDED(getD3DOwnerDevice()->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_DIRECT, IID_PPV_ARGS(&allocator))),
             "Failed to create the CommandAllocator.");
         allocator_ = makeComUnique(allocator);
-        protected_ = false;
     }
 
     void CommandAllocator::reset()
     {
         assert(!protected_ && "This CommandAllocator is protected.");
+        if (!allocator_)
+        {
+            return;
+        }
+
         enforce<Direct3DException>(
             SUCCEEDED(allocator_->Reset()),
             "Failed to reset the CommandAllocator.");
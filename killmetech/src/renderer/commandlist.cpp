@@ -1,6 +1,9 @@
 #include "commandlist.h"
 #include "pipelinestate.h"
+#include "d3dsupport.h"
+#include "../core/math/math.h"
 #include "../core/math/color.h"
+#include <cstring>
 
 namespace killme
 {
@@ -9,8 +12,11 @@ namespace killme
         initializeImpl(allocator, pipeline);
         if (pipeline)
         {
-            list_->SetGraphicsRootSignature(getOwnerDevice()->getD3DRootSignature(*pipeline));
-            pipeline->applyParameters(list_.get());
+            if (list_)
+            {
+                list_->SetGraphicsRootSignature(getOwnerDevice()->getD3DRootSignature(*pipeline));
+            }
+            pipeline->applyParameters(*this);
         }
     }
 
@@ -19,39 +25,137 @@ namespace killme
         initializeImpl(allocator, pipeline);
         if (pipeline)
         {
-            list_->SetComputeRootSignature(getOwnerDevice()->getD3DRootSignature(*pipeline));
-            pipeline->applyParameters(list_.get());
+            if (list_)
+            {
+                list_->SetComputeRootSignature(getOwnerDevice()->getD3DRootSignature(*pipeline));
+            }
+            pipeline->applyParameters(*this);
         }
     }
 
     void CommandList::clearRenderTarget(RenderTarget::Location location, const Color& c)
     {
+        if (!list_)
+        {
+            stream_.record(CommandType::clearRenderTarget, location.ofD3D.ptr, 0);
+            return;
+        }
+
         const float rgba[] = {c.r, c.g, c.b, c.a};
         list_->ClearRenderTargetView(location.ofD3D, rgba, 0, nullptr);
     }
 
     void CommandList::clearDepthStencil(DepthStencil::Location location, float depth)
     {
+        if (!list_)
+        {
+            stream_.record(CommandType::clearDepthStencil, location.ofD3D.ptr, 0);
+            return;
+        }
+
         list_->ClearDepthStencilView(location.ofD3D, D3D12_CLEAR_FLAG_DEPTH, depth, 0, 0, nullptr);
     }
 
     void CommandList::draw(size_t numVertices)
     {
+        if (!list_)
+        {
+            stream_.record(CommandType::draw, 0, numVertices);
+            return;
+        }
+
         list_->DrawInstanced(static_cast<UINT>(numVertices), 1, 0, 0);
     }
 
     void CommandList::drawIndexed(size_t numIndices)
     {
+        if (!list_)
+        {
+            stream_.record(CommandType::drawIndexed, 0, numIndices);
+            return;
+        }
+
         list_->DrawIndexedInstanced(numIndices, 1, 0, 0, 0);
     }
 
+    void CommandList::setPipelineState(const std::shared_ptr<PipelineState>& pipeline)
+    {
+        if (list_)
+        {
+            list_->SetPipelineState(getOwnerDevice()->getD3DPipeline(*pipeline));
+            list_->SetGraphicsRootSignature(getOwnerDevice()->getD3DRootSignature(*pipeline));
+        }
+        else
+        {
+            stream_.record(CommandType::setPipelineState, toCommandObject(pipeline.get()), pipeline->getTopLevelHash());
+        }
+        pipeline->applyParameters(*this);
+    }
+
+    D3D12_GPU_VIRTUAL_ADDRESS CommandList::uploadConstants(const void* data, size_t size)
+    {
+        assert(size <= CONSTANT_PAGE_SIZE && "Too large constants.");
+
+        if (!list_)
+        {
+            stream_.recordConstants(data, size);
+            return 0;
+        }
+
+        // Go to the next page if the current page is full
+        const auto alignedSize = ceiling(size, static_cast<size_t>(D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT));
+        if (constantPageIndex_ < constantPages_.size() && constantOffset_ + alignedSize > CONSTANT_PAGE_SIZE)
+        {
+            ++constantPageIndex_;
+            constantOffset_ = 0;
+        }
+
+        if (constantPageIndex_ == constantPages_.size())
+        {
+            const auto uploadHeapProps = getD3DUploadHeapProps();
+            const auto desc = describeD3DBuffer(CONSTANT_PAGE_SIZE);
+
+            ID3D12Resource* buffer;
+            enforce<Direct3DException>(
+                SUCCEEDED(getD3DOwnerDevice()->CreateCommittedResource(&uploadHeapProps, D3D12_HEAP_FLAG_NONE, &desc,
+                    D3D12_RESOURCE_STATE_GENERIC_READ, nullptr, IID_PPV_ARGS(&buffer))),
+                "Failed to create the constant upload heap.");
+
+            ConstantPage page;
+            page.buffer = makeComUnique(buffer);
+            enforce<Direct3DException>(
+                SUCCEEDED(buffer->Map(0, nullptr, reinterpret_cast<void**>(&page.mappedData))),
+                "Failed to map the constant upload heap.");
+            constantPages_.emplace_back(std::move(page));
+        }
+
+        const auto& page = constantPages_[constantPageIndex_];
+        std::memcpy(page.mappedData + constantOffset_, data, size);
+        const auto address = page.buffer->GetGPUVirtualAddress() + constantOffset_;
+        constantOffset_ += alignedSize;
+        return address;
+    }
+
+    void CommandList::hold(const std::shared_ptr<const void>& object)
+    {
+        heldObjects_.emplace_back(object);
+    }
+
+    void CommandList::releaseHeldObjects()
+    {
+        heldObjects_.clear();
+    }
+
     void CommandList::reset(const std::shared_ptr<CommandAllocator>& allocator, const std::shared_ptr<PipelineState>& pipeline)
     {
         resetImpl(allocator, pipeline);
         if (pipeline)
         {
-            list_->SetGraphicsRootSignature(getOwnerDevice()->getD3DRootSignature(*pipeline));
-            pipeline->applyParameters(list_.get());
+            if (list_)
+            {
+                list_->SetGraphicsRootSignature(getOwnerDevice()->getD3DRootSignature(*pipeline));
+            }
+            pipeline->applyParameters(*this);
         }
     }
 
@@ -60,14 +164,24 @@ namespace killme
         resetImpl(allocator, pipeline);
         if (pipeline)
         {
-            list_->SetComputeRootSignature(getOwnerDevice()->getD3DRootSignature(*pipeline));
-            pipeline->applyParameters(list_.get());
+            if (list_)
+            {
+                list_->SetComputeRootSignature(getOwnerDevice()->getD3DRootSignature(*pipeline));
+            }
+            pipeline->applyParameters(*this);
         }
     }
 
     void CommandList::close()
     {
-        enforce<Direct3DException>(SUCCEEDED(list_->Close()), "Failed to close the command list.");
+        if (list_)
+        {
+            enforce<Direct3DException>(SUCCEEDED(list_->Close()), "Failed to close the command list.");
+        }
+        else
+        {
+            stream_.close();
+        }
     }
 
     std::shared_ptr<CommandAllocator> CommandList::getAllocator()
@@ -89,4 +203,9 @@ namespace killme
     {
         return list_.get();
     }
+
+    const CommandStream& CommandList::getCommandStream() const
+    {
+        return stream_;
+    }
 }
\ No newline at end of file
@@ -6,6 +6,7 @@
 #include "rendertarget.h"
 #include "depthstencil.h"
 #include "gpuresource.h"
+#include "commandstream.h"
 #include "d3dsupport.h"
 #include "../windows/winsupport.h"
 #include "../core/exception.h"
@@ -24,9 +25,23 @@ namespace killme
     class CommandList : public RenderDeviceChild
     {
     private:
+        // Upload memory for constants. Pages are kept over resets.
+        struct ConstantPage
+        {
+            ComUniquePtr<ID3D12Resource> buffer;
+            char* mappedData;
+        };
+
+        static const size_t CONSTANT_PAGE_SIZE = 64 * 1024;
+
         ComUniquePtr<ID3D12GraphicsCommandList> list_;
         std::vector<ComUniquePtr<ID3D12Resource>> uploaders_;
+        std::vector<ConstantPage> constantPages_;
+        size_t constantPageIndex_;
+        size_t constantOffset_;
+        std::vector<std::shared_ptr<const void>> heldObjects_;
         std::shared_ptr<CommandAllocator> allocator_;
+        CommandStream stream_; // For the null device
         bool protected_;
 
     public:
@@ -46,10 +61,30 @@ namespace killme
         /** Command of draw call by index */
         void drawIndexed(size_t numIndices);
 
+        /** Change the pipeline state and apply its parameters */
+        /// NOTE: Constant buffers are copied at this time, so you can update them for the next draw.
+        void setPipelineState(const std::shared_ptr<PipelineState>& pipeline);
+
+        /** Copy constants into the upload memory of this list, and return the GPU address */
+        /// NOTE: The memory is valid until the list is reset. The null device returns 0.
+        D3D12_GPU_VIRTUAL_ADDRESS uploadConstants(const void* data, size_t size);
+
+        /** Keep an object alive until the execution of the list is completed, or the list is reset */
+        void hold(const std::shared_ptr<const void>& object);
+
+        /** Release the held objects. CommandQueue calls this when the execution is completed. */
+        void releaseHeldObjects();
+
         /** Update a gpu resource */
         template <class GpuResource>
         void updateGpuResource(const std::shared_ptr<GpuResource>& dest, const void* data)
         {
+            if (!list_)
+            {
+                stream_.record(CommandType::updateGpuResource, dest->getSerial(), 0);
+                return;
+            }
+
             const auto d3dDest = dest->getD3DResource();
 
             // Create upload heap
@@ -71,6 +106,12 @@ namespace killme
         template <class GpuResource>
         void transitionBarrior(const std::shared_ptr<GpuResource>& resource, GpuResourceState before, GpuResourceState after)
         {
+            if (!list_)
+            {
+                stream_.record(CommandType::transitionBarrior, resource->getSerial(), packResourceStates(before, after));
+                return;
+            }
+
             D3D12_RESOURCE_BARRIER barrier;
             ZeroMemory(&barrier, sizeof(barrier));
             barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
@@ -99,21 +140,34 @@ namespace killme
         bool isProtected() const;
 
         /** Returns the Direct3D command list */
+        /// NOTE: The null device returns nullptr.
         ID3D12GraphicsCommandList* getD3DCommandList();
 
+        /** Return recorded commands by the null device */
+        const CommandStream& getCommandStream() const;
+
     private:
         template <class Pipeline>
         void initializeImpl(const std::shared_ptr<CommandAllocator>& allocator, const std::shared_ptr<Pipeline>& pipeline)
         {
-            const auto d3dAllocator = allocator->getD3DAllocator();
-            const auto d3dPipeline = pipeline ? getOwnerDevice()->getD3DPipeline(*pipeline) : nullptr;
-
-            ID3D12GraphicsCommandList* list;
-            enforce<Direct3DException>(
-                SUCCEEDED(getD3DOwnerDevice()->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT, d3dAllocator, d3dPipeline, IID_PPV_ARGS(&list))),
-                "Failed to create the command list.");
-
-            list_ = makeComUnique(list);
+            if (getOwnerDevice()->isNull())
+            {
+                beginStream(pipeline);
+            }
+            else
+            {
+                const auto d3dAllocator = allocator->getD3DAllocator();
+                const auto d3dPipeline = pipeline ? getOwnerDevice()->getD3DPipeline(*pipeline) : nullptr;
+
+                ID3D12GraphicsCommandList* list;
+                enforce<Direct3DException>(
+                    SUCCEEDED(getD3DOwnerDevice()->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT, d3dAllocator, d3dPipeline, IID_PPV_ARGS(&list))),
+                    "Failed to create the command list.");
+                list_ = makeComUnique(list);
+            }
+
+            constantPageIndex_ = 0;
+            constantOffset_ = 0;
             protected_ = false;
             allocator_ = allocator;
         }
@@ -123,13 +177,36 @@ namespace killme
         {
             assert(!protected_ && "This CommandList is protected.");
 
-            const auto d3dAllocator = allocator->getD3DAllocator();
-            const auto d3dPipeline = pipeline ? getOwnerDevice()->getD3DPipeline(*pipeline) : nullptr;
+            if (list_)
+            {
+                const auto d3dAllocator = allocator->getD3DAllocator();
+                const auto d3dPipeline = pipeline ? getOwnerDevice()->getD3DPipeline(*pipeline) : nullptr;
+
+                enforce<Direct3DException>(
+                    SUCCEEDED(list_->Reset(d3dAllocator, d3dPipeline)),
+                    "Failed to reset command list.");
+            }
+            else
+            {
+                beginStream(pipeline);
+            }
 
-            enforce<Direct3DException>(
-                SUCCEEDED(list_->Reset(d3dAllocator, d3dPipeline)),
-                "Failed to reset command list.");
             uploaders_.clear();
+            constantPageIndex_ = 0;
+            constantOffset_ = 0;
+            heldObjects_.clear();
+            allocator_ = allocator;
+        }
+
+        // Like the Direct3D command list, the initial pipeline state is set at the beginning
+        template <class Pipeline>
+        void beginStream(const std::shared_ptr<Pipeline>& pipeline)
+        {
+            stream_.reset();
+            if (pipeline)
+            {
+                stream_.record(CommandType::setPipelineState, toCommandObject(pipeline.get()), pipeline->getTopLevelHash());
+            }
         }
     };
 }
@@ -1,9 +1,18 @@
 #include "commandqueue.h"
+#include "gpuresource.h"
+#include <algorithm>
 
 namespace killme
 {
     void CommandQueue::initialize()
     {
+        // The null device completes commands immediately
+        fenceValue_ = 0;
+        if (getOwnerDevice()->isNull())
+        {
+            return;
+        }
+
         D3D12_COMMAND_QUEUE_DESC queueDesc;
         ZeroMemory(&queueDesc, sizeof(queueDesc));
         queueDesc.Flags = D3D12_COMMAND_QUEUE_FLAG_NONE;
@@ -22,20 +31,43 @@ namespace killme
         fence_ = makeComUnique(fence);
 
         fenceEvent_ = decltype(fenceEvent_)(CreateEventEx(nullptr, nullptr, 0, EVENT_ALL_ACCESS), Closer());
-        fenceValue_ = 0;
+    }
+
+    UINT64 CommandQueue::signal()
+    {
+        std::lock_guard<std::recursive_mutex> lock(mutex_);
+        ++fenceValue_;
+        if (queue_)
+        {
+            enforce<Direct3DException>(
+                SUCCEEDED(queue_->Signal(fence_.get(), fenceValue_)),
+                "Failed to signal of command queue.");
+        }
+        return fenceValue_;
     }
 
     bool CommandQueue::isCompleted() const
     {
-        return fence_->GetCompletedValue() == fenceValue_;
+        return isCompleted(fenceValue_);
+    }
+
+    bool CommandQueue::isCompleted(UINT64 fenceValue) const
+    {
+        return getCompletedValue() >= fenceValue;
     }
 
     void CommandQueue::waitForCommands()
     {
-        if (!isCompleted())
+        waitForFence(fenceValue_);
+    }
+
+    void CommandQueue::waitForFence(UINT64 fenceValue)
+    {
+        std::lock_guard<std::recursive_mutex> lock(mutex_);
+        if (!isCompleted(fenceValue))
         {
             enforce<Direct3DException>(
-                SUCCEEDED(fence_->SetEventOnCompletion(fenceValue_, fenceEvent_.get())),
+                SUCCEEDED(fence_->SetEventOnCompletion(fenceValue, fenceEvent_.get())),
                 "Failed to set the signal event.");
             WaitForSingleObject(fenceEvent_.get(), INFINITE);
         }
@@ -44,25 +76,64 @@ namespace killme
 
     void CommandQueue::updateExecutionState()
     {
-        if (!isCompleted())
-        {
-            return;
-        }
+        std::lock_guard<std::recursive_mutex> lock(mutex_);
 
-        for (const auto& a : executingAllocators_)
-        {
-            a->protect(false);
-        }
-        for (const auto& c : executingCommands_)
+        // Executions are ordered by fence values
+        const auto completedValue = getCompletedValue();
+        while (!executions_.empty() && executions_.front().fenceValue <= completedValue)
         {
-            c->protect(false);
+            const auto exe = executions_.front();
+            executions_.pop_front();
+
+            // An allocator can be shared by lists that are executed later
+            const auto stillExecuting = std::any_of(std::cbegin(executions_), std::cend(executions_),
+                [&](const Execution& e) { return e.allocator == exe.allocator; });
+            if (!stillExecuting)
+            {
+                exe.allocator->protect(false);
+            }
+
+            // Objects drawn by the list are not needed by the GPU any more
+            const auto listExecuting = std::any_of(std::cbegin(executions_), std::cend(executions_),
+                [&](const Execution& e) { return e.commands == exe.commands; });
+            if (!listExecuting)
+            {
+                exe.commands->releaseHeldObjects();
+            }
+            exe.commands->protect(false);
         }
-        executingAllocators_.clear();
-        executingCommands_.clear();
+    }
+
+    const CommandStream& CommandQueue::getExecutedCommands() const
+    {
+        return executedCommands_;
+    }
+
+    void CommandQueue::clearExecutedCommands()
+    {
+        std::lock_guard<std::recursive_mutex> lock(mutex_);
+        executedCommands_.clearCommands();
+    }
+
+    void CommandQueue::trackResourceState(uint64_t serial, GpuResourceState initialState)
+    {
+        std::lock_guard<std::recursive_mutex> lock(mutex_);
+        executedCommands_.setResourceState(serial, static_cast<uint64_t>(initialState));
+    }
+
+    void CommandQueue::untrackResourceState(uint64_t serial)
+    {
+        std::lock_guard<std::recursive_mutex> lock(mutex_);
+        executedCommands_.eraseResourceState(serial);
     }
 
     ID3D12CommandQueue* CommandQueue::getD3DCommandQueue()
     {
         return queue_.get();
     }
+
+    UINT64 CommandQueue::getCompletedValue() const
+    {
+        return fence_ ? fence_->GetCompletedValue() : fenceValue_;
+    }
 }
\ No newline at end of file
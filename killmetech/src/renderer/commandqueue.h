@@ -10,7 +10,8 @@
 #include <Windows.h>
 #include <d3d12.h>
 #include <vector>
-#include <unordered_set>
+#include <deque>
+#include <mutex>
 
 namespace killme
 {
@@ -26,57 +27,103 @@ namespace killme
             }
         };
 
+        // Commands are protected until the fence reaches the value
+        struct Execution
+        {
+            UINT64 fenceValue;
+            std::shared_ptr<CommandAllocator> allocator;
+            std::shared_ptr<CommandList> commands;
+        };
+
         ComUniquePtr<ID3D12CommandQueue> queue_;
         ComUniquePtr<ID3D12Fence> fence_;
         std::unique_ptr<std::remove_pointer_t<HANDLE>, Closer> fenceEvent_;
         UINT64 fenceValue_;
-        std::unordered_set<std::shared_ptr<CommandAllocator>> executingAllocators_;
-        std::unordered_set<std::shared_ptr<CommandList>> executingCommands_;
+        std::deque<Execution> executions_;
+        std::vector<ID3D12CommandList*> d3dCommands_;
+        CommandStream executedCommands_; // For the null device
+        std::recursive_mutex mutex_; // For resource loading threads
 
     public:
         /** Initialize */
         void initialize();
 
-        /** Execute commands */
-        /// NOTE: When this queue is processing any commands yet, wait for complete before execute commands.
+        /** Execute commands. Return the fence value signaled after the commands. */
+        /// NOTE: This does not wait for the execution. Allocators and lists are protected until the execution is completed.
         template <class Range>
-        void executeCommands(const Range& commands)
+        UINT64 executeCommands(const Range& commands)
         {
-            //waitForCommands();
+            std::lock_guard<std::recursive_mutex> lock(mutex_);
 
-            std::vector<ID3D12CommandList*> d3dCommands;
+            d3dCommands_.clear();
             for (const auto& list : commands)
             {
-                const auto allocator = list->getAllocator();
-
-                allocator->protect(true);
+                list->getAllocator()->protect(true);
                 list->protect(true);
-                executingAllocators_.emplace(allocator);
-                executingCommands_.emplace(list);
+                if (queue_)
+                {
+                    d3dCommands_.emplace_back(list->getD3DCommandList());
+                }
+                else
+                {
+                    executedCommands_.append(list->getCommandStream());
+                }
+            }
 
-                d3dCommands.emplace_back(list->getD3DCommandList());
+            if (queue_)
+            {
+                queue_->ExecuteCommandLists(d3dCommands_.size(), d3dCommands_.data());
             }
+            const auto fenceValue = signal();
 
-            queue_->ExecuteCommandLists(d3dCommands.size(), d3dCommands.data());
+            for (const auto& list : commands)
+            {
+                Execution exe;
+                exe.fenceValue = fenceValue;
+                exe.allocator = list->getAllocator();
+                exe.commands = list;
+                executions_.emplace_back(std::move(exe));
+            }
 
-            ++fenceValue_;
-            enforce<Direct3DException>(
-                SUCCEEDED(queue_->Signal(fence_.get(), fenceValue_)),
-                "Failed to signal of command queue.");
-            waitForCommands(); /// TODO: We does not want to wait
+            return fenceValue;
         }
 
+        /** Signal the fence after all submitted commands. Return the fence value. */
+        UINT64 signal();
+
         /** Whether commands execution is finished or not */
         bool isCompleted() const;
 
+        /** Whether commands execution is finished until the fence value */
+        bool isCompleted(UINT64 fenceValue) const;
+
         /** Wait for commands execution */
         void waitForCommands();
 
+        /** Wait for commands execution until the fence value */
+        void waitForFence(UINT64 fenceValue);
+
         /** Update execution state */
         void updateExecutionState();
 
+        /** Return commands executed by the null device */
+        /// NOTE: Resource states are validated through the executed command lists. RenderSystem clears the commands every frame.
+        const CommandStream& getExecutedCommands() const;
+
+        /** Clear commands executed by the null device. The states of resources are kept. */
+        void clearExecutedCommands();
+
+        /** Track the state of a resource created for the null device */
+        void trackResourceState(uint64_t serial, GpuResourceState initialState);
+
+        /** Stop tracking the state of a destroyed resource */
+        void untrackResourceState(uint64_t serial);
+
         /** Return Direct3D command queue */
         ID3D12CommandQueue* getD3DCommandQueue();
+
+    private:
+        UINT64 getCompletedValue() const;
     };
 }
 
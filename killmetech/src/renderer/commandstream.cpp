@@ -0,0 +1,144 @@
+#include "commandstream.h"
+#include <algorithm>
+#include <iterator>
+#include <cassert>
+
+namespace killme
+{
+    InvalidCommandException::InvalidCommandException(const std::string& msg)
+        : Exception(msg)
+    {
+    }
+
+    CommandStream::CommandStream()
+        : commands_()
+        , constants_()
+        , resourceStates_()
+        , hasPipeline_(false)
+        , closed_(false)
+    {
+    }
+
+    void CommandStream::record(CommandType type, uint64_t object, uint64_t value)
+    {
+        assert(type != CommandType::setConstants && "Use recordConstants() to copy the constants.");
+        enforce<InvalidCommandException>(!closed_, "Recorded a command into a closed command list.");
+
+        if (type == CommandType::setPipelineState)
+        {
+            hasPipeline_ = true;
+        }
+        else if (type == CommandType::draw || type == CommandType::drawIndexed)
+        {
+            enforce<InvalidCommandException>(hasPipeline_, "Drew without a pipeline state.");
+        }
+        else if (type == CommandType::transitionBarrior)
+        {
+            const auto before = value >> 32;
+            const auto after = value & 0xffffffff;
+            enforce<InvalidCommandException>(before != after, "Transitioned a resource into the same state.");
+
+            // The first transition of a resource defines the state
+            const auto it = resourceStates_.find(object);
+            if (it != std::cend(resourceStates_))
+            {
+                enforce<InvalidCommandException>(it->second == before, "Transitioned a resource from a wrong state.");
+                it->second = after;
+            }
+            else
+            {
+                resourceStates_.emplace(object, after);
+            }
+        }
+
+        RecordedCommand command;
+        command.type = type;
+        command.object = object;
+        command.value = value;
+        commands_.emplace_back(command);
+    }
+
+    void CommandStream::recordConstants(const void* data, size_t size)
+    {
+        enforce<InvalidCommandException>(!closed_, "Recorded a command into a closed command list.");
+
+        const auto bytes = static_cast<const unsigned char*>(data);
+        RecordedCommand command;
+        command.type = CommandType::setConstants;
+        command.object = constants_.size();
+        command.value = size;
+        constants_.insert(std::cend(constants_), bytes, bytes + size);
+        commands_.emplace_back(command);
+    }
+
+    void CommandStream::setResourceState(uint64_t serial, uint64_t state)
+    {
+        resourceStates_[serial] = state;
+    }
+
+    void CommandStream::eraseResourceState(uint64_t serial)
+    {
+        resourceStates_.erase(serial);
+    }
+
+    void CommandStream::append(const CommandStream& stream)
+    {
+        enforce<InvalidCommandException>(stream.closed_, "Executed a command list that is not closed.");
+
+        // Each command list begins without the pipeline state
+        hasPipeline_ = false;
+        for (const auto& command : stream.commands_)
+        {
+            if (command.type == CommandType::setConstants)
+            {
+                recordConstants(stream.getConstants(command), static_cast<size_t>(command.value));
+            }
+            else
+            {
+                record(command.type, command.object, command.value);
+            }
+        }
+    }
+
+    void CommandStream::close()
+    {
+        enforce<InvalidCommandException>(!closed_, "Closed a command list twice.");
+        closed_ = true;
+    }
+
+    bool CommandStream::isClosed() const
+    {
+        return closed_;
+    }
+
+    void CommandStream::reset()
+    {
+        clearCommands();
+        resourceStates_.clear();
+        hasPipeline_ = false;
+        closed_ = false;
+    }
+
+    void CommandStream::clearCommands()
+    {
+        commands_.clear();
+        constants_.clear();
+    }
+
+    const void* CommandStream::getConstants(const RecordedCommand& command) const
+    {
+        assert(command.type == CommandType::setConstants && "The command has no constants.");
+        return constants_.data() + command.object;
+    }
+
+    size_t CommandStream::getNumCommands() const
+    {
+        return commands_.size();
+    }
+
+    size_t CommandStream::count(CommandType type) const
+    {
+        return static_cast<size_t>(std::count_if(std::cbegin(commands_), std::cend(commands_),
+            [&](const RecordedCommand& c) { return c.type == type; }));
+    }
+}
\ No newline at end of file
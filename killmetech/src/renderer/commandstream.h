@@ -0,0 +1,123 @@
+#ifndef _KILLME_COMMANDSTREAM_H_
+#define _KILLME_COMMANDSTREAM_H_
+
+#include "../core/exception.h"
+#include "../core/utility.h"
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+
+namespace killme
+{
+    /** Exception of invalid commands */
+    class InvalidCommandException : public Exception
+    {
+    public:
+        /** Construct with a message */
+        explicit InvalidCommandException(const std::string& msg);
+    };
+
+    /** Recorded command types */
+    enum class CommandType : uint8_t
+    {
+        setPipelineState,
+        setConstants,
+        draw,
+        drawIndexed,
+        transitionBarrior,
+        clearRenderTarget,
+        clearDepthStencil,
+        updateGpuResource
+    };
+
+    /** Recorded command */
+    /// NOTE: Meanings of the object and the value depend on the type.
+    ///         setPipelineState: the pipeline state and the hash value of its top level
+    ///         setConstants: the offset of the copied constants in the stream and the size in bytes
+    ///         draw, drawIndexed: 0 and count of vertices or indices
+    ///         transitionBarrior: the serial of the resource and the states packed by packResourceStates()
+    ///         clearRenderTarget, clearDepthStencil: the location and 0
+    ///         updateGpuResource: the serial of the resource and 0
+    struct RecordedCommand
+    {
+        CommandType type;
+        uint64_t object;
+        uint64_t value;
+    };
+
+    /** Return the identifier of an object for recorded commands */
+    inline uint64_t toCommandObject(const void* p)
+    {
+        return static_cast<uint64_t>(reinterpret_cast<uintptr_t>(p));
+    }
+
+    /** Pack states of a resource transition */
+    template <class State>
+    uint64_t packResourceStates(State before, State after)
+    {
+        return (static_cast<uint64_t>(before) << 32) | static_cast<uint64_t>(after);
+    }
+
+    /** Compact stream of commands recorded by the null render device */
+    /// NOTE: Commands are validated when recorded. Drawing without a pipeline state, recording into a closed stream
+    ///       and a transition from a state that the resource is not in throw InvalidCommandException.
+    ///       Resources are identified by serials, since addresses are reused after they are destroyed.
+    class CommandStream
+    {
+    private:
+        std::vector<RecordedCommand> commands_;
+        std::vector<unsigned char> constants_;
+        std::unordered_map<uint64_t, uint64_t> resourceStates_;
+        bool hasPipeline_;
+        bool closed_;
+
+    public:
+        /** Construct as an empty stream */
+        CommandStream();
+
+        /** Record a command. Use recordConstants() for CommandType::setConstants. */
+        void record(CommandType type, uint64_t object, uint64_t value);
+
+        /** Record a command of setting constants. The data is copied, so it can be changed after this. */
+        void recordConstants(const void* data, size_t size);
+
+        /** Set the state of a resource, such as the initial state */
+        void setResourceState(uint64_t serial, uint64_t state);
+
+        /** Forget the state of a destroyed resource */
+        void eraseResourceState(uint64_t serial);
+
+        /** Append commands of a closed stream. Commands are validated with states of this stream. */
+        void append(const CommandStream& stream);
+
+        /** End recording */
+        void close();
+
+        /** Whether the stream is closed or not */
+        bool isClosed() const;
+
+        /** Clear commands and states, and begin recording */
+        void reset();
+
+        /** Clear commands, and keep states of resources */
+        void clearCommands();
+
+        /** Return count of commands */
+        size_t getNumCommands() const;
+
+        /** Return count of commands of the type */
+        size_t count(CommandType type) const;
+
+        /** Return the constants copied by a command of CommandType::setConstants */
+        const void* getConstants(const RecordedCommand& command) const;
+
+        /** Return commands */
+        auto getCommands() const
+            -> decltype(constRange(commands_))
+        {
+            return constRange(commands_);
+        }
+    };
+}
+
+#endif
\ No newline at end of file
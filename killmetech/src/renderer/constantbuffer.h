@@ -2,39 +2,32 @@
 #define _KILLME_CONSTANTBUFFER_H_
 
 #include "renderdevice.h"
-#include "../windows/winsupport.h"
-#include <d3d12.h>
+#include <memory>
 
 namespace killme
 {
-    /// TODO: Whether GPU is read only or not
     /** Constant buffer */
+    /// NOTE: The data is kept in the system memory. A command list copies the current data into its upload memory
+    ///       when the buffer is bound, so that draws recorded into the same list can use different constants.
     class ConstantBuffer : public RenderDeviceChild
     {
     private:
-        ComUniquePtr<ID3D12Resource> buffer_;
-        D3D12_RESOURCE_DESC resourceDesc_;
-        char* mappedData_;
+        std::unique_ptr<char[]> data_;
+        size_t size_;
 
     public:
-        /** Resource location */
-        struct Location
-        {
-            D3D12_CPU_DESCRIPTOR_HANDLE ofD3D;
-        };
-
-        /** Destruct */
-        ~ConstantBuffer();
-
         /** Initialize */
         void initialize(size_t size);
 
         /** Update buffer data */
         void update(const void* src, size_t offset, size_t size);
 
-        /** Create the Direct3D view into a desctipror heap */
-        Location locate(ID3D12Device* device, D3D12_CPU_DESCRIPTOR_HANDLE location);
+        /** Return the data */
+        const void* getData() const;
+
+        /** Return the size in bytes */
+        size_t getSize() const;
     };
 }
 
-#endif
+#endif
\ No newline at end of file
@@ -17,7 +17,10 @@ namespace killme
         viewDesc.ViewDimension = D3D12_DSV_DIMENSION_TEXTURE2D;
         viewDesc.Texture2D.MipSlice = 0;
         viewDesc.Flags = D3D12_DSV_FLAG_NONE;
-        device->CreateDepthStencilView(tex_->getD3DResource(), &viewDesc, location);
+        if (device)
+        {
+            device->CreateDepthStencilView(tex_->getD3DResource(), &viewDesc, location);
+        }
         return{ location, desc_.Format };
     }
 
@@ -14,6 +14,12 @@ namespace killme
         desc.Type = D3DMappings::toD3DDescriptorHeapType(type);
         desc.Flags = shaderVisible ? D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE : D3D12_DESCRIPTOR_HEAP_FLAG_NONE;
 
+        if (getOwnerDevice()->isNull())
+        {
+            desc_ = desc;
+            return;
+        }
+
         ID3D12DescriptorHeap* heap;
         enforce<Direct3DException>(
             SUCCEEDED(getD3DOwnerDevice()->CreateDescriptorHeap(&desc, IID_PPV_ARGS(&heap))),
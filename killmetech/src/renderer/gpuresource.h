@@ -43,6 +43,14 @@ namespace killme
         template <class GpuResource>
         typename GpuResource::Location locate(size_t i, const std::shared_ptr<GpuResource>& resource)
         {
+            // The null device creates no views, and locations are only identifiers
+            if (!heap_)
+            {
+                D3D12_CPU_DESCRIPTOR_HANDLE location;
+                location.ptr = reinterpret_cast<SIZE_T>(this) + i;
+                return resource->locate(nullptr, location);
+            }
+
             const auto offset = getD3DOwnerDevice()->GetDescriptorHandleIncrementSize(desc_.Type) * i;
             auto location = heap_->GetCPUDescriptorHandleForHeapStart();
             location.ptr += offset;
@@ -43,6 +43,7 @@ namespace killme
 
     /** Codec functions */
     std::shared_ptr<Image> decodeBmpImage(const std::string& path);
+    std::shared_ptr<Image> decodeBmpImage(const unsigned char* data, size_t size);
 }
 
 #endif
\ No newline at end of file
@@ -1,5 +1,7 @@
 #include "pipelinestate.h"
 #include "vertexdata.h"
+#include "constantbuffer.h"
+#include "commandlist.h"
 #include "d3dsupport.h"
 #include "../core/math/math.h"
 #include "../core/platform.h"
@@ -43,6 +45,7 @@ namespace killme
 
     GpuResourceTable::GpuResourceTable(const detail::BoundShaders& boundShaders)
         : heapTable_()
+        , cbufferTable_()
         , d3dHeapUniqueArray_()
         , d3dHeapTable_()
         , require_()
@@ -50,6 +53,7 @@ namespace killme
         , rootParams_()
         , rootSignature_()
         , hashRootSig_()
+        , isCompute_(false)
     {
         std::vector<std::shared_ptr<BasicShader>> shaderPriority;
         if (boundShaders.vs.bound())
@@ -71,6 +75,7 @@ namespace killme
 
     GpuResourceTable::GpuResourceTable(const Resource<ComputeShader>& cs)
         : heapTable_()
+        , cbufferTable_()
         , d3dHeapUniqueArray_()
         , d3dHeapTable_()
         , require_()
@@ -78,6 +83,7 @@ namespace killme
         , rootParams_()
         , rootSignature_()
         , hashRootSig_()
+        , isCompute_(true)
     {
         assert(cs.bound() && "You need bind compute shader.");
         initialize(std::vector<std::shared_ptr<BasicShader>>{ cs.bound() });
@@ -129,19 +135,59 @@ namespace killme
         }
     }
 
+    void GpuResourceTable::setConstantBuffer(size_t i, const std::shared_ptr<ConstantBuffer>& cbuffer)
+    {
+        assert(i < rootSignature_.NumParameters && "Index out of range");
+        assert(rootParams_[i].ParameterType == D3D12_ROOT_PARAMETER_TYPE_CBV && "Not a constant buffer parameter.");
+        cbufferTable_[i] = cbuffer;
+    }
+
     size_t GpuResourceTable::getRootSignatureHash() const
     {
         return hashRootSig_;
     }
 
-    void GpuResourceTable::applyResourceTable(ID3D12GraphicsCommandList* commands)
+    void GpuResourceTable::applyResourceTable(CommandList& commands)
     {
-        commands->SetDescriptorHeaps(d3dHeapUniqueArray_.size(), d3dHeapUniqueArray_.data());
+        // The list of the null device records constants only
+        const auto list = commands.getD3DCommandList();
+        if (list && !d3dHeapUniqueArray_.empty())
+        {
+            list->SetDescriptorHeaps(d3dHeapUniqueArray_.size(), d3dHeapUniqueArray_.data());
+        }
+
         for (size_t i = 0; i < rootSignature_.NumParameters; ++i)
         {
             if (d3dHeapTable_[i])
             {
-                commands->SetGraphicsRootDescriptorTable(i, d3dHeapTable_[i]->GetGPUDescriptorHandleForHeapStart());
+                const auto table = d3dHeapTable_[i]->GetGPUDescriptorHandleForHeapStart();
+                if (isCompute_)
+                {
+                    list->SetComputeRootDescriptorTable(i, table);
+                }
+                else
+                {
+                    list->SetGraphicsRootDescriptorTable(i, table);
+                }
+            }
+            else if (cbufferTable_[i])
+            {
+                // Bind a snapshot of the current data
+                const auto& cbuffer = cbufferTable_[i];
+                const auto address = commands.uploadConstants(cbuffer->getData(), cbuffer->getSize());
+                if (!list)
+                {
+                    continue;
+                }
+
+                if (isCompute_)
+                {
+                    list->SetComputeRootConstantBufferView(i, address);
+                }
+                else
+                {
+                    list->SetGraphicsRootConstantBufferView(i, address);
+                }
             }
         }
     }
@@ -217,17 +263,18 @@ namespace killme
                     const auto& cbuffers = shader->describeConstnatBuffers();
                     for (const auto& cbuffer : cbuffers)
                     {
+                        // Constant buffers are bound by root descriptors, which can be changed for each draw
+                        D3D12_ROOT_PARAMETER rootParam;
+                        rootParam.ShaderVisibility = D3DMappings::toD3DShaderVisibility(shader->getType());
+                        rootParam.ParameterType = D3D12_ROOT_PARAMETER_TYPE_CBV;
+                        rootParam.Descriptor.ShaderRegister = cbuffer.getRegisterSlot();
+                        rootParam.Descriptor.RegisterSpace = 0;
+                        rootParams_.emplace_back(std::move(rootParam));
+
                         requiredHeap.getResource(resourceIndex).boundShader = shader;
                         requiredHeap.getResource(resourceIndex).type = BoundResourceType::cbuffer;
                         requiredHeap.getResource(resourceIndex).cbuffer = cbuffer;
-
-                        D3D12_DESCRIPTOR_RANGE range;
-                        range.RangeType = D3D12_DESCRIPTOR_RANGE_TYPE_CBV;
-                        range.BaseShaderRegister = cbuffer.getRegisterSlot();
-                        range.NumDescriptors = 1;
-                        range.OffsetInDescriptorsFromTableStart = resourceIndex;
-                        range.RegisterSpace = 0;
-                        descriptorRanges_.emplace_back(std::move(range));
+                        requiredHeap.getResource(resourceIndex).rootIndex = rootParams_.size() - 1;
 
                         ++resourceIndex;
                     }
@@ -351,6 +398,7 @@ namespace killme
         hashRootSig_ = crc32(&rootSignature_, sizeof(rootSignature_));
 
         heapTable_.resize(rootSignature_.NumParameters, nullptr);
+        cbufferTable_.resize(rootSignature_.NumParameters, nullptr);
         d3dHeapUniqueArray_.reserve(require_.size());
         d3dHeapTable_.resize(rootSignature_.NumParameters, nullptr);
     }
@@ -659,9 +707,15 @@ namespace killme
         }
     }
 
-    void PipelineState::applyParameters(ID3D12GraphicsCommandList* commands)
+    void PipelineState::applyParameters(CommandList& list)
     {
-        resourceTable_->applyResourceTable(commands);
+        resourceTable_->applyResourceTable(list);
+
+        const auto commands = list.getD3DCommandList();
+        if (!commands)
+        {
+            return;
+        }
 
         const auto pdsv = isNull(depthStencil_) ? nullptr : &depthStencil_;
         commands->OMSetRenderTargets(topLevelDesc_.NumRenderTargets, renderTargets_.data(), FALSE, pdsv);
@@ -740,7 +794,7 @@ namespace killme
         return resourceTable_->getRootSignatureHash();
     }
 
-    void ComputePipelineState::applyParameters(ID3D12GraphicsCommandList* commands)
+    void ComputePipelineState::applyParameters(CommandList& commands)
     {
         resourceTable_->applyResourceTable(commands);
     }
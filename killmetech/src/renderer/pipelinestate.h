@@ -23,6 +23,7 @@ namespace killme
     class IndexBuffer;
     class CommandList;
     class VertexData;
+    class ConstantBuffer;
     enum class PixelFormat;
     enum class PrimitiveTopology;
     
@@ -35,6 +36,7 @@ namespace killme
         BoundResourceDescription texture; /** If texture type */
         BoundResourceDescription sampler; /** if sampler type */
         BoundResourceDescription bufferRW; /** if RW buffer type */
+        size_t rootIndex; /** If cbuffer type. Constant buffers are bound as root parameters. */
     };
 
     /** GpuResourceHeapRequire */
@@ -88,6 +90,7 @@ namespace killme
     {
     private:
         std::vector<std::shared_ptr<GpuResourceHeap>> heapTable_;
+        std::vector<std::shared_ptr<ConstantBuffer>> cbufferTable_;
         std::vector<ID3D12DescriptorHeap*> d3dHeapUniqueArray_;
         std::vector<ID3D12DescriptorHeap*> d3dHeapTable_;
         std::vector<GpuResourceHeapRequire> require_;
@@ -95,6 +98,7 @@ namespace killme
         std::vector<D3D12_ROOT_PARAMETER> rootParams_;
         D3D12_ROOT_SIGNATURE_DESC rootSignature_;
         size_t hashRootSig_;
+        bool isCompute_;
 
     public:
         /** Construct as the graphics root signature */
@@ -112,11 +116,15 @@ namespace killme
         /** Set GpuResourceHeap */
         void set(size_t i, const std::shared_ptr<GpuResourceHeap>& heap);
 
+        /** Set ConstantBuffer */
+        void setConstantBuffer(size_t i, const std::shared_ptr<ConstantBuffer>& cbuffer);
+
         /** Return the hash value of the root signature */
         size_t getRootSignatureHash() const;
 
         /** Apply resource tables to command list */
-        void applyResourceTable(ID3D12GraphicsCommandList* commands);
+        /// NOTE: The current data of constant buffers are copied into the command list.
+        void applyResourceTable(CommandList& commands);
 
         /** Create Direct3D RootSignature */
         ID3D12RootSignature* createD3DSignature(ID3D12Device* device) const;
@@ -201,7 +209,7 @@ namespace killme
         size_t getRootSignatureHash() const;
 
         /** Apply pipeline parameters to commands */
-        void applyParameters(ID3D12GraphicsCommandList* commands);
+        void applyParameters(CommandList& commands);
 
         /** Create a Direct3D pileline state */
         ID3D12PipelineState* createD3DPipeline(ID3D12Device* device, ID3D12RootSignature* rootSignature) const;
@@ -243,7 +251,7 @@ namespace killme
         size_t getRootSignatureHash() const;
 
         /** Apply pipeline parameters to commands */
-        void applyParameters(ID3D12GraphicsCommandList* commands);
+        void applyParameters(CommandList& commands);
 
         /** Create a Direct3D pileline state */
         ID3D12PipelineState* createD3DPipeline(ID3D12Device* device, ID3D12RootSignature* rootSignature) const;
@@ -17,7 +17,9 @@ namespace killme
         , queuedAllocators_()
         , readyCommands_()
         , queuedCommands_()
+        , reuseMutex_()
         , commandQueue_()
+        , nextResourceSerial_(1)
     {
     }
 
@@ -26,6 +28,11 @@ namespace killme
         commandQueue_ = createRenderDeviceChild<CommandQueue>(shared_from_this());
     }
 
+    bool RenderDevice::isNull() const
+    {
+        return !device_;
+    }
+
     ID3D12Device* RenderDevice::getD3DDevice()
     {
         return device_.get();
@@ -33,26 +40,27 @@ namespace killme
 
     ID3D12PipelineState* RenderDevice::getD3DPipeline(const PipelineState& key)
     {
-        return pipelineCache_->getPipeline(device_.get(), key);
+        return isNull() ? nullptr : pipelineCache_->getPipeline(device_.get(), key);
     }
 
     ID3D12PipelineState* RenderDevice::getD3DPipeline(const ComputePipelineState& key)
     {
-        return pipelineCache_->getComputePipeline(device_.get(), key);
+        return isNull() ? nullptr : pipelineCache_->getComputePipeline(device_.get(), key);
     }
 
     ID3D12RootSignature* RenderDevice::getD3DRootSignature(const PipelineState& key)
     {
-        return pipelineCache_->getSignature(device_.get(), key);
+        return isNull() ? nullptr : pipelineCache_->getSignature(device_.get(), key);
     }
 
     ID3D12RootSignature* RenderDevice::getD3DRootSignature(const ComputePipelineState& key)
     {
-        return pipelineCache_->getComputeSignature(device_.get(), key);
+        return isNull() ? nullptr : pipelineCache_->getComputeSignature(device_.get(), key);
     }
 
     std::shared_ptr<CommandAllocator> RenderDevice::obtainCommandAllocator()
     {
+        std::lock_guard<std::mutex> lock(reuseMutex_);
         commandQueue_->updateExecutionState();
 
         auto it = std::cbegin(queuedAllocators_);
@@ -83,16 +91,19 @@ namespace killme
 
     void RenderDevice::reuseCommandAllocator(const std::shared_ptr<CommandAllocator>& allocator)
     {
+        std::lock_guard<std::mutex> lock(reuseMutex_);
         readyAllocators_.emplace(allocator);
     }
 
     void RenderDevice::reuseCommandAllocatorAfterExecution(const std::shared_ptr<CommandAllocator>& allocator)
     {
+        std::lock_guard<std::mutex> lock(reuseMutex_);
         queuedAllocators_.emplace_back(allocator);
     }
 
     std::shared_ptr<CommandList> RenderDevice::obtainCommandList(const std::shared_ptr<CommandAllocator>& allocator, const std::shared_ptr<PipelineState>& pipeline)
     {
+        std::lock_guard<std::mutex> lock(reuseMutex_);
         commandQueue_->updateExecutionState();
 
         auto it = std::cbegin(queuedCommands_);
@@ -123,11 +134,13 @@ namespace killme
 
     void RenderDevice::reuseCommandList(const std::shared_ptr<CommandList>& commands)
     {
+        std::lock_guard<std::mutex> lock(reuseMutex_);
         readyCommands_.emplace(commands);
     }
 
     void RenderDevice::reuseCommandListAfterExecution(const std::shared_ptr<CommandList>& commands)
     {
+        std::lock_guard<std::mutex> lock(reuseMutex_);
         queuedCommands_.emplace_back(commands);
     }
 
@@ -185,4 +198,22 @@ namespace killme
     {
         return createRenderDeviceChild<PipelineState>(shared_from_this());
     }
+
+    uint64_t RenderDevice::registerGpuResource(GpuResourceState initialState)
+    {
+        const auto serial = nextResourceSerial_++;
+        if (isNull())
+        {
+            commandQueue_->trackResourceState(serial, initialState);
+        }
+        return serial;
+    }
+
+    void RenderDevice::unregisterGpuResource(uint64_t serial)
+    {
+        if (isNull())
+        {
+            commandQueue_->untrackResourceState(serial);
+        }
+    }
 }
\ No newline at end of file
@@ -9,6 +9,9 @@
 #include <vector>
 #include <utility>
 #include <memory>
+#include <mutex>
+#include <atomic>
+#include <cstdint>
 
 namespace killme
 {
@@ -37,15 +40,22 @@ namespace killme
         std::vector<std::shared_ptr<CommandAllocator>> queuedAllocators_;
         std::queue<std::shared_ptr<CommandList>> readyCommands_;
         std::vector<std::shared_ptr<CommandList>> queuedCommands_;
+        std::mutex reuseMutex_; // For resource loading threads
         std::shared_ptr<CommandQueue> commandQueue_;
+        std::atomic<uint64_t> nextResourceSerial_;
 
     public:
         /** Construct */
+        /// NOTE: If the device is nullptr, this is the null device. The null device creates no Direct3D objects,
+        ///       and command lists record validated CommandStreams instead, so that rendering runs without the GPU.
         explicit RenderDevice(ID3D12Device* device);
 
         /** Initialize */
         void initialize();
 
+        /** Whether this is the null device or not */
+        bool isNull() const;
+
         /** Return Direct3D device */
         ID3D12Device* getD3DDevice();
 
@@ -102,6 +112,13 @@ namespace killme
 
         /** Create a pileline state */
         std::shared_ptr<PipelineState> createPipelineState();
+
+        /** Issue the serial of a GPU resource. Serials are not reused, unlike addresses of destroyed resources. */
+        /// NOTE: The null device tracks the state of the resource from the initial state, to validate transitions.
+        uint64_t registerGpuResource(GpuResourceState initialState);
+
+        /** Stop tracking a destroyed GPU resource */
+        void unregisterGpuResource(uint64_t serial);
     };
 
     /** DeviceChild interface provides a method to access to the RenderDevice it was created */
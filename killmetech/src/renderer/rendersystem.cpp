@@ -11,9 +11,12 @@ namespace killme
 {
     RenderSystem::RenderSystem(HWND window)
         : window_(window)
+        , clientWidth_()
+        , clientHeight_()
         , device_()
         , swapChain_()
         , frameIndex_()
+        , frameFenceValues_()
         , backBufferHeap_()
         , backBuffers_()
         , backBufferLocations_()
@@ -42,16 +45,16 @@ namespace killme
         // Create the swap chain
         RECT clientRect;
         GetClientRect(window_, &clientRect);
-        const auto clientWidth = clientRect.right - clientRect.left;
-        const auto clientHeight = clientRect.bottom - clientRect.top;
+        clientWidth_ = clientRect.right - clientRect.left;
+        clientHeight_ = clientRect.bottom - clientRect.top;
 
         const auto RENDER_TARGET_FORMAT = PixelFormat::r8g8b8a8_unorm;
 
         DXGI_SWAP_CHAIN_DESC swapChainDesc;
         ZeroMemory(&swapChainDesc, sizeof(swapChainDesc));
         swapChainDesc.BufferCount = NUM_BACK_BUFFERS;
-        swapChainDesc.BufferDesc.Width = clientWidth;
-        swapChainDesc.BufferDesc.Height = clientHeight;
+        swapChainDesc.BufferDesc.Width = static_cast<UINT>(clientWidth_);
+        swapChainDesc.BufferDesc.Height = static_cast<UINT>(clientHeight_);
         swapChainDesc.BufferDesc.Format = D3DMappings::toD3DDxgiFormat(RENDER_TARGET_FORMAT);
         swapChainDesc.BufferUsage = DXGI_USAGE_RENDER_TARGET_OUTPUT;
         swapChainDesc.SwapEffect = DXGI_SWAP_EFFECT_FLIP_DISCARD;
@@ -93,17 +96,47 @@ namespace killme
             backBufferLocations_[i] = backBufferHeap_->locate(i, backBuffers_[i]);
         }
 
-        // Create the depth stencil
-        depthStencilHeap_ = device_->createGpuResourceHeap(1, GpuResourceHeapType::depthStencil, false);
+        createDepthStencil();
+    }
 
-        TextureDescription dsDesc;
-        dsDesc.width = clientWidth;
-        dsDesc.height = clientHeight;
-        dsDesc.format = PixelFormat::d16_unorm;
-        dsDesc.flags = TextureFlags::allowDepthStencil;
-        const auto depthStencilTexture = device_->createTexture(dsDesc, GpuResourceState::common, 1, 0);
-        depthStencil_ = depthStencilInterface(depthStencilTexture);
-        depthStencilLocation_ = depthStencilHeap_->locate(0, depthStencil_);
+    RenderSystem::RenderSystem(size_t width, size_t height)
+        : window_(nullptr)
+        , clientWidth_(width)
+        , clientHeight_(height)
+        , device_(std::make_shared<RenderDevice>(nullptr))
+        , swapChain_()
+        , frameIndex_()
+        , frameFenceValues_()
+        , backBufferHeap_()
+        , backBuffers_()
+        , backBufferLocations_()
+        , depthStencilHeap_()
+        , depthStencil_()
+        , depthStencilLocation_()
+    {
+        device_->initialize();
+
+        // Create render targets in place of the swap chain
+        TextureDescription bbDesc;
+        bbDesc.width = clientWidth_;
+        bbDesc.height = clientHeight_;
+        bbDesc.format = PixelFormat::r8g8b8a8_unorm;
+        bbDesc.flags = TextureFlags::allowRenderTarget;
+
+        backBufferHeap_ = device_->createGpuResourceHeap(NUM_BACK_BUFFERS, GpuResourceHeapType::renderTarget, false);
+        for (size_t i = 0; i < NUM_BACK_BUFFERS; ++i)
+        {
+            const auto tex = device_->createTexture(bbDesc, GpuResourceState::present);
+            backBuffers_[i] = renderTargetInterface(tex);
+            backBufferLocations_[i] = backBufferHeap_->locate(i, backBuffers_[i]);
+        }
+
+        createDepthStencil();
+    }
+
+    RenderSystem::~RenderSystem()
+    {
+        device_->getCommandQueue()->waitForCommands();
     }
 
     std::shared_ptr<RenderDevice> RenderSystem::getDevice()
@@ -116,6 +149,16 @@ namespace killme
         return window_;
     }
 
+    size_t RenderSystem::getClientWidth() const
+    {
+        return clientWidth_;
+    }
+
+    size_t RenderSystem::getClientHeight() const
+    {
+        return clientHeight_;
+    }
+
     FrameResource RenderSystem::getCurrentFrameResource()
     {
         FrameResource frame;
@@ -129,11 +172,39 @@ namespace killme
     void RenderSystem::presentBackBuffer()
     {
         // Flip screen
-        enforce<Direct3DException>(
-            SUCCEEDED(swapChain_->Present(1, 0)),
-            "Failed to present the back buffer.");
+        if (swapChain_)
+        {
+            enforce<Direct3DException>(
+                SUCCEEDED(swapChain_->Present(1, 0)),
+                "Failed to present the back buffer.");
+        }
 
-        // Update frame index
-        frameIndex_ = swapChain_->GetCurrentBackBufferIndex();
+        // Mark the end of the frame
+        const auto commandQueue = device_->getCommandQueue();
+        frameFenceValues_[frameIndex_] = commandQueue->signal();
+
+        // Update frame index, and wait until the GPU finishes the frame that used the back buffer
+        frameIndex_ = swapChain_ ? swapChain_->GetCurrentBackBufferIndex() : (frameIndex_ + 1) % NUM_BACK_BUFFERS;
+        commandQueue->waitForFence(frameFenceValues_[frameIndex_]);
+
+        // The null device keeps commands of a frame, and states of resources over frames
+        if (device_->isNull())
+        {
+            commandQueue->clearExecutedCommands();
+        }
+    }
+
+    void RenderSystem::createDepthStencil()
+    {
+        depthStencilHeap_ = device_->createGpuResourceHeap(1, GpuResourceHeapType::depthStencil, false);
+
+        TextureDescription dsDesc;
+        dsDesc.width = clientWidth_;
+        dsDesc.height = clientHeight_;
+        dsDesc.format = PixelFormat::d16_unorm;
+        dsDesc.flags = TextureFlags::allowDepthStencil;
+        const auto depthStencilTexture = device_->createTexture(dsDesc, GpuResourceState::common, 1, 0);
+        depthStencil_ = depthStencilInterface(depthStencilTexture);
+        depthStencilLocation_ = depthStencilHeap_->locate(0, depthStencil_);
     }
 }
\ No newline at end of file
@@ -31,10 +31,13 @@ namespace killme
         static constexpr size_t NUM_BACK_BUFFERS = 2;
 
         HWND window_;
+        size_t clientWidth_;
+        size_t clientHeight_;
         std::shared_ptr<RenderDevice> device_;
         ComUniquePtr<IDXGISwapChain3> swapChain_;
 
         size_t frameIndex_;
+        std::array<UINT64, NUM_BACK_BUFFERS> frameFenceValues_; // Signaled when the GPU finishes each frame
         std::shared_ptr<GpuResourceHeap> backBufferHeap_;
         std::array<std::shared_ptr<RenderTarget>, NUM_BACK_BUFFERS> backBuffers_;
         std::array<RenderTarget::Location, NUM_BACK_BUFFERS> backBufferLocations_;
@@ -47,17 +50,34 @@ namespace killme
         /** Initialize */
         explicit RenderSystem(HWND window);
 
+        /** Initialize with the null device for the headless rendering */
+        /// NOTE: Back buffers are textures of the size, and presentation only flips the frame index.
+        RenderSystem(size_t width, size_t height);
+
+        /** Wait for the GPU before resources are released */
+        ~RenderSystem();
+
         /** Return device */
         std::shared_ptr<RenderDevice> getDevice();
 
         /** Return the target window */
+        /// NOTE: The headless rendering returns nullptr.
         HWND getTargetWindow();
 
+        /** Return the size of back buffers */
+        size_t getClientWidth() const;
+        size_t getClientHeight() const;
+
         /** Return the current frame resources */
         FrameResource getCurrentFrameResource();
 
         /** Present the back buffer into the screen */
+        /// NOTE: This waits only for the frame that used the next back buffer,
+        ///       so that the CPU records the next frame while the GPU executes the current frame.
         void presentBackBuffer();
+
+    private:
+        void createDepthStencil();
     };
 }
 
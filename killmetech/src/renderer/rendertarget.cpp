@@ -15,9 +15,17 @@ namespace killme
         return tex_->getD3DResource();
     }
 
+    uint64_t RenderTarget::getSerial() const
+    {
+        return tex_->getSerial();
+    }
+
     RenderTarget::Location RenderTarget::locate(ID3D12Device* device, D3D12_CPU_DESCRIPTOR_HANDLE location)
     {
-        device->CreateRenderTargetView(tex_->getD3DResource(), nullptr, location);
+        if (device)
+        {
+            device->CreateRenderTargetView(tex_->getD3DResource(), nullptr, location);
+        }
         return{ location, desc_.Format };
     }
 
@@ -5,6 +5,7 @@
 #include "../windows/winsupport.h"
 #include <d3d12.h>
 #include <memory>
+#include <cstdint>
 
 namespace killme
 {
@@ -31,6 +32,9 @@ namespace killme
         /** Return the Direct3D render target */
         ID3D12Resource* getD3DResource();
 
+        /** Return the serial of the texture, which shares the state with this */
+        uint64_t getSerial() const;
+
         /** Create the Direct3D view into a desctipror heap */
         Location locate(ID3D12Device* device, D3D12_CPU_DESCRIPTOR_HANDLE location);
     };
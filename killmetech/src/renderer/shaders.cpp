@@ -96,6 +96,11 @@ namespace killme
         return{ byteCode_->GetBufferPointer(), byteCode_->GetBufferSize() };
     }
 
+    size_t BasicShader::getResourceSize() const
+    {
+        return byteCode_->GetBufferSize();
+    }
+
     size_t BasicShader::getNumBoundResources() const
     {
         return desc_.BoundResources;
@@ -114,6 +114,9 @@ namespace killme
         /** Return the count of bound resources */
         size_t getNumBoundResources() const;
 
+        /** Return the memory size */
+        size_t getResourceSize() const;
+
         /** Return the Direct3D input signature */
         auto getD3DInputSignature()
             -> decltype(emplaceRange(std::vector<D3D12_SIGNATURE_PARAMETER_DESC>()))
@@ -286,6 +289,37 @@ namespace killme
 
         return std::make_shared<Shader>(code);
     }
+
+    /** Compile a shader from source on memory. The name is used for error messages and relative includes. */
+    template <class Shader>
+    std::shared_ptr<Shader> compileHlslShader(const std::string& name, const void* source, size_t size)
+    {
+        ID3DBlob* code;
+        ID3DBlob* err = NULL;
+
+#ifdef KILLME_DEBUG
+        const auto flags = D3DCOMPILE_DEBUG | D3DCOMPILE_SKIP_OPTIMIZATION;
+#elif
+        const auto flags = 0u;
+#endif
+
+        const auto hr = D3DCompile(source, size, name.c_str(), nullptr, D3D_COMPILE_STANDARD_FILE_INCLUDE, Shader::ENTRY.c_str(), Shader::MODEL.c_str(), flags, 0, &code, &err);
+        if (FAILED(hr))
+        {
+            if (err)
+            {
+                const std::string msg = static_cast<char*>(err->GetBufferPointer());
+                err->Release();
+                throw Direct3DException(msg);
+            }
+            else
+            {
+                throw Direct3DException("Failed to compile shader (" + name + ").");
+            }
+        }
+
+        return std::make_shared<Shader>(code);
+    }
 }
 
 #endif
\ No newline at end of file
@@ -2,6 +2,7 @@
 #include "rendertarget.h"
 #include "depthstencil.h"
 #include "unorderedbuffer.h"
+#include "gpuresource.h"
 #include "d3dsupport.h"
 #include "../core/math/color.h"
 #include <Windows.h>
@@ -9,10 +10,18 @@
 
 namespace killme
 {
+    Texture::~Texture()
+    {
+        getOwnerDevice()->unregisterGpuResource(serial_);
+    }
+
     void Texture::initialize(ID3D12Resource* tex)
     {
+        // Back buffers of the swap chain are in the present state
+        serial_ = getOwnerDevice()->registerGpuResource(GpuResourceState::present);
         tex_ = makeComUnique(tex);
         desc_ = tex_->GetDesc();
+        allocationSize_ = static_cast<size_t>(getD3DOwnerDevice()->GetResourceAllocationInfo(0, 1, &desc_).SizeInBytes);
     }
 
     void Texture::initialize(const TextureDescription& desc, GpuResourceState initialState, Optional<Color> optimizedClear)
@@ -20,6 +29,15 @@ namespace killme
         const auto d3dFormat = D3DMappings::toD3DDxgiFormat(desc.format);
         const auto defaultHeapProps = getD3DDefaultHeapProps();
         const auto d3dDesc = describeD3DTex2D(desc.width, desc.height, d3dFormat, D3DMappings::toD3DResourceFlags(desc.flags));
+        serial_ = getOwnerDevice()->registerGpuResource(initialState);
+
+        // The null device has no memory
+        if (getOwnerDevice()->isNull())
+        {
+            desc_ = d3dDesc;
+            allocationSize_ = 0;
+            return;
+        }
 
         const D3D12_CLEAR_VALUE* pOptimizedClear = nullptr;
         D3D12_CLEAR_VALUE d3dOptimizedClear;
@@ -41,6 +59,7 @@ namespace killme
             "Failed to create the texture.");
         tex_ = makeComUnique(tex);
         desc_ = tex_->GetDesc();
+        allocationSize_ = static_cast<size_t>(getD3DOwnerDevice()->GetResourceAllocationInfo(0, 1, &desc_).SizeInBytes);
     }
 
     void Texture::initialize(const TextureDescription& desc, GpuResourceState initialState, float optimizedDepth, unsigned optimizedStencil)
@@ -49,6 +68,15 @@ namespace killme
         const auto d3dFormat = D3DMappings::toD3DDxgiFormat(desc.format);
         const auto defaultHeapProps = getD3DDefaultHeapProps();
         const auto d3dDesc = describeD3DTex2D(desc.width, desc.height, d3dFormat, D3DMappings::toD3DResourceFlags(desc.flags));
+        serial_ = getOwnerDevice()->registerGpuResource(initialState);
+
+        // The null device has no memory
+        if (getOwnerDevice()->isNull())
+        {
+            desc_ = d3dDesc;
+            allocationSize_ = 0;
+            return;
+        }
 
         D3D12_CLEAR_VALUE optimizedClear;
         optimizedClear.Format = d3dFormat;
@@ -62,6 +90,7 @@ namespace killme
             "Failed to create the texture.");
         tex_ = makeComUnique(tex);
         desc_ = tex_->GetDesc();
+        allocationSize_ = static_cast<size_t>(getD3DOwnerDevice()->GetResourceAllocationInfo(0, 1, &desc_).SizeInBytes);
     }
 
     ID3D12Resource* Texture::getD3DResource()
@@ -69,11 +98,21 @@ namespace killme
         return tex_.get();
     }
 
+    uint64_t Texture::getSerial() const
+    {
+        return serial_;
+    }
+
     D3D12_RESOURCE_DESC Texture::describeD3D() const
     {
         return desc_;
     }
 
+    size_t Texture::getResourceSize() const
+    {
+        return allocationSize_;
+    }
+
     D3D12_SUBRESOURCE_DATA Texture::getD3DSubresource(const void* data) const
     {
         D3D12_SUBRESOURCE_DATA subresource;
@@ -92,7 +131,10 @@ namespace killme
         desc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
         desc.Texture2D.MipLevels = 1;
         desc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
-        device->CreateShaderResourceView(tex_.get(), &desc, location);
+        if (device)
+        {
+            device->CreateShaderResourceView(tex_.get(), &desc, location);
+        }
         return{ location };
     }
     
@@ -113,7 +155,10 @@ namespace killme
 
     Sampler::Location Sampler::locate(ID3D12Device* device, D3D12_CPU_DESCRIPTOR_HANDLE location)
     {
-        device->CreateSampler(&desc_, location);
+        if (device)
+        {
+            device->CreateSampler(&desc_, location);
+        }
         return{ location };
     }
 }
\ No newline at end of file
@@ -9,6 +9,7 @@
 #include "../core/math/color.h"
 #include <d3d12.h>
 #include <memory>
+#include <cstdint>
 
 namespace killme
 {
@@ -43,6 +44,8 @@ namespace killme
     private:
         ComUniquePtr<ID3D12Resource> tex_;
         D3D12_RESOURCE_DESC desc_;
+        size_t allocationSize_;
+        uint64_t serial_;
 
     public:
         /** Resource location */
@@ -51,6 +54,9 @@ namespace killme
             D3D12_CPU_DESCRIPTOR_HANDLE ofD3D;
         };
 
+        /** Unregister from the owner device */
+        ~Texture();
+
         /** Initialize */
         void initialize(ID3D12Resource* tex);
         void initialize(const TextureDescription& desc, GpuResourceState initialState, Optional<Color> optimizedClear);
@@ -59,9 +65,15 @@ namespace killme
         /** Return the Direct3D resource */
         ID3D12Resource* getD3DResource();
 
+        /** Return the serial identifying this resource in recorded commands */
+        uint64_t getSerial() const;
+
         /** Describe Direct3D texture */
         D3D12_RESOURCE_DESC describeD3D() const;
 
+        /** Return the memory size */
+        size_t getResourceSize() const;
+
         /** Return the Direct3D subresource informations */
         D3D12_SUBRESOURCE_DATA getD3DSubresource(const void* data) const;
 
@@ -17,7 +17,10 @@ namespace killme
         viewDesc.ViewDimension = D3D12_UAV_DIMENSION_TEXTURE2D;
         viewDesc.Texture2D.MipSlice = 0;
         viewDesc.Texture2D.PlaneSlice = 0;
-        device->CreateUnorderedAccessView(tex_->getD3DResource(), nullptr, &viewDesc, location);
+        if (device)
+        {
+            device->CreateUnorderedAccessView(tex_->getD3DResource(), nullptr, &viewDesc, location);
+        }
         return{ location, desc_.Format };
     }
 
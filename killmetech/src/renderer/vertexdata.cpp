@@ -3,22 +3,37 @@
 
 namespace killme
 {
+    VertexBuffer::~VertexBuffer()
+    {
+        getOwnerDevice()->unregisterGpuResource(serial_);
+    }
+
     void VertexBuffer::initialize(size_t size, size_t stride, GpuResourceState initialState)
     {
         assert(stride <= size && "You need satisfy stride <= size.");
+        serial_ = getOwnerDevice()->registerGpuResource(initialState);
 
-        const auto defaultHeapProps = getD3DDefaultHeapProps();
         const auto desc = describeD3DBuffer(size);
+        if (getOwnerDevice()->isNull())
+        {
+            desc_ = desc;
+            view_.BufferLocation = 0;
+        }
+        else
+        {
+            const auto defaultHeapProps = getD3DDefaultHeapProps();
+
+            ID3D12Resource* buffer;
+            enforce<Direct3DException>(
+                SUCCEEDED(getD3DOwnerDevice()->CreateCommittedResource(&defaultHeapProps, D3D12_HEAP_FLAG_NONE, &desc,
+                    D3DMappings::toD3DResourceState(initialState), nullptr, IID_PPV_ARGS(&buffer))),
+                "Failed to create the vertex buffer.");
+            buffer_ = makeComUnique(buffer);
+
+            desc_ = buffer_->GetDesc();
+            view_.BufferLocation = buffer_->GetGPUVirtualAddress();
+        }
 
-        ID3D12Resource* buffer;
-        enforce<Direct3DException>(
-            SUCCEEDED(getD3DOwnerDevice()->CreateCommittedResource(&defaultHeapProps, D3D12_HEAP_FLAG_NONE, &desc,
-                D3DMappings::toD3DResourceState(initialState), nullptr, IID_PPV_ARGS(&buffer))),
-            "Failed to create the vertex buffer.");
-        buffer_ = makeComUnique(buffer);
-
-        desc_ = buffer_->GetDesc();
-        view_.BufferLocation = buffer_->GetGPUVirtualAddress();
         view_.SizeInBytes = static_cast<UINT>(desc_.Width);
         view_.StrideInBytes = static_cast<UINT>(stride);
     }
@@ -28,6 +43,11 @@ namespace killme
         return buffer_.get();
     }
 
+    uint64_t VertexBuffer::getSerial() const
+    {
+        return serial_;
+    }
+
     D3D12_SUBRESOURCE_DATA VertexBuffer::getD3DSubresource(const void* data) const
     {
         D3D12_SUBRESOURCE_DATA subresource;
@@ -42,21 +62,41 @@ namespace killme
         return view_;
     }
 
+    size_t VertexBuffer::getSize() const
+    {
+        return static_cast<size_t>(desc_.Width);
+    }
+
+    IndexBuffer::~IndexBuffer()
+    {
+        getOwnerDevice()->unregisterGpuResource(serial_);
+    }
+
     void IndexBuffer::initialize(size_t size, GpuResourceState initialState)
     {
-        const auto defaultHeapProps = getD3DDefaultHeapProps();
+        serial_ = getOwnerDevice()->registerGpuResource(initialState);
         const auto desc = describeD3DBuffer(size);
+        if (getOwnerDevice()->isNull())
+        {
+            desc_ = desc;
+            view_.BufferLocation = 0;
+        }
+        else
+        {
+            const auto defaultHeapProps = getD3DDefaultHeapProps();
+
+            ID3D12Resource* buffer;
+            enforce<Direct3DException>(
+                SUCCEEDED(getD3DOwnerDevice()->CreateCommittedResource(&defaultHeapProps, D3D12_HEAP_FLAG_NONE, &desc,
+                    D3DMappings::toD3DResourceState(initialState), nullptr, IID_PPV_ARGS(&buffer))),
+                "Failed to create the index buffer.");
+            buffer_ = makeComUnique(buffer);
+
+            desc_ = buffer_->GetDesc();
+            view_.BufferLocation = buffer_->GetGPUVirtualAddress();
+        }
 
-        ID3D12Resource* buffer;
-        enforce<Direct3DException>(
-            SUCCEEDED(getD3DOwnerDevice()->CreateCommittedResource(&defaultHeapProps, D3D12_HEAP_FLAG_NONE, &desc,
-                D3DMappings::toD3DResourceState(initialState), nullptr, IID_PPV_ARGS(&buffer))),
-            "Failed to create the index buffer.");
-        buffer_ = makeComUnique(buffer);
-
-        desc_ = buffer_->GetDesc();
-        view_.BufferLocation = buffer_->GetGPUVirtualAddress();
-        view_.SizeInBytes = static_cast<UINT>(buffer->GetDesc().Width);
+        view_.SizeInBytes = static_cast<UINT>(desc_.Width);
         view_.Format = DXGI_FORMAT_R16_UINT;
     }
 
@@ -65,6 +105,11 @@ namespace killme
         return buffer_.get();
     }
 
+    uint64_t IndexBuffer::getSerial() const
+    {
+        return serial_;
+    }
+
     D3D12_SUBRESOURCE_DATA IndexBuffer::getD3DSubresource(const void* data) const
     {
         D3D12_SUBRESOURCE_DATA subresource;
@@ -84,6 +129,11 @@ namespace killme
         return view_.SizeInBytes / sizeof(unsigned short);
     }
 
+    size_t IndexBuffer::getSize() const
+    {
+        return static_cast<size_t>(desc_.Width);
+    }
+
     const std::string SemanticNames::position   = "POSITION";
     const std::string SemanticNames::color      = "COLOR";
     const std::string SemanticNames::normal     = "NORMAL";
@@ -103,4 +153,14 @@ namespace killme
     {
         return indexBuffer_;
     }
+
+    size_t VertexData::getSize() const
+    {
+        size_t size = indexBuffer_ ? indexBuffer_->getSize() : 0;
+        for (const auto& vertices : vertexBuffers_)
+        {
+            size += vertices.buffer->getSize();
+        }
+        return size;
+    }
 }
\ No newline at end of file
@@ -12,6 +12,7 @@
 #include <memory>
 #include <string>
 #include <utility>
+#include <cstdint>
 
 namespace killme
 {
@@ -22,11 +23,18 @@ namespace killme
         ComUniquePtr<ID3D12Resource> buffer_;
         D3D12_RESOURCE_DESC desc_;
         D3D12_VERTEX_BUFFER_VIEW view_;
+        uint64_t serial_;
 
     public:
+        /** Unregister from the owner device */
+        ~VertexBuffer();
+
         /** Initialize */
         void initialize(size_t size, size_t stride, GpuResourceState initialState);
 
+        /** Return the serial identifying this resource in recorded commands */
+        uint64_t getSerial() const;
+
         /** Return the Direct3D resource */
         ID3D12Resource* getD3DResource();
 
@@ -35,6 +43,9 @@ namespace killme
 
         /** Return the Direct3D view */
         D3D12_VERTEX_BUFFER_VIEW getD3DView();
+
+        /** Return the size[byte] */
+        size_t getSize() const;
     };
 
     /** Index buffer */
@@ -44,11 +55,18 @@ namespace killme
         ComUniquePtr<ID3D12Resource> buffer_;
         D3D12_RESOURCE_DESC desc_;
         D3D12_INDEX_BUFFER_VIEW view_;
+        uint64_t serial_;
 
     public:
+        /** Unregister from the owner device */
+        ~IndexBuffer();
+
         /** Initialize */
         void initialize(size_t size, GpuResourceState initialState);
 
+        /** Return the serial identifying this resource in recorded commands */
+        uint64_t getSerial() const;
+
         /** Return the Direct3D resource */
         ID3D12Resource* getD3DResource();
 
@@ -60,6 +78,9 @@ namespace killme
 
         /** Return the count of index */
         size_t getNumIndices() const;
+
+        /** Return the size[byte] */
+        size_t getSize() const;
     };
 
     /** Primitive topology definitions */
@@ -132,6 +153,9 @@ namespace killme
 
         /** Return the index buffer */
         std::shared_ptr<IndexBuffer> getIndexBuffer();
+
+        /** Return the total size[byte] of buffers */
+        size_t getSize() const;
     };
 }
 
@@ -5,6 +5,8 @@
 #include <memory>
 #include <string>
 #include <functional>
+#include <future>
+#include <chrono>
 #include <cassert>
 
 namespace killme
@@ -15,183 +17,219 @@ namespace killme
     public:
         virtual ~IsResource() = default;
 
+        /** Return the memory size[byte] of this resource, for the memory budget of the ResourceStore */
+        /// NOTE: Resources referred by this resource through Resource<T> are not included.
+        virtual size_t getResourceSize() const { return 0; }
+
     protected:
         IsResource() = default;
     };
 
     /** Resource accessor */
-    /// NOTE: Not support const resources
+    /// NOTE: Not support const resources. Copies do not allocate.
     template <class T>
     class Resource
     {
+    public:
+        using Loader = std::function<std::shared_ptr<T>()>;
+
     private:
-        struct Holder
+        // For media resources
+        std::weak_ptr<ResourceStore> store_;
+        ResourceId id_;
+        std::shared_ptr<T> placeholder_;
+        mutable std::weak_ptr<T> resource_;
+        mutable std::shared_ptr<const ResourceGeneration> generation_;
+        mutable uint64_t cachedGeneration_;
+        mutable ResourceFuture loading_;
+
+        // For application resources
+        std::shared_ptr<const Loader> loader_;
+        mutable std::shared_ptr<T> appResource_;
+
+    public:
+        /** Construct */
+        Resource() = default;
+
+        /** Construct as the media resource */
+        Resource(ResourceManager& mng, const std::string& path)
+            : Resource(mng, ResourceId(path), nullptr)
         {
-            virtual ~Holder() = default;
-            virtual std::unique_ptr<Holder> copy() const = 0;
-            virtual std::shared_ptr<T> access() const = 0;
-            virtual void load() const = 0;
-            virtual void unload() const = 0;
-        };
+        }
 
-        // For media resources
-        struct MediaHolder : Holder
+        /** Construct as the media resource loaded asynchronously. access() returns the placeholder until loaded. */
+        Resource(ResourceManager& mng, const std::string& path, const std::shared_ptr<T>& placeholder)
+            : Resource(mng, ResourceId(path), placeholder)
         {
-            std::weak_ptr<ResourceStore> store_;
-            std::string path_;
-            mutable std::weak_ptr<T> resource_;
-
-            MediaHolder(const std::weak_ptr<ResourceStore>& store, const std::string& path)
-                : store_(store)
-                , path_(path)
-                , resource_()
-            {
-            }
+        }
 
-            std::unique_ptr<Holder> copy() const
-            {
-                return std::make_unique<MediaHolder>(store_, path_);
-            }
+        /** Construct as the media resource with an interned path */
+        Resource(ResourceManager& mng, const ResourceId& id, const std::shared_ptr<T>& placeholder = nullptr)
+            : store_(mng.getStore())
+            , id_(id)
+            , placeholder_(placeholder)
+            , resource_()
+            , generation_()
+            , cachedGeneration_(0)
+            , loading_()
+            , loader_()
+            , appResource_()
+        {
+        }
+
+        /** Construct as the application resource */
+        explicit Resource(Loader loader)
+            : store_()
+            , id_()
+            , placeholder_()
+            , resource_()
+            , generation_()
+            , cachedGeneration_(0)
+            , loading_()
+            , loader_(std::make_shared<const Loader>(std::move(loader)))
+            , appResource_((*loader_)())
+        {
+        }
 
-            std::shared_ptr<T> access() const
+        /** Accesse resource. If resource is not loaded, load resource immediately, or return the placeholder. */
+        std::shared_ptr<T> access() const
+        {
+            assert(bound() && "The resource is not bound.");
+            if (loader_)
             {
-                if (resource_.expired())
+                if (!appResource_)
                 {
-                    if (const auto r = store_.lock()->getLoadedResource(path_))
-                    {
-                        resource_ = std::dynamic_pointer_cast<T>(r);
-                        assert(resource_.lock() && "Mismatch resource type.");
-                    }
-                    else
-                    {
-                        load();
-                    }
+                    appResource_ = (*loader_)();
                 }
-                return resource_.lock();
+                return appResource_;
             }
 
-            void load() const
+            // Lock once, because the store may drop the resource at any time on other threads.
+            // The old instance may be alive after a reload, so the generation is checked too.
+            auto resource = resource_.lock();
+            if (!resource || *generation_ != cachedGeneration_)
             {
-                if (const auto s = store_.lock())
+                const auto s = store_.lock();
+                if (s)
                 {
-                    resource_ = std::dynamic_pointer_cast<T>(s->load(path_));
-                    assert(resource_.lock() && "Mismatch resource type.");
+                    updateGeneration(*s);
                 }
-            }
-
-            void unload() const
-            {
-                if (const auto s = store_.lock())
+                if (const auto r = s ? s->getLoadedResource(id_) : nullptr)
                 {
-                    s->unload(path_);
+                    resource = std::dynamic_pointer_cast<T>(r);
+                    assert(resource && "Mismatch resource type.");
+                    resource_ = resource;
+                }
+                else if (placeholder_)
+                {
+                    return accessAsync();
+                }
+                else
+                {
+                    return loadMedia();
                 }
             }
-        };
+            return resource;
+        }
 
-        // For application resources
-        struct AppHolder : Holder
+        /** Return the resource if it is loaded, otherwise null. This does not load nor touch the resource. */
+        std::shared_ptr<T> getLoaded() const
         {
-            using Loader = std::function<std::shared_ptr<T>()>;
-
-            mutable Loader loader_;
-            mutable std::shared_ptr<T> resource_;
-
-            AppHolder(Loader loader, const std::shared_ptr<T>& resource)
-                : loader_(loader)
-                , resource_(resource)
+            assert(bound() && "The resource is not bound.");
+            if (loader_)
             {
+                return appResource_;
             }
 
-            std::unique_ptr<Holder> copy() const
-            {
-                return std::make_unique<AppHolder>(loader_, resource_);
-            }
+            const auto s = store_.lock();
+            const auto r = s ? s->peekLoadedResource(id_) : nullptr;
+            return std::dynamic_pointer_cast<T>(r);
+        }
 
-            std::shared_ptr<T> access() const
+        /** Load resource */
+        std::shared_ptr<T> load() const
+        {
+            assert(bound() && "The resource is not bound.");
+            if (loader_)
             {
-                if (!resource_)
-                {
-                    load();
-                }
-                return resource_;
+                appResource_ = (*loader_)();
+                return appResource_;
             }
+            return loadMedia();
+        }
 
-            void load() const
+        /** Unload resource */
+        void unload() const
+        {
+            assert(bound() && "The resource is not bound.");
+            if (loader_)
             {
-                resource_ = loader_();
+                appResource_.reset();
             }
-
-            void unload() const
+            else if (const auto s = store_.lock())
             {
-                resource_.reset();
+                s->unload(id_);
             }
-        };
-
-        std::unique_ptr<Holder> holder_;
-
-    public:
-        /** Construct */
-        Resource() = default;
-
-        /** Construct as the media resource */
-        Resource(ResourceManager& mng, const std::string& path)
-            : holder_(std::make_unique<MediaHolder>(mng.getStore(), path))
-        {
         }
 
-        /** Construct as the application resource */
-        explicit Resource(typename AppHolder::Loader loader)
-            : holder_(std::make_unique<AppHolder>(loader, loader()))
+        /** Return whether bound a resource or not */
+        bool bound() const
         {
+            return id_.valid() || !!loader_;
         }
 
-        /** Copy constructor */
-        Resource(const Resource& lhs)
-            : holder_()
+        /** Return the interned path. Application resources return the invalid id. */
+        ResourceId getId() const
         {
-            *this = lhs;
+            return id_;
         }
 
-        /** Move constructor */
-        Resource(Resource&& rhs) = default;
-
-        /** Copy assignment operator */
-        Resource& operator=(const Resource& lhs)
+    private:
+        // Start loading and return the placeholder until the resource is ready
+        std::shared_ptr<T> accessAsync() const
         {
-            holder_.reset();
-            if (lhs.holder_)
+            if (!loading_.valid())
             {
-                holder_ = lhs.holder_->copy();
+                const auto s = store_.lock();
+                updateGeneration(*s);
+                loading_ = s->loadAsync(id_);
+            }
+            if (loading_.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+            {
+                return placeholder_;
             }
-            return *this;
-        }
-
-        /** Move assignment operator */
-        Resource& operator=(Resource&& rhs) = default;
 
-        /** Accesse resource. If resource is not loaded, load resource immediately. */
-        std::shared_ptr<T> access() const
-        {
-            return holder_->access();
+            const auto loading = std::move(loading_);
+            const auto r = std::dynamic_pointer_cast<T>(loading.get());
+            assert(r && "Mismatch resource type.");
+            resource_ = r;
+            return r;
         }
 
-        /** Load resource */
-        std::shared_ptr<T> load() const
+        // Return the loaded resource, because the store may drop it before the caller refers it
+        std::shared_ptr<T> loadMedia() const
         {
-            holder_->load();
-            return holder_->access();
-        }
+            const auto s = store_.lock();
+            if (!s)
+            {
+                return nullptr;
+            }
 
-        /** Unload resource */
-        void unload() const
-        {
-            return holder_->unload();
+            updateGeneration(*s);
+            const auto r = std::dynamic_pointer_cast<T>(s->load(id_));
+            assert(r && "Mismatch resource type.");
+            resource_ = r;
+            return r;
         }
 
-        /** Return whether bound a resource or not */
-        bool bound() const
+        // Call before getting the resource from the store
+        void updateGeneration(ResourceStore& store) const
         {
-            return !!holder_;
+            if (!generation_)
+            {
+                generation_ = store.getGeneration(id_);
+            }
+            cachedGeneration_ = *generation_;
         }
     };
 }
@@ -0,0 +1,80 @@
+#include "resourceid.h"
+#include "../core/exception.h"
+#include <unordered_map>
+#include <algorithm>
+#include <mutex>
+#include <cctype>
+
+namespace killme
+{
+    namespace
+    {
+        uint64_t hashNormalizedPath(const std::string& normalized)
+        {
+            // 64 bit FNV-1a
+            uint64_t hash = 14695981039346656037ull;
+            for (const auto c : normalized)
+            {
+                hash ^= static_cast<unsigned char>(c);
+                hash *= 1099511628211ull;
+            }
+
+            // 0 is reserved for the invalid id
+            return hash != 0 ? hash : 1;
+        }
+
+        struct ResourceIdRegistry
+        {
+            std::mutex mutex;
+            std::unordered_map<uint64_t, std::string> paths; // References to the values are stable
+        };
+
+        // Ids may be constructed in static initialization, so the registry is a function local static
+        ResourceIdRegistry& getRegistry()
+        {
+            static ResourceIdRegistry registry;
+            return registry;
+        }
+    }
+
+    std::string normalizeResourcePath(const std::string& path)
+    {
+        std::string normalized(path.size(), '\0');
+        std::transform(std::cbegin(path), std::cend(path), std::begin(normalized), [](char c)
+        {
+            return c == '\\' ? '/' : static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        });
+        return normalized;
+    }
+
+    uint64_t hashResourcePath(const std::string& path)
+    {
+        return hashNormalizedPath(normalizeResourcePath(path));
+    }
+
+    ResourceId::ResourceId(const std::string& path)
+        : hash_()
+    {
+        auto normalized = normalizeResourcePath(path);
+        hash_ = hashNormalizedPath(normalized);
+
+        auto& registry = getRegistry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        const auto it = registry.paths.emplace(hash_, normalized).first;
+        enforce<InvalidArgmentException>(it->second == normalized,
+            "Collision of the resource path hash between \'" + it->second + "\' and \'" + normalized + "\'.");
+    }
+
+    const std::string& ResourceId::getPath() const
+    {
+        static const std::string invalid;
+        if (!valid())
+        {
+            return invalid;
+        }
+
+        auto& registry = getRegistry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        return registry.paths.find(hash_)->second;
+    }
+}
\ No newline at end of file
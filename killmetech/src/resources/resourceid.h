@@ -0,0 +1,65 @@
+#ifndef _KILLME_RESOURCEID_H_
+#define _KILLME_RESOURCEID_H_
+
+#include <string>
+#include <functional>
+#include <cstdint>
+
+namespace killme
+{
+    /** Normalize a resource path. Paths are case insensitive, and '\\' is same as '/'. */
+    std::string normalizeResourcePath(const std::string& path);
+
+    /** Hash of a resource path */
+    uint64_t hashResourcePath(const std::string& path);
+
+    /** Interned resource path */
+    /// NOTE: The path is normalized and hashed once, when the id is constructed.
+    ///       Copies and comparisons are integer operations.
+    class ResourceId
+    {
+    private:
+        uint64_t hash_;
+
+    public:
+        /** Construct an invalid id */
+        ResourceId() noexcept : hash_(0) {}
+
+        /** Construct with a path. Throws InvalidArgmentException if the hash collides with an other path. */
+        explicit ResourceId(const std::string& path);
+
+        /** Return the hash of the normalized path */
+        uint64_t getHash() const noexcept { return hash_; }
+
+        /** Return the normalized path. The reference is valid while the program runs. */
+        const std::string& getPath() const;
+
+        /** Return whether the id is valid or not */
+        bool valid() const noexcept { return hash_ != 0; }
+    };
+
+    /** Equivalent tests */
+    inline bool operator ==(const ResourceId& a, const ResourceId& b) noexcept
+    {
+        return a.getHash() == b.getHash();
+    }
+
+    inline bool operator !=(const ResourceId& a, const ResourceId& b) noexcept
+    {
+        return !(a == b);
+    }
+}
+
+namespace std
+{
+    template <>
+    struct hash<killme::ResourceId>
+    {
+        size_t operator ()(const killme::ResourceId& id) const noexcept
+        {
+            return static_cast<size_t>(id.getHash());
+        }
+    };
+}
+
+#endif
\ No newline at end of file
@@ -1,28 +1,102 @@
 #include "resourcemanager.h"
+#include "resource.h"
+#include "resourcepack.h"
+#include "../windows/mappedfile.h"
+#include "../windows/filewatcher.h"
+#include "../processes/taskgraph.h"
+#include "../core/threadpool.h"
 #include "../core/string.h"
+#include "../core/exception.h"
+#include <unordered_set>
+#include <algorithm>
+#include <limits>
+#include <utility>
+#include <exception>
 #include <cassert>
 
 namespace killme
 {
+    ResourceStore::ResourceStore()
+        : loaderMap_()
+        , packs_()
+        , dependencyMap_()
+        , watcher_()
+        , reloadListener_()
+        , mutex_()
+        , shards_()
+        , accessClock_(0)
+        , memoryBudget_(std::numeric_limits<size_t>::max())
+        , numHits_(0)
+        , numMisses_(0)
+        , numEvictions_(0)
+        , usedMemory_(0)
+        , evictMutex_()
+        , loadThreads_()
+    {
+        // Loading threads are needed even on a single core machine, because they wait for I/O
+        loadThreads_ = std::make_unique<ThreadPool>(std::max<size_t>(getDefaultNumWorkerThreads(), 1));
+    }
+
+    ResourceStore::~ResourceStore()
+    {
+        // The watcher thread reloads on the loading threads
+        watcher_.reset();
+        loadThreads_.reset();
+    }
+
     void ResourceStore::registerLoader(const std::string& ext, ResourceLoader loader)
     {
-        const auto check = loaderMap_.emplace(ext, loader);
+        std::lock_guard<std::mutex> lock(mutex_);
+        const auto check = loaderMap_.emplace(ext, Loader{ loader, nullptr });
+        assert(check.second && ("Conflict the resource loader \'" + ext + "\'.").c_str());
+    }
+
+    void ResourceStore::registerDataLoader(const std::string& ext, ResourceDataLoader loader)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        const auto check = loaderMap_.emplace(ext, Loader{ nullptr, loader });
         assert(check.second && ("Conflict the resource loader \'" + ext + "\'.").c_str());
     }
 
     void ResourceStore::unregisterLoader(const std::string& ext)
     {
+        std::lock_guard<std::mutex> lock(mutex_);
         loaderMap_.erase(ext);
     }
 
-    std::shared_ptr<IsResource> ResourceStore::getLoadedResource(const std::string& path)
+    std::shared_ptr<IsResource> ResourceStore::getLoadedResource(const ResourceId& id)
     {
-        const auto it = resourceMap_.find(toLowers(path));
-        if (it == std::cend(resourceMap_))
+        auto& shard = getShard(id);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        const auto it = shard.resourceMap.find(id);
+        if (it == std::cend(shard.resourceMap))
         {
             return nullptr;
         }
-        return it->second;
+
+        ++numHits_;
+        it->second.lastAccess = ++accessClock_;
+        return it->second.resource;
+    }
+
+    std::shared_ptr<IsResource> ResourceStore::peekLoadedResource(const ResourceId& id)
+    {
+        auto& shard = getShard(id);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        const auto it = shard.resourceMap.find(id);
+        return it != std::cend(shard.resourceMap) ? it->second.resource : nullptr;
+    }
+
+    std::shared_ptr<const ResourceGeneration> ResourceStore::getGeneration(const ResourceId& id)
+    {
+        auto& shard = getShard(id);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto& generation = shard.generationMap[id];
+        if (!generation)
+        {
+            generation = std::make_shared<ResourceGeneration>(0);
+        }
+        return generation;
     }
 
     namespace detail
@@ -33,24 +107,521 @@ namespace killme
             assert(found != std::string::npos && "File extension not exists.");
             return path.substr(found + 1);
         }
+
+        // Call a data loader with bytes in the packs or a loose file
+        std::shared_ptr<IsResource> loadFromData(const ResourceId& id, const ResourceDataLoader& loader,
+            const std::vector<std::shared_ptr<ResourcePack>>& packs, bool& packed)
+        {
+            const auto& path = id.getPath();
+            for (auto it = std::crbegin(packs); it != std::crend(packs); ++it)
+            {
+                if (const auto data = (*it)->find(id))
+                {
+                    packed = true;
+                    return loader(path, *data);
+                }
+            }
+
+            // Not packed
+            packed = false;
+            const MappedFile file(path);
+            return loader(path, ResourceData{ file.getData(), file.getSize(), file.getLastWriteTime() });
+        }
+    }
+
+    std::shared_ptr<IsResource> ResourceStore::load(const ResourceId& id)
+    {
+        std::shared_ptr<std::promise<std::shared_ptr<IsResource>>> started;
+        const auto future = findOrStartLoading(id, false, started);
+        if (started)
+        {
+            runLoader(id, *started);
+        }
+        return wait(future);
+    }
+
+    ResourceFuture ResourceStore::loadAsync(const ResourceId& id)
+    {
+        std::shared_ptr<std::promise<std::shared_ptr<IsResource>>> started;
+        const auto future = findOrStartLoading(id, true, started);
+        if (started)
+        {
+            loadThreads_->post([=] { runLoader(id, *started); });
+        }
+        return future;
+    }
+
+    std::vector<ResourceFuture> ResourceStore::prefetch(const std::vector<std::string>& paths)
+    {
+        std::vector<ResourceFuture> futures;
+        futures.reserve(paths.size());
+        for (const auto& path : paths)
+        {
+            futures.emplace_back(loadAsync(ResourceId(path)));
+        }
+        return futures;
+    }
+
+    std::shared_ptr<IsResource> ResourceStore::wait(const ResourceFuture& future)
+    {
+        loadThreads_->wait(future);
+        return future.get();
+    }
+
+    void ResourceStore::waitForLoading()
+    {
+        while (true)
+        {
+            ResourceFuture future;
+            for (auto& shard : shards_)
+            {
+                std::lock_guard<std::mutex> lock(shard.mutex);
+                if (!shard.loadingMap.empty())
+                {
+                    future = std::cbegin(shard.loadingMap)->second;
+                    break;
+                }
+            }
+
+            if (!future.valid())
+            {
+                return;
+            }
+            loadThreads_->wait(future);
+        }
+    }
+
+    std::vector<std::shared_ptr<IsResource>> ResourceStore::loadDependencies(const ResourceId& dependent, const std::vector<ResourceId>& dependencies)
+    {
+        // Check and add the edges at once, so that concurrent loaders can not make a cycle
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (const auto& dependency : dependencies)
+            {
+                enforce<FileException>(!dependsOn(dependency, dependent),
+                    "Cyclic resource dependency (" + dependent.getPath() + " -> " + dependency.getPath() + ").");
+            }
+
+            auto& edges = dependencyMap_[dependent];
+            for (const auto& dependency : dependencies)
+            {
+                if (std::find(std::cbegin(edges), std::cend(edges), dependency) == std::cend(edges))
+                {
+                    edges.emplace_back(dependency);
+                }
+            }
+        }
+
+        // Start all loads before waiting, so that independent dependencies are loaded in parallel
+        std::vector<ResourceFuture> futures;
+        futures.reserve(dependencies.size());
+        for (const auto& dependency : dependencies)
+        {
+            futures.emplace_back(loadAsync(dependency));
+        }
+
+        std::vector<std::shared_ptr<IsResource>> resources;
+        resources.reserve(futures.size());
+        for (const auto& future : futures)
+        {
+            resources.emplace_back(wait(future));
+        }
+        return resources;
+    }
+
+    std::vector<ResourceId> ResourceStore::getDependencies(const ResourceId& id)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        const auto it = dependencyMap_.find(id);
+        if (it == std::cend(dependencyMap_))
+        {
+            return {};
+        }
+        return it->second;
+    }
+
+    void ResourceStore::unload(const ResourceId& id)
+    {
+        auto& shard = getShard(id);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        const auto it = shard.resourceMap.find(id);
+        if (it != std::end(shard.resourceMap))
+        {
+            removeResource(shard, it);
+        }
+    }
+
+    void ResourceStore::mountPack(const std::string& path)
+    {
+        const auto pack = std::make_shared<ResourcePack>(path);
+        std::lock_guard<std::mutex> lock(mutex_);
+        packs_.emplace_back(pack);
+    }
+
+    void ResourceStore::unmountPack(const std::string& path)
+    {
+        // Running loads keep the pack mapped
+        std::lock_guard<std::mutex> lock(mutex_);
+        packs_.erase(std::remove_if(std::begin(packs_), std::end(packs_),
+            [&](const std::shared_ptr<ResourcePack>& pack) { return pack->getPath() == path; }), std::end(packs_));
+    }
+
+    void ResourceStore::setMemoryBudget(size_t budget)
+    {
+        memoryBudget_ = budget;
+        evict();
+    }
+
+    size_t ResourceStore::getMemoryBudget()
+    {
+        return memoryBudget_;
+    }
+
+    ResourceStoreStatistics ResourceStore::getStatistics()
+    {
+        ResourceStoreStatistics statistics;
+        statistics.numHits = numHits_;
+        statistics.numMisses = numMisses_;
+        statistics.numEvictions = numEvictions_;
+        statistics.usedMemory = usedMemory_;
+        statistics.memoryBudget = memoryBudget_;
+        return statistics;
+    }
+
+    void ResourceStore::enableHotReload(std::chrono::milliseconds pollingInterval, ResourceReloadListener listener)
+    {
+        auto watcher = std::make_unique<FileWatcher>([this](const std::vector<std::string>& paths)
+        {
+            std::vector<ResourceId> ids;
+            for (const auto& path : paths)
+            {
+                ids.emplace_back(path);
+            }
+
+            // Errors are reported to the listener
+            try
+            {
+                reload(ids);
+            }
+            catch (...)
+            {
+            }
+        }, pollingInterval);
+
+        std::unique_ptr<FileWatcher> old;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            old = std::move(watcher_);
+            watcher_ = std::move(watcher);
+            reloadListener_ = listener;
+        }
+    }
+
+    void ResourceStore::disableHotReload()
+    {
+        // Join the watcher thread out of the lock, because it may be reloading
+        std::unique_ptr<FileWatcher> old;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            old = std::move(watcher_);
+        }
     }
 
-    std::shared_ptr<IsResource> ResourceStore::load(const std::string& path)
+    void ResourceStore::reload(const std::vector<ResourceId>& ids)
     {
-        const auto lowers = toLowers(path);
-        const auto ext = detail::getExtension(lowers);
+        TaskGraph graph;
+        std::unordered_map<ResourceId, TaskGraph::TaskId> tasks;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+
+            std::unordered_map<ResourceId, std::vector<ResourceId>> dependentMap;
+            for (const auto& edges : dependencyMap_)
+            {
+                for (const auto& dependency : edges.second)
+                {
+                    dependentMap[dependency].emplace_back(edges.first);
+                }
+            }
 
-        const auto loader = loaderMap_.find(ext);
-        assert(loader != std::cend(loaderMap_) && ("A resource loader \'" + ext + "\' not exists.").c_str());
+            // Collect the loaded resources affected by the modifications
+            std::vector<ResourceId> stack;
+            for (const auto& id : ids)
+            {
+                if (isLoaded(id))
+                {
+                    stack.emplace_back(id);
+                }
+            }
+            while (!stack.empty())
+            {
+                const auto id = stack.back();
+                stack.pop_back();
+                if (tasks.count(id))
+                {
+                    continue;
+                }
+
+                tasks.emplace(id, graph.addTask(id.getPath(), [this, id] { reloadResource(id); }));
+                const auto dependents = dependentMap.find(id);
+                if (dependents != std::cend(dependentMap))
+                {
+                    for (const auto& dependent : dependents->second)
+                    {
+                        if (isLoaded(dependent))
+                        {
+                            stack.emplace_back(dependent);
+                        }
+                    }
+                }
+            }
+
+            // Dependencies are reloaded before the dependents
+            for (const auto& task : tasks)
+            {
+                const auto edges = dependencyMap_.find(task.first);
+                if (edges == std::cend(dependencyMap_))
+                {
+                    continue;
+                }
+                for (const auto& dependency : edges->second)
+                {
+                    const auto it = tasks.find(dependency);
+                    if (it != std::cend(tasks))
+                    {
+                        graph.precede(it->second, task.second);
+                    }
+                }
+            }
+        }
 
-        const auto resource = loader->second(lowers);
-        resourceMap_[lowers] = resource;
-        return resource;
+        graph.run(*loadThreads_);
     }
 
-    void ResourceStore::unload(const std::string& path)
+    ResourceFuture ResourceStore::findOrStartLoading(const ResourceId& id, bool findLoaded,
+        std::shared_ptr<std::promise<std::shared_ptr<IsResource>>>& started)
     {
-        resourceMap_.erase(toLowers(path));
+        auto& shard = getShard(id);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+
+        const auto loading = shard.loadingMap.find(id);
+        if (loading != std::cend(shard.loadingMap))
+        {
+            return loading->second;
+        }
+
+        if (findLoaded)
+        {
+            const auto loaded = shard.resourceMap.find(id);
+            if (loaded != std::end(shard.resourceMap))
+            {
+                ++numHits_;
+                loaded->second.lastAccess = ++accessClock_;
+
+                std::promise<std::shared_ptr<IsResource>> ready;
+                ready.set_value(loaded->second.resource);
+                return ready.get_future().share();
+            }
+        }
+
+        ++numMisses_;
+        started = std::make_shared<std::promise<std::shared_ptr<IsResource>>>();
+        const auto future = started->get_future().share();
+        shard.loadingMap.emplace(id, future);
+        return future;
+    }
+
+    void ResourceStore::runLoader(const ResourceId& id, std::promise<std::shared_ptr<IsResource>>& promise)
+    {
+        try
+        {
+            Loader loader;
+            std::vector<std::shared_ptr<ResourcePack>> packs;
+            {
+                const auto ext = detail::getExtension(id.getPath());
+                std::lock_guard<std::mutex> lock(mutex_);
+                const auto it = loaderMap_.find(ext);
+                enforce<FileException>(it != std::cend(loaderMap_), "A resource loader \'" + ext + "\' not exists.");
+                loader = it->second;
+
+                // The loader declares the dependencies again
+                dependencyMap_.erase(id);
+
+                if (loader.fromData)
+                {
+                    packs = packs_;
+                }
+            }
+
+            auto packed = false;
+            const auto resource = loader.fromData ? detail::loadFromData(id, loader.fromData, packs, packed) : loader.fromPath(id.getPath());
+            const auto size = resource ? resource->getResourceSize() : 0;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (watcher_ && !packed)
+                {
+                    watcher_->watch(id.getPath());
+                }
+            }
+
+            auto& shard = getShard(id);
+            {
+                std::lock_guard<std::mutex> lock(shard.mutex);
+                addResource(shard, id, resource, size);
+                shard.loadingMap.erase(id);
+            }
+            evict();
+            promise.set_value(resource);
+        }
+        catch (...)
+        {
+            auto& shard = getShard(id);
+            {
+                std::lock_guard<std::mutex> lock(shard.mutex);
+                shard.loadingMap.erase(id);
+            }
+            promise.set_exception(std::current_exception());
+        }
+    }
+
+    bool ResourceStore::dependsOn(const ResourceId& from, const ResourceId& to) const
+    {
+        std::vector<ResourceId> stack = { from };
+        std::unordered_set<ResourceId> visited;
+        while (!stack.empty())
+        {
+            const auto id = stack.back();
+            stack.pop_back();
+            if (id == to)
+            {
+                return true;
+            }
+            if (!visited.insert(id).second)
+            {
+                continue;
+            }
+
+            const auto it = dependencyMap_.find(id);
+            if (it != std::cend(dependencyMap_))
+            {
+                stack.insert(std::end(stack), std::cbegin(it->second), std::cend(it->second));
+            }
+        }
+        return false;
+    }
+
+    void ResourceStore::reloadResource(const ResourceId& id)
+    {
+        std::shared_ptr<std::promise<std::shared_ptr<IsResource>>> started;
+        const auto future = findOrStartLoading(id, false, started);
+        if (started)
+        {
+            runLoader(id, *started);
+        }
+
+        std::exception_ptr error;
+        try
+        {
+            wait(future);
+        }
+        catch (...)
+        {
+            error = std::current_exception();
+        }
+
+        ResourceReloadListener listener;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            listener = reloadListener_;
+        }
+        if (listener)
+        {
+            listener(id, error);
+        }
+        if (error)
+        {
+            std::rethrow_exception(error);
+        }
+    }
+
+    ResourceStore::Shard& ResourceStore::getShard(const ResourceId& id)
+    {
+        return shards_[id.getHash() % NUM_SHARDS];
+    }
+
+    bool ResourceStore::isLoaded(const ResourceId& id)
+    {
+        auto& shard = getShard(id);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        return shard.resourceMap.count(id) > 0;
+    }
+
+    void ResourceStore::addResource(Shard& shard, const ResourceId& id, const std::shared_ptr<IsResource>& resource, size_t size)
+    {
+        const auto it = shard.resourceMap.find(id);
+        if (it != std::end(shard.resourceMap))
+        {
+            removeResource(shard, it);
+        }
+
+        shard.resourceMap.emplace(id, Entry{ resource, size, ++accessClock_ });
+        usedMemory_ += size;
+    }
+
+    void ResourceStore::removeResource(Shard& shard, std::unordered_map<ResourceId, Entry>::iterator it)
+    {
+        // Accessors caching the old instance refer the store again
+        const auto generation = shard.generationMap.find(it->first);
+        if (generation != std::cend(shard.generationMap))
+        {
+            ++*generation->second;
+        }
+
+        usedMemory_ -= it->second.size;
+        shard.resourceMap.erase(it);
+    }
+
+    void ResourceStore::evict()
+    {
+        if (usedMemory_ <= memoryBudget_)
+        {
+            return;
+        }
+
+        std::lock_guard<std::mutex> evictLock(evictMutex_);
+
+        // Resources referred out of the store are kept, because eviction would not free them
+        std::vector<std::pair<uint64_t, ResourceId>> candidates;
+        for (auto& shard : shards_)
+        {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            for (const auto& entry : shard.resourceMap)
+            {
+                if (entry.second.size > 0 && entry.second.resource.use_count() == 1)
+                {
+                    candidates.emplace_back(entry.second.lastAccess, entry.first);
+                }
+            }
+        }
+
+        // Evict least recently accessed first, and skip resources accessed after collected
+        std::sort(std::begin(candidates), std::end(candidates),
+            [](const std::pair<uint64_t, ResourceId>& a, const std::pair<uint64_t, ResourceId>& b) { return a.first < b.first; });
+        for (const auto& candidate : candidates)
+        {
+            if (usedMemory_ <= memoryBudget_)
+            {
+                break;
+            }
+
+            auto& shard = getShard(candidate.second);
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            const auto it = shard.resourceMap.find(candidate.second);
+            if (it != std::end(shard.resourceMap) && it->second.lastAccess == candidate.first && it->second.resource.use_count() == 1)
+            {
+                removeResource(shard, it);
+                ++numEvictions_;
+            }
+        }
     }
 
     ResourceManager::ResourceManager()
@@ -68,6 +639,37 @@ namespace killme
         store_->unregisterLoader(toLowers(ext));
     }
 
+    void ResourceManager::registerDataLoader(const std::string& ext, ResourceDataLoader loader)
+    {
+        store_->registerDataLoader(toLowers(ext), loader);
+    }
+
+    void ResourceManager::mountPack(const std::string& path)
+    {
+        store_->mountPack(path);
+    }
+
+    std::vector<ResourceFuture> ResourceManager::prefetch(const std::vector<std::string>& paths)
+    {
+        return store_->prefetch(paths);
+    }
+
+    void ResourceManager::enableHotReload(std::chrono::milliseconds pollingInterval, ResourceReloadListener listener)
+    {
+        store_->enableHotReload(pollingInterval, listener);
+    }
+
+    std::vector<std::shared_ptr<IsResource>> ResourceManager::loadDependencies(const std::string& dependent, const std::vector<std::string>& paths)
+    {
+        std::vector<ResourceId> dependencies;
+        dependencies.reserve(paths.size());
+        for (const auto& path : paths)
+        {
+            dependencies.emplace_back(path);
+        }
+        return store_->loadDependencies(ResourceId(dependent), dependencies);
+    }
+
     std::weak_ptr<ResourceStore> ResourceManager::getStore()
     {
         return store_;
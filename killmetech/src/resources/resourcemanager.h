@@ -1,40 +1,218 @@
 #ifndef _KILLME_RESOURCEMANAGER_H_
 #define _KILLME_RESOURCEMANAGER_H_
 
+#include "resourceid.h"
 #include <memory>
 #include <unordered_map>
 #include <functional>
+#include <future>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <vector>
 #include <string>
+#include <cstdint>
 
 namespace killme
 {
     class IsResource;
+    class ThreadPool;
+    class ResourcePack;
+    class FileWatcher;
 
-    /** Media resource loader */
+    /** Bytes of a resource file */
+    struct ResourceData
+    {
+        const unsigned char* data;
+        size_t size;
+        uint64_t writeTime; /// Last write time of a loose file, or 0 if packed
+    };
+
+    /** Media resource loader. The path is normalized by normalizeResourcePath(). */
+    /// NOTE: Loaders may be called on the loading threads concurrently.
     using ResourceLoader = std::function<std::shared_ptr<IsResource>(const std::string&)>;
 
+    /** Media resource loader from memory mapped bytes of a packed or loose file */
+    /// NOTE: The bytes are valid only while the loader is called.
+    using ResourceDataLoader = std::function<std::shared_ptr<IsResource>(const std::string&, const ResourceData&)>;
+
+    /** Handle of an asynchronous loading */
+    using ResourceFuture = std::shared_future<std::shared_ptr<IsResource>>;
+
+    /** Called on a background thread after a resource is reloaded. The error is null if succeeded. */
+    using ResourceReloadListener = std::function<void(const ResourceId&, std::exception_ptr)>;
+
+    /** Generation of a resource path, which is advanced when the loaded resource is replaced or dropped */
+    using ResourceGeneration = std::atomic<uint64_t>;
+
+    /** Statistics of a resource store */
+    struct ResourceStoreStatistics
+    {
+        size_t numHits; /// Count of requests served by loaded resources
+        size_t numMisses; /// Count of loads
+        size_t numEvictions; /// Count of resources evicted by the memory budget
+        size_t usedMemory; /// Total size[byte] of loaded resources
+        size_t memoryBudget;
+    };
+
     /** Media resource store */
+    /// NOTE: All functions are thread safe. Loaded resources are sharded by the path, so that lookups
+    ///       of different paths do not contend. Requests for a path being loaded are coalesced into the loading.
+    ///       Loaders declare resources they depend on by loadDependencies(), so that independent
+    ///       dependencies are loaded in parallel before the dependent resource is constructed.
+    ///       When loaded resources exceed the memory budget, least recently accessed resources
+    ///       that are not referred out of the store are evicted. Resource<T> reloads them on the next access.
+    ///       With hot reload, modified loose files are reloaded and swapped into the store, then
+    ///       the resources depending on them are reloaded in the dependency order. Resource<T> refers the new
+    ///       instances on the next access.
     class ResourceStore
     {
     private:
-        std::unordered_map<std::string, ResourceLoader> loaderMap_;
-        std::unordered_map<std::string, std::shared_ptr<IsResource>> resourceMap_;
+        struct Entry
+        {
+            std::shared_ptr<IsResource> resource;
+            size_t size;
+            uint64_t lastAccess; // Tick of the access clock
+        };
+
+        struct Shard
+        {
+            std::mutex mutex;
+            std::unordered_map<ResourceId, Entry> resourceMap;
+            std::unordered_map<ResourceId, ResourceFuture> loadingMap;
+            std::unordered_map<ResourceId, std::shared_ptr<ResourceGeneration>> generationMap; // Kept while the store lives
+        };
+
+        static const size_t NUM_SHARDS = 16;
+
+        struct Loader
+        {
+            ResourceLoader fromPath;
+            ResourceDataLoader fromData;
+        };
+
+        // Guarded by mutex_, which is never locked while a shard is locked
+        std::unordered_map<std::string, Loader> loaderMap_;
+        std::vector<std::shared_ptr<ResourcePack>> packs_;
+        std::unordered_map<ResourceId, std::vector<ResourceId>> dependencyMap_; // Dependent to dependencies
+        std::unique_ptr<FileWatcher> watcher_;
+        ResourceReloadListener reloadListener_;
+        std::mutex mutex_;
+
+        Shard shards_[NUM_SHARDS];
+        std::atomic<uint64_t> accessClock_;
+        std::atomic<size_t> memoryBudget_;
+        std::atomic<size_t> numHits_;
+        std::atomic<size_t> numMisses_;
+        std::atomic<size_t> numEvictions_;
+        std::atomic<size_t> usedMemory_;
+        std::mutex evictMutex_;
+
+        // Destroyed first, so that running loads can access the maps
+        std::unique_ptr<ThreadPool> loadThreads_;
 
     public:
+        /** Construct */
+        ResourceStore();
+
+        /** Wait for all asynchronous loads and destruct */
+        ~ResourceStore();
+
         /** Set a media resource loader */
         void registerLoader(const std::string& ext, ResourceLoader loader);
 
+        /** Set a media resource loader that receives the file bytes */
+        void registerDataLoader(const std::string& ext, ResourceDataLoader loader);
+
         /** Remove a media resource loader */
         void unregisterLoader(const std::string& ext);
 
         /** Return a loaded resource */
-        std::shared_ptr<IsResource> getLoadedResource(const std::string& path);
+        std::shared_ptr<IsResource> getLoadedResource(const ResourceId& id);
+
+        /** Return a loaded resource without counting it as an access, for observers polling resources */
+        std::shared_ptr<IsResource> peekLoadedResource(const ResourceId& id);
+
+        /** Return the generation of a resource path, for accessors caching the loaded resource */
+        /// NOTE: Read the generation before getting the resource, so that a concurrent reload is detected on the next read.
+        std::shared_ptr<const ResourceGeneration> getGeneration(const ResourceId& id);
 
         /** Load a resource */
-        std::shared_ptr<IsResource> load(const std::string& path);
+        /// NOTE: If the resource is being loaded asynchronously, wait for it instead of loading again.
+        std::shared_ptr<IsResource> load(const ResourceId& id);
+
+        /** Load a resource on the loading threads */
+        /// NOTE: If the resource is already loaded, return a ready future.
+        ResourceFuture loadAsync(const ResourceId& id);
+
+        /** Load resources on the loading threads */
+        std::vector<ResourceFuture> prefetch(const std::vector<std::string>& paths);
+
+        /** Wait for an asynchronous loading. Pending loads are run on the calling thread while waiting. */
+        std::shared_ptr<IsResource> wait(const ResourceFuture& future);
+
+        /** Wait for all asynchronous loads */
+        void waitForLoading();
+
+        /** Load resources that a resource depends on in parallel, and wait for them */
+        /// NOTE: Call in the loader of the dependent resource. Keep the returned resources until the dependent is constructed.
+        ///       Throw FileException if the dependency makes a cycle.
+        std::vector<std::shared_ptr<IsResource>> loadDependencies(const ResourceId& dependent, const std::vector<ResourceId>& dependencies);
+
+        /** Return resources that a resource depends on */
+        std::vector<ResourceId> getDependencies(const ResourceId& id);
 
         /** Unload a resource */
-        void unload(const std::string& path);
+        void unload(const ResourceId& id);
+
+        /** Mount a pack file. Resources in packs mounted later take precedence over earlier ones and loose files. */
+        void mountPack(const std::string& path);
+
+        /** Unmount a pack file */
+        void unmountPack(const std::string& path);
+
+        /** Set the memory budget[byte]. The default is unlimited. */
+        void setMemoryBudget(size_t budget);
+
+        /** Return the memory budget */
+        size_t getMemoryBudget();
+
+        /** Return the statistics */
+        ResourceStoreStatistics getStatistics();
+
+        /** Start watching loaded loose files, and reload them when modified */
+        /// NOTE: Files loaded before this call are not watched.
+        void enableHotReload(std::chrono::milliseconds pollingInterval, ResourceReloadListener listener);
+
+        /** Stop watching files. Do not call in the reload listener. */
+        void disableHotReload();
+
+        /** Reload loaded resources and the resources depending on them */
+        /// NOTE: Independent resources are reloaded in parallel. If a reload fails, the old resource
+        ///       and its dependents are kept, and the first exception is rethrown.
+        void reload(const std::vector<ResourceId>& ids);
+
+    private:
+        // Find a loading (or loaded) resource, otherwise register a new loading to "started"
+        ResourceFuture findOrStartLoading(const ResourceId& id, bool findLoaded, std::shared_ptr<std::promise<std::shared_ptr<IsResource>>>& started);
+
+        void runLoader(const ResourceId& id, std::promise<std::shared_ptr<IsResource>>& promise);
+
+        // Return whether "from" depends on "to" directly or indirectly
+        bool dependsOn(const ResourceId& from, const ResourceId& to) const;
+
+        void reloadResource(const ResourceId& id);
+
+        Shard& getShard(const ResourceId& id);
+        bool isLoaded(const ResourceId& id);
+
+        // Call with the shard locked
+        void addResource(Shard& shard, const ResourceId& id, const std::shared_ptr<IsResource>& resource, size_t size);
+        void removeResource(Shard& shard, std::unordered_map<ResourceId, Entry>::iterator it);
+
+        // Evict least recently accessed resources over the budget
+        void evict();
     };
 
     /** Media resource manager */
@@ -50,9 +228,24 @@ namespace killme
         /** Set the resource loader */
         void registerLoader(const std::string& ext, ResourceLoader loader);
 
+        /** Set the resource loader that receives the file bytes */
+        void registerDataLoader(const std::string& ext, ResourceDataLoader loader);
+
+        /** Mount a pack file */
+        void mountPack(const std::string& path);
+
         /** Remove the resource loader */
         void unregisterLoader(const std::string& ext);
 
+        /** Load resources on the loading threads */
+        std::vector<ResourceFuture> prefetch(const std::vector<std::string>& paths);
+
+        /** Reload modified resource files. The listener is called on a background thread. */
+        void enableHotReload(std::chrono::milliseconds pollingInterval, ResourceReloadListener listener);
+
+        /** Load resources that a resource depends on in parallel, and wait for them. Call in the loader of the dependent resource. */
+        std::vector<std::shared_ptr<IsResource>> loadDependencies(const std::string& dependent, const std::vector<std::string>& paths);
+
         /** Returns resource store */
         std::weak_ptr<ResourceStore> getStore();
     };
@@ -0,0 +1,185 @@
+#include "resourcepack.h"
+#include "../windows/mappedfile.h"
+#include "../core/exception.h"
+#include <Windows.h>
+#include <algorithm>
+#include <fstream>
+#include <vector>
+#include <utility>
+#include <cstring>
+
+namespace killme
+{
+    namespace
+    {
+        const char PACK_MAGIC[4] = { 'K', 'M', 'P', 'K' };
+        const uint32_t PACK_VERSION = 1;
+        const uint64_t PACK_ALIGNMENT = 16;
+
+        // Collect "directory/relative path" of all files under the directory
+        void listFiles(const std::string& directory, std::vector<std::string>& files)
+        {
+            WIN32_FIND_DATAA data;
+            const auto find = FindFirstFileA((directory + "/*").c_str(), &data);
+            if (find == INVALID_HANDLE_VALUE)
+            {
+                return;
+            }
+            KILLME_SCOPE_EXIT{ FindClose(find); };
+
+            do
+            {
+                const std::string name = data.cFileName;
+                if (name == "." || name == "..")
+                {
+                    continue;
+                }
+
+                const auto path = directory + "/" + name;
+                if (data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)
+                {
+                    listFiles(path, files);
+                }
+                else
+                {
+                    files.emplace_back(path);
+                }
+            } while (FindNextFileA(find, &data));
+        }
+    }
+
+    ResourcePack::ResourcePack(const std::string& path)
+        : path_(path)
+        , file_()
+        , entries_(nullptr)
+        , numEntries_(0)
+    {
+        file_ = std::make_unique<MappedFile>(path);
+        const auto data = file_->getData();
+        const auto size = static_cast<uint64_t>(file_->getSize());
+        const auto invalid = "Invalid resource pack (" + path + ").";
+
+        enforce<FileException>(size >= sizeof(detail::PackHeader), invalid);
+        const auto header = reinterpret_cast<const detail::PackHeader*>(data);
+        enforce<FileException>(std::memcmp(header->magic, PACK_MAGIC, sizeof(PACK_MAGIC)) == 0, invalid);
+        enforce<FileException>(header->version == PACK_VERSION, "Unsupported resource pack version (" + path + ").");
+        enforce<FileException>(sizeof(detail::PackHeader) + header->numEntries * sizeof(detail::PackEntry) <= size, invalid);
+
+        entries_ = reinterpret_cast<const detail::PackEntry*>(data + sizeof(detail::PackHeader));
+        numEntries_ = header->numEntries;
+
+        for (size_t i = 0; i < numEntries_; ++i)
+        {
+            const auto& e = entries_[i];
+            enforce<FileException>(i == 0 || entries_[i - 1].pathHash <= e.pathHash, invalid);
+            enforce<FileException>(e.pathOffset + static_cast<uint64_t>(e.pathSize) <= size, invalid);
+            enforce<FileException>(e.offset <= size && e.size <= size - e.offset, invalid);
+            enforce<FileException>(e.compression == ResourcePackCompression::none, "Unsupported resource compression (" + path + ").");
+        }
+    }
+
+    ResourcePack::~ResourcePack() = default;
+
+    std::string ResourcePack::getPath() const
+    {
+        return path_;
+    }
+
+    size_t ResourcePack::getNumResources() const
+    {
+        return numEntries_;
+    }
+
+    Optional<ResourceData> ResourcePack::find(const ResourceId& id) const
+    {
+        const auto& normalized = id.getPath();
+        const auto hash = id.getHash();
+
+        const auto end = entries_ + numEntries_;
+        auto it = std::lower_bound(entries_, end, hash, [](const detail::PackEntry& e, uint64_t h) { return e.pathHash < h; });
+        for (; it != end && it->pathHash == hash; ++it)
+        {
+            const auto packedPath = reinterpret_cast<const char*>(file_->getData() + it->pathOffset);
+            if (normalized.size() == it->pathSize && std::equal(std::cbegin(normalized), std::cend(normalized), packedPath))
+            {
+                return ResourceData{ file_->getData() + it->offset, static_cast<size_t>(it->size), 0 };
+            }
+        }
+        return nullopt;
+    }
+
+    void buildResourcePack(const std::string& directory, const std::string& packPath)
+    {
+        std::vector<std::string> files;
+        listFiles(directory, files);
+
+        std::vector<std::pair<uint64_t, std::string>> paths;
+        for (const auto& file : files)
+        {
+            const auto normalized = normalizeResourcePath(file);
+            paths.emplace_back(hashResourcePath(normalized), normalized);
+        }
+        std::sort(std::begin(paths), std::end(paths));
+        for (size_t i = 1; i < paths.size(); ++i)
+        {
+            enforce<FileException>(paths[i - 1] != paths[i], "Duplicated resource path (" + paths[i].second + ").");
+        }
+
+        // Layout the path strings and the aligned resource bytes
+        std::vector<detail::PackEntry> entries(paths.size());
+        uint64_t offset = sizeof(detail::PackHeader) + entries.size() * sizeof(detail::PackEntry);
+        for (size_t i = 0; i < paths.size(); ++i)
+        {
+            enforce<FileException>(offset + paths[i].second.size() <= UINT32_MAX, "Too large resource pack (" + packPath + ").");
+            entries[i].pathHash = paths[i].first;
+            entries[i].pathOffset = static_cast<uint32_t>(offset);
+            entries[i].pathSize = static_cast<uint32_t>(paths[i].second.size());
+            entries[i].compression = ResourcePackCompression::none;
+            entries[i].reserved = 0;
+            offset += paths[i].second.size();
+        }
+
+        for (size_t i = 0; i < paths.size(); ++i)
+        {
+            std::ifstream in(paths[i].second, std::ios::binary | std::ios::ate);
+            enforce<FileException>(in.is_open(), "Failed to open file (" + paths[i].second + ").");
+
+            offset = (offset + PACK_ALIGNMENT - 1) / PACK_ALIGNMENT * PACK_ALIGNMENT;
+            entries[i].offset = offset;
+            entries[i].size = static_cast<uint64_t>(in.tellg());
+            offset += entries[i].size;
+        }
+
+        // Write
+        std::ofstream out(packPath, std::ios::binary | std::ios::trunc);
+        enforce<FileException>(out.is_open(), "Failed to create file (" + packPath + ").");
+
+        detail::PackHeader header;
+        std::memcpy(header.magic, PACK_MAGIC, sizeof(PACK_MAGIC));
+        header.version = PACK_VERSION;
+        header.numEntries = static_cast<uint32_t>(entries.size());
+        header.reserved = 0;
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(entries.data()), entries.size() * sizeof(detail::PackEntry));
+        for (const auto& path : paths)
+        {
+            out.write(path.second.data(), path.second.size());
+        }
+
+        for (size_t i = 0; i < entries.size(); ++i)
+        {
+            const char padding[PACK_ALIGNMENT] = {};
+            out.write(padding, entries[i].offset - static_cast<uint64_t>(out.tellp()));
+
+            if (entries[i].size > 0)
+            {
+                std::ifstream in(paths[i].second, std::ios::binary);
+                out << in.rdbuf();
+            }
+            enforce<FileException>(static_cast<uint64_t>(out.tellp()) == entries[i].offset + entries[i].size,
+                "Failed to read file (" + paths[i].second + ").");
+        }
+
+        enforce<FileException>(!out.fail(), "Failed to write file (" + packPath + ").");
+    }
+}
\ No newline at end of file
@@ -0,0 +1,75 @@
+#ifndef _KILLME_RESOURCEPACK_H_
+#define _KILLME_RESOURCEPACK_H_
+
+#include "resourcemanager.h"
+#include "resourceid.h"
+#include "../core/optional.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace killme
+{
+    class MappedFile;
+
+    /** Compression of a packed resource */
+    enum class ResourcePackCompression : uint32_t
+    {
+        none = 0
+    };
+
+    namespace detail
+    {
+        // Pack file layout: header, entries sorted by the path hash, path strings, then resource bytes
+        struct PackHeader
+        {
+            char magic[4];
+            uint32_t version;
+            uint32_t numEntries;
+            uint32_t reserved;
+        };
+
+        struct PackEntry
+        {
+            uint64_t pathHash;
+            uint32_t pathOffset;
+            uint32_t pathSize;
+            uint64_t offset;
+            uint64_t size;
+            ResourcePackCompression compression;
+            uint32_t reserved;
+        };
+    }
+
+    /** Memory mapped resource archive */
+    class ResourcePack
+    {
+    private:
+        std::string path_;
+        std::unique_ptr<MappedFile> file_;
+        const detail::PackEntry* entries_;
+        size_t numEntries_;
+
+    public:
+        /** Map a pack file. Throw FileException if it is not a valid pack. */
+        explicit ResourcePack(const std::string& path);
+
+        /** Unmap the pack file */
+        ~ResourcePack();
+
+        /** Return the path of the pack file */
+        std::string getPath() const;
+
+        /** Return the count of resources */
+        size_t getNumResources() const;
+
+        /** Find a resource. The bytes are valid while this pack is alive. */
+        Optional<ResourceData> find(const ResourceId& id) const;
+    };
+
+    /** Build a pack file from all files under a directory */
+    /// NOTE: Resources are keyed by "directory/relative path", so that paths used to load loose files find them in the pack.
+    void buildResourcePack(const std::string& directory, const std::string& packPath);
+}
+
+#endif
\ No newline at end of file
@@ -23,14 +23,10 @@ namespace killme
         device_ = renderSystem.getDevice();
         material_ = Resource<Material>(resources, "media/debugdraw.material");
 
-        const auto window = renderSystem.getTargetWindow();
-        RECT clientRect;
-        GetClientRect(window, &clientRect);
-
         scissorRect_.top = 0;
         scissorRect_.left = 0;
-        scissorRect_.right = clientRect.right - clientRect.left;
-        scissorRect_.bottom = clientRect.bottom - clientRect.top;
+        scissorRect_.right = static_cast<int>(renderSystem.getClientWidth());
+        scissorRect_.bottom = static_cast<int>(renderSystem.getClientHeight());
     }
 
     void DebugDrawManager::finalize()
@@ -62,7 +58,7 @@ namespace killme
             return;
         }
 
-        // Prepare debug render resources
+        // Upload vertices and draw them by a command list
         const auto allocator = device_->obtainCommandAllocator();
         const auto commands = device_->obtainCommandList(allocator, nullptr);
 
@@ -72,17 +68,12 @@ namespace killme
         commands->updateGpuResource(colorBuffer, colors_.data());
         commands->transitionBarrior(positionBuffer, GpuResourceState::copyDestination, GpuResourceState::vertexBuffer);
         commands->transitionBarrior(colorBuffer, GpuResourceState::copyDestination, GpuResourceState::vertexBuffer);
-        commands->close();
-
-        {
-            const auto commandExe = { commands };
-            device_->getCommandQueue()->executeCommands(commandExe);
-            device_->getCommandQueue()->waitForCommands();
-        }
 
+        // The vertices must live until the GPU finishes drawing
         const auto vertexData = std::make_shared<VertexData>();
         vertexData->addVertices(SemanticNames::position, 0, positionBuffer);
         vertexData->addVertices(SemanticNames::color, 0, colorBuffer);
+        commands->hold(vertexData);
 
         const auto viewport = camera.getViewport();
         const auto viewMat = transpose(camera.getViewMatrix());
@@ -101,23 +92,17 @@ namespace killme
         pipeline->setPrimitiveTopology(PrimitiveTopology::lineList);
         pipeline->setVertexBuffers(vertexData);
 
-        // Begin drawing to all debugs
-        allocator->reset();
-        commands->reset(allocator, pipeline);
-
+        // Draw all debugs
+        commands->setPipelineState(pipeline);
         commands->transitionBarrior(frame.backBuffer, GpuResourceState::present, GpuResourceState::renderTarget);
         commands->draw(numVertices);
         commands->transitionBarrior(frame.backBuffer, GpuResourceState::renderTarget, GpuResourceState::present);
         commands->close();
 
-        {
-            const auto commandExe = { commands };
-            device_->getCommandQueue()->executeCommands(commandExe);
-        }
-        
+        const auto commandExe = { commands };
+        device_->getCommandQueue()->executeCommands(commandExe);
         device_->reuseCommandAllocatorAfterExecution(allocator);
         device_->reuseCommandListAfterExecution(commands);
-        device_->getCommandQueue()->waitForCommands();
 
         clear();
     }
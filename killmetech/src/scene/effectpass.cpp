@@ -5,6 +5,7 @@
 #include "../renderer/gpuresource.h"
 #include "../renderer/pipelinestate.h"
 #include "../renderer/constantbuffer.h"
+#include "../core/math/math.h"
 #include <utility>
 #include <algorithm>
 
@@ -20,6 +21,7 @@ namespace killme
         , textureUpdateInfoMap_()
         , samplerUpdateInfoMap_()
         , lightIteration_(passDesc.lightIteration)
+        , stateHash_()
     {
         std::unordered_map<std::shared_ptr<const BasicShader>, ShaderBoundDescription> eachShaders;
         for (const auto& ref : passDesc.shaderRef)
@@ -47,6 +49,9 @@ namespace killme
 
         pipeline_->setBlendState(0, passDesc.blendState);
 
+        const long shaderHashes[] = { pipeline_->getVSHash(), pipeline_->getPSHash(), pipeline_->getGSHash() };
+        stateHash_ = crc32(shaderHashes, sizeof(shaderHashes)) ^ pipeline_->getTopLevelHash();
+
         const auto resourceTable = pipeline_->getGpuResourceTable();
         const auto numHeaps = resourceTable->getNumRequiredHeaps();
         for (size_t i = 0; i < numHeaps; ++i)
@@ -81,7 +86,7 @@ namespace killme
                         }
                     }
 
-                    heap->locate(j, cbuffer);
+                    resourceTable->setConstantBuffer(requiredResource.rootIndex, cbuffer);
                 }
                 else if (requiredResource.type == BoundResourceType::texture)
                 {
@@ -156,4 +161,9 @@ namespace killme
     {
         return pipeline_;
     }
+
+    size_t EffectPass::getStateHash() const
+    {
+        return stateHash_;
+    }
 }
\ No newline at end of file
@@ -60,6 +60,7 @@ namespace killme
         std::unordered_multimap<std::string, detail::TextureUpdateInfo> textureUpdateInfoMap_;
         std::unordered_multimap<std::string, detail::SamplerUpdateInfo> samplerUpdateInfoMap_;
         LightIteration lightIteration_;
+        size_t stateHash_;
 
     public:
         /** Construct */
@@ -80,6 +81,10 @@ namespace killme
         
         /** Return pipeline state */
         std::shared_ptr<PipelineState> getPipelineState();
+
+        /** Return the hash value of shaders and fixed states */
+        /// NOTE: Passes with the same hash value can be drawn without changing the pipeline state.
+        size_t getStateHash() const;
     };
 }
 
@@ -1,5 +1,6 @@
 #include "material.h"
 #include "materialcreation.h"
+#include "effectpass.h"
 #include "../renderer/texture.h"
 #include <cassert>
 
@@ -127,6 +128,7 @@ namespace killme
         , params_()
         , useTech_()
         , techMap_()
+        , stateHash_()
     {
         for (const auto& tech : desc.getTechniques())
         {
@@ -165,6 +167,8 @@ namespace killme
                 }
             }
         }
+
+        updateStateHash();
     }
 
     MaterialPriority Material::getPriority() const
@@ -181,6 +185,26 @@ namespace killme
     {
         enforce<ItemNotFoundException>(techMap_.find(name) != std::cend(techMap_), "Technique \'" + name + "\' not found.");
         useTech_ = name;
+        updateStateHash();
+    }
+
+    size_t Material::getStateHash() const
+    {
+        return stateHash_;
+    }
+
+    void Material::updateStateHash()
+    {
+        stateHash_ = 0;
+        const auto it = techMap_.find(useTech_);
+        if (it != std::cend(techMap_))
+        {
+            const auto passes = it->second->getPasses();
+            if (std::cbegin(passes) != std::cend(passes))
+            {
+                stateHash_ = (*std::cbegin(passes))->getStateHash();
+            }
+        }
     }
 
     void Material::setTexture(const std::string& name, const Resource<Texture>& tex)
@@ -187,6 +187,9 @@ namespace killme
         std::unordered_map<std::string, Param> params_;
         std::string useTech_;
         std::unordered_map<std::string, std::shared_ptr<EffectTechnique>> techMap_;
+        size_t stateHash_;
+
+        void updateStateHash();
 
     public:
         /** Construct */
@@ -201,6 +204,9 @@ namespace killme
         /** Change current technique */
         void selectTechnique(const std::string& name);
 
+        /** Return the state hash of the first pass of the current technique */
+        size_t getStateHash() const;
+
         /** Get parameter */
         template <class T>
         T getParameter(const std::string& name)
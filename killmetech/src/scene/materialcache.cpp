@@ -0,0 +1,416 @@
+#include "materialcache.h"
+#include "materialcreation.h"
+#include "material.h"
+#include "../renderer/shaders.h"
+#include "../resources/resource.h"
+#include "../windows/mappedfile.h"
+#include "../core/exception.h"
+#include <Windows.h>
+#include <fstream>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <cstdio>
+#include <iterator>
+#include <utility>
+#include <type_traits>
+#include <cassert>
+
+namespace killme
+{
+    namespace
+    {
+        const char CACHE_MAGIC[4] = { 'K', 'M', 'M', 'C' };
+        const uint32_t CACHE_VERSION = 1;
+
+        // Kinds of material parameters
+        enum class ParameterKind : uint32_t
+        {
+            float1,
+            float3,
+            float4,
+            float4x4,
+            tex2d
+        };
+
+        class CacheWriter
+        {
+        private:
+            std::vector<unsigned char> bytes_;
+
+        public:
+            template <class T>
+            void write(const T& value)
+            {
+                const auto p = reinterpret_cast<const unsigned char*>(&value);
+                bytes_.insert(std::end(bytes_), p, p + sizeof(T));
+            }
+
+            void writeString(const std::string& s)
+            {
+                write(static_cast<uint32_t>(s.size()));
+                bytes_.insert(std::end(bytes_), std::cbegin(s), std::cend(s));
+            }
+
+            template <class Map>
+            void writeStringMap(const Map& map)
+            {
+                write(static_cast<uint32_t>(map.size()));
+                for (const auto& pair : map)
+                {
+                    writeString(pair.first);
+                    writeString(pair.second);
+                }
+            }
+
+            const std::vector<unsigned char>& getBytes() const
+            {
+                return bytes_;
+            }
+        };
+
+        // Throw MaterialLoadException if the bytes are out of range
+        class CacheReader
+        {
+        private:
+            const unsigned char* data_;
+            size_t size_;
+            size_t pos_;
+
+        public:
+            CacheReader(const unsigned char* data, size_t size)
+                : data_(data)
+                , size_(size)
+                , pos_(0)
+            {
+            }
+
+            template <class T>
+            T read()
+            {
+                enforce<MaterialLoadException>(size_ - pos_ >= sizeof(T), "Invalid material cache.");
+                T value;
+                std::memcpy(&value, data_ + pos_, sizeof(T));
+                pos_ += sizeof(T);
+                return value;
+            }
+
+            // Enums are stored as the underlying type, so check the range before the cast
+            template <class T>
+            T readEnum(T last)
+            {
+                const auto value = read<std::underlying_type_t<T>>();
+                enforce<MaterialLoadException>(value >= 0 && value <= static_cast<std::underlying_type_t<T>>(last),
+                    "Invalid material cache.");
+                return static_cast<T>(value);
+            }
+
+            std::string readString()
+            {
+                const auto length = read<uint32_t>();
+                enforce<MaterialLoadException>(size_ - pos_ >= length, "Invalid material cache.");
+                std::string s(reinterpret_cast<const char*>(data_ + pos_), length);
+                pos_ += length;
+                return s;
+            }
+
+            std::unordered_map<std::string, std::string> readStringMap()
+            {
+                std::unordered_map<std::string, std::string> map;
+                const auto n = read<uint32_t>();
+                for (uint32_t i = 0; i < n; ++i)
+                {
+                    auto key = readString();
+                    map.emplace(std::move(key), readString());
+                }
+                return map;
+            }
+
+            bool finished() const
+            {
+                return pos_ == size_;
+            }
+        };
+
+        template <class Float, size_t N>
+        void writeFloats(CacheWriter& writer, ParameterKind kind, const Variant& value)
+        {
+            writer.write(kind);
+            auto f = to<Float>(value);
+            for (size_t i = 0; i < N; ++i)
+            {
+                writer.write(f[i]);
+            }
+        }
+
+        template <class Float, size_t N>
+        MaterialParameterDescription readFloats(CacheReader& reader)
+        {
+            Float f;
+            for (size_t i = 0; i < N; ++i)
+            {
+                f[i] = reader.read<float>();
+            }
+            return{ typeNumber<Float>(), Variant(f) };
+        }
+
+        const uint64_t FNV_OFFSET_BASIS = 14695981039346656037ull;
+
+        // 64 bit FNV-1a
+        uint64_t hashBytes(uint64_t hash, const void* bytes, size_t size)
+        {
+            const auto p = static_cast<const unsigned char*>(bytes);
+            for (size_t i = 0; i < size; ++i)
+            {
+                hash ^= p[i];
+                hash *= 1099511628211ull;
+            }
+            return hash;
+        }
+
+        std::string getCachePath(const std::string& directory, uint64_t hash)
+        {
+            char name[17];
+            std::snprintf(name, sizeof(name), "%016llx", static_cast<unsigned long long>(hash));
+            return directory + "/" + name + ".materialcache";
+        }
+    }
+
+    std::string getMaterialCachePath(const std::string& directory, const char* source, size_t size)
+    {
+        return getCachePath(directory, hashBytes(FNV_OFFSET_BASIS, source, size));
+    }
+
+    std::string getMaterialCachePath(const std::string& directory, const std::string& path, uint64_t writeTime, size_t size)
+    {
+        // The path is followed by a separator, so that the key is not ambiguous
+        auto hash = hashBytes(FNV_OFFSET_BASIS, path.c_str(), path.size() + 1);
+        hash = hashBytes(hash, &writeTime, sizeof(writeTime));
+        const auto size64 = static_cast<uint64_t>(size);
+        return getCachePath(directory, hashBytes(hash, &size64, sizeof(size64)));
+    }
+
+    void writeMaterialCache(const std::string& path, const MaterialDescription& desc)
+    {
+        CacheWriter writer;
+        writer.write(CACHE_MAGIC);
+        writer.write(CACHE_VERSION);
+        writer.write(static_cast<uint64_t>(desc.getPriority()));
+
+        // Parameters
+        const auto params = desc.getParameters();
+        writer.write(static_cast<uint32_t>(std::distance(std::cbegin(params), std::cend(params))));
+        for (const auto& param : params)
+        {
+            writer.writeString(param.first);
+
+            const auto type = param.second.type;
+            const auto& value = param.second.value;
+            if (type == typeNumber<MP_float>())
+            {
+                writeFloats<MP_float, 1>(writer, ParameterKind::float1, value);
+            }
+            else if (type == typeNumber<MP_float3>())
+            {
+                writeFloats<MP_float3, 3>(writer, ParameterKind::float3, value);
+            }
+            else if (type == typeNumber<MP_float4>())
+            {
+                writeFloats<MP_float4, 4>(writer, ParameterKind::float4, value);
+            }
+            else if (type == typeNumber<MP_float4x4>())
+            {
+                writeFloats<MP_float4x4, 16>(writer, ParameterKind::float4x4, value);
+            }
+            else
+            {
+                assert(type == typeNumber<MP_tex2d>() && "Unknown material parameter type.");
+                writer.write(ParameterKind::tex2d);
+                writer.writeString(to<MP_tex2d>(value).texture.getId().getPath());
+            }
+        }
+
+        // Shader bounds
+        const auto bounds = desc.getShaderBounds();
+        uint32_t numBounds = 0;
+        for (const auto& boundsOfType : bounds)
+        {
+            numBounds += static_cast<uint32_t>(boundsOfType.second.size());
+        }
+        writer.write(numBounds);
+        for (const auto& boundsOfType : bounds)
+        {
+            for (const auto& bound : boundsOfType.second)
+            {
+                writer.write(boundsOfType.first);
+                writer.writeString(bound.first);
+                writer.writeString(bound.second.path);
+                writer.writeStringMap(bound.second.constantMapping);
+                writer.writeStringMap(bound.second.textureMapping);
+                writer.writeStringMap(bound.second.samplerMapping);
+            }
+        }
+
+        // Techniques
+        const auto techs = desc.getTechniques();
+        writer.write(static_cast<uint32_t>(std::distance(std::cbegin(techs), std::cend(techs))));
+        for (const auto& tech : techs)
+        {
+            writer.writeString(tech.first);
+            writer.write(static_cast<uint32_t>(tech.second.passes.size()));
+            for (const auto& pass : tech.second.passes)
+            {
+                writer.write(static_cast<uint64_t>(pass.first));
+                writer.write(pass.second.lightIteration);
+                writer.write(static_cast<uint8_t>(pass.second.blendState.enable));
+                writer.write(pass.second.blendState.src);
+                writer.write(pass.second.blendState.dest);
+                writer.write(pass.second.blendState.op);
+                writer.write(static_cast<uint32_t>(pass.second.shaderRef.size()));
+                for (const auto& ref : pass.second.shaderRef)
+                {
+                    writer.write(ref.first);
+                    writer.writeString(ref.second);
+                }
+            }
+        }
+
+        // Write and rename
+        const auto separator = path.find_last_of("/\\");
+        if (separator != std::string::npos)
+        {
+            CreateDirectoryA(path.substr(0, separator).c_str(), nullptr);
+        }
+
+        const auto temp = path + ".tmp" + std::to_string(GetCurrentThreadId());
+        {
+            std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+            enforce<FileException>(out.is_open(), "Failed to create file (" + temp + ").");
+            out.write(reinterpret_cast<const char*>(writer.getBytes().data()), writer.getBytes().size());
+            enforce<FileException>(!out.fail(), "Failed to write file (" + temp + ").");
+        }
+        if (!MoveFileExA(temp.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING))
+        {
+            DeleteFileA(temp.c_str());
+            throw FileException("Failed to write file (" + path + ").");
+        }
+    }
+
+    Optional<MaterialDescription> readMaterialCache(const std::string& path, ResourceManager& resources)
+    {
+        if (GetFileAttributesA(path.c_str()) == INVALID_FILE_ATTRIBUTES)
+        {
+            return nullopt;
+        }
+
+        try
+        {
+            const MappedFile file(path);
+            CacheReader reader(file.getData(), file.getSize());
+
+            MaterialDescription desc;
+            char magic[4];
+            for (auto& c : magic)
+            {
+                c = reader.read<char>();
+            }
+            if (std::memcmp(magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) != 0 || reader.read<uint32_t>() != CACHE_VERSION)
+            {
+                return nullopt;
+            }
+            desc.setPriority(static_cast<MaterialPriority>(reader.read<uint64_t>()));
+
+            // Parameters
+            const auto numParams = reader.read<uint32_t>();
+            for (uint32_t i = 0; i < numParams; ++i)
+            {
+                auto name = reader.readString();
+                switch (reader.read<ParameterKind>())
+                {
+                case ParameterKind::float1:
+                    desc.addParameter(name, readFloats<MP_float, 1>(reader));
+                    break;
+
+                case ParameterKind::float3:
+                    desc.addParameter(name, readFloats<MP_float3, 3>(reader));
+                    break;
+
+                case ParameterKind::float4:
+                    desc.addParameter(name, readFloats<MP_float4, 4>(reader));
+                    break;
+
+                case ParameterKind::float4x4:
+                    desc.addParameter(name, readFloats<MP_float4x4, 16>(reader));
+                    break;
+
+                case ParameterKind::tex2d:
+                {
+                    auto value = MP_tex2d::INIT;
+                    const auto texture = reader.readString();
+                    if (!texture.empty())
+                    {
+                        value.texture = Resource<Texture>(resources, texture);
+                    }
+                    desc.addParameter(name, { typeNumber<MP_tex2d>(), Variant(value) });
+                    break;
+                }
+
+                default:
+                    return nullopt;
+                }
+            }
+
+            // Shader bounds
+            const auto numBounds = reader.read<uint32_t>();
+            for (uint32_t i = 0; i < numBounds; ++i)
+            {
+                const auto type = reader.readEnum(ShaderType::compute);
+                auto name = reader.readString();
+                ShaderBoundDescription bound;
+                bound.path = reader.readString();
+                bound.constantMapping = reader.readStringMap();
+                bound.textureMapping = reader.readStringMap();
+                bound.samplerMapping = reader.readStringMap();
+                desc.addShaderBound(type, name, std::move(bound));
+            }
+
+            // Techniques
+            const auto numTechs = reader.read<uint32_t>();
+            for (uint32_t i = 0; i < numTechs; ++i)
+            {
+                auto name = reader.readString();
+                TechniqueDescription tech;
+                const auto numPasses = reader.read<uint32_t>();
+                for (uint32_t j = 0; j < numPasses; ++j)
+                {
+                    const auto index = static_cast<size_t>(reader.read<uint64_t>());
+                    PassDescription pass;
+                    pass.lightIteration = reader.readEnum(LightIteration::point);
+                    pass.blendState.enable = reader.read<uint8_t>() != 0;
+                    pass.blendState.src = reader.readEnum(Blend::zero);
+                    pass.blendState.dest = reader.readEnum(Blend::zero);
+                    pass.blendState.op = reader.readEnum(BlendOp::max);
+                    const auto numRefs = reader.read<uint32_t>();
+                    for (uint32_t k = 0; k < numRefs; ++k)
+                    {
+                        const auto type = reader.readEnum(ShaderType::compute);
+                        pass.shaderRef.emplace(type, reader.readString());
+                    }
+                    tech.passes.emplace(index, std::move(pass));
+                }
+                desc.addTechnique(name, std::move(tech));
+            }
+
+            if (!reader.finished())
+            {
+                return nullopt;
+            }
+            return std::move(desc);
+        }
+        catch (const FileException&)
+        {
+            // Parse the source again
+            return nullopt;
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,28 @@
+#ifndef _KILLME_MATERIALCACHE_H_
+#define _KILLME_MATERIALCACHE_H_
+
+#include "../core/optional.h"
+#include <string>
+#include <cstdint>
+
+namespace killme
+{
+    class MaterialDescription;
+    class ResourceManager;
+
+    /** Return the path of the cached description for a .material source. The file name is the hash of the source. */
+    std::string getMaterialCachePath(const std::string& directory, const char* source, size_t size);
+
+    /** Return the path of the cached description for a loose .material file. The file name is the hash of the path, the last write time and the size. */
+    /// NOTE: Finding the cache does not read the source, so use this for loose files.
+    std::string getMaterialCachePath(const std::string& directory, const std::string& path, uint64_t writeTime, size_t size);
+
+    /** Write a material description in the binary form */
+    /// NOTE: The file is written to a temporary file and renamed, so that readers never see a partial cache.
+    void writeMaterialCache(const std::string& path, const MaterialDescription& desc);
+
+    /** Read a material description from the memory mapped binary form. Return nullopt if not cached or invalid. */
+    Optional<MaterialDescription> readMaterialCache(const std::string& path, ResourceManager& resources);
+}
+
+#endif
\ No newline at end of file
@@ -1,113 +1,104 @@
 #include "materialcreation.h"
+#include "materiallexer.h"
+#include "materialcache.h"
 #include "../renderer/texture.h"
 #include "../renderer/shaders.h"
 #include "../resources/resource.h"
+#include "../windows/mappedfile.h"
+#include "../core/threadpool.h"
 #include <fstream>
 #include <iterator>
-#include <queue>
 #include <unordered_set>
-#include <functional>
-#include <stdexcept>
 #include <type_traits>
 #include <array>
-#include <cctype>
 
 namespace killme
 {
     namespace
     {
-        // Get boolean from string
-        bool stob(const std::string& s)
+        // Get boolean from token
+        Optional<bool> toBool(const MaterialToken& token)
         {
-            if (s == "true")
+            switch (token.keyword)
             {
+            case MaterialKeyword::true_:
                 return true;
-            }
-            else if (s == "false")
-            {
+            case MaterialKeyword::false_:
                 return false;
+            default:
+                return nullopt;
             }
-            throw std::invalid_argument(s + "is not boolean.");
         }
 
-        // Get LightIteration from string
-        LightIteration toLightIteration(const std::string& s)
+        // Get LightIteration from token
+        Optional<LightIteration> toLightIteration(const MaterialToken& token)
         {
-            if (s == "none")
+            switch (token.keyword)
             {
+            case MaterialKeyword::none:
                 return LightIteration::none;
+            case MaterialKeyword::directional:
+                return LightIteration::directional;
+            case MaterialKeyword::point:
+                return LightIteration::point;
+            default:
+                return nullopt;
             }
-            else if (s == "directional")
-            {
-                return  LightIteration::directional;
-            }
-            else if (s == "point")
-            {
-                return  LightIteration::point;
-            }
-            throw std::invalid_argument(s + "is not LightIteration.");
         }
 
-        // Get Blend from string
-        Blend toBlend(const std::string& s)
+        // Get Blend from token
+        Optional<Blend> toBlend(const MaterialToken& token)
         {
-            if (s == "one")
+            switch (token.keyword)
             {
+            case MaterialKeyword::one:
                 return Blend::one;
+            case MaterialKeyword::zero:
+                return Blend::zero;
+            default:
+                return nullopt;
             }
-            else if (s == "zero")
-            {
-                return  Blend::zero;
-            }
-            throw std::invalid_argument(s + "is not Blend.");
         }
-        
-        // Get BlendOp from string
-        BlendOp toBlendOp(const std::string& s)
+
+        // Get BlendOp from token
+        Optional<BlendOp> toBlendOp(const MaterialToken& token)
         {
-            if (s == "add")
+            switch (token.keyword)
             {
+            case MaterialKeyword::add:
                 return BlendOp::add;
-            }
-            else if (s == "subtract")
-            {
-                return  BlendOp::subtract;
-            }
-            else if (s == "min")
-            {
-                return  BlendOp::min;
-            }
-            else if (s == "max")
-            {
+            case MaterialKeyword::subtract:
+                return BlendOp::subtract;
+            case MaterialKeyword::min:
+                return BlendOp::min;
+            case MaterialKeyword::max:
                 return BlendOp::max;
+            default:
+                return nullopt;
             }
-            throw std::invalid_argument(s + "is not BlendOp.");
         }
 
-        // Get MaterialPriority from string
-        MaterialPriority toMaterialPriority(const std::string& s)
+        // Get MaterialPriority from token
+        Optional<MaterialPriority> toMaterialPriority(const MaterialToken& token)
         {
-            if (s == "translucent")
+            switch (token.keyword)
             {
+            case MaterialKeyword::translucent:
                 return MaterialPriority::translucent;
-            }
-            else if (s == "forward")
-            {
+            case MaterialKeyword::forward:
                 return MaterialPriority::forward;
+            default:
+                return nullopt;
             }
-            throw std::invalid_argument(s + "is not MaterialPriority.");
         }
 
         // Context
         struct ParseContext
         {
-            std::vector<std::string> tokens;
-            std::queue<size_t> numTokensInLine;
+            MaterialLexer* lexer;
+            MaterialToken token; // Current token
 
             std::string path;
-            size_t line; // Current line
-            decltype(std::cbegin(std::vector<std::string>())) token; // Current token
-            decltype(token) tokenEnd;
 
             MaterialDescription material;
 
@@ -120,62 +111,76 @@ namespace killme
             ResourceManager* resources;
         };
 
-        // Parser map type
-        using ParserMap = std::unordered_map<std::string, std::function<void(ParseContext&)>>;
-
         // Throw error
         void error(const ParseContext& context, const std::string& msg)
         {
             throw MaterialLoadException(
                 msg + "\n" +
                 "FILE: " + context.path + "\n" +
-                "LINE: " + std::to_string(context.line));
+                "LINE: " + std::to_string(context.token.line));
         }
 
         // Throw Syntax error message
-        void syntaxError(const ParseContext& context, const std::string& syntax)
+        void syntaxError(const ParseContext& context)
         {
-            error(context, "Syntax error : Unexpected token \'" + syntax + "\'.");
+            error(context, "Syntax error : Unexpected token \'" + context.token.str() + "\'.");
         }
 
         // Check current token
-        void check(const ParseContext& context, const std::string& expect)
+        void check(const ParseContext& context, const char* expect)
         {
-            if (*context.token != expect)
+            if (!context.token.is(expect))
             {
-                syntaxError(context, *context.token);
+                syntaxError(context);
             }
         }
 
         // Forward current token
-        std::string forward(ParseContext& context, const std::string& except = "")
+        const MaterialToken& forward(ParseContext& context, const char* expect = nullptr)
         {
-            enforce<MaterialLoadException>(context.token != context.tokenEnd, "Unexpected EOF.");
-            ++context.token;
-            --context.numTokensInLine.front();
-            while (context.numTokensInLine.front() == 0)
+            enforce<MaterialLoadException>(context.token.keyword != MaterialKeyword::end, "Unexpected EOF.");
+            context.token = context.lexer->next();
+
+            if (expect)
             {
-                context.numTokensInLine.pop();
-                ++context.line;
+                check(context, expect);
             }
 
-            if (!except.empty())
+            return context.token;
+        }
+
+        // Convert the token by the converter, or throw syntax error
+        template <class T>
+        T convert(const ParseContext& context, Optional<T> (*converter)(const MaterialToken&))
+        {
+            const auto value = converter(context.token);
+            if (!value)
             {
-                check(context, except);
+                syntaxError(context);
             }
-
-            return *context.token;
+            return *value;
         }
 
         // Read string literal
         std::string literal_string(ParseContext& context)
         {
             forward(context, "\"");
-            const auto str = forward(context);
+            const auto str = forward(context).str();
             forward(context, "\"");
             return str;
         }
 
+        // Read float literal
+        float literal_float(ParseContext& context)
+        {
+            float value = 0;
+            if (!toFloat(forward(context), value))
+            {
+                syntaxError(context);
+            }
+            return value;
+        }
+
         // Read array literal
         template <class T, size_t L>
         std::array<T, L> literal_array(ParseContext& context)
@@ -185,42 +190,16 @@ namespace killme
             std::array<T, L> arr;
             for (size_t i = 0; i < L - 1; ++i)
             {
-                try
-                {
-                    arr[i] = std::stof(forward(context));
-                }
-                catch (const std::invalid_argument&)
-                {
-                    syntaxError(context, *context.token);
-                }
+                arr[i] = literal_float(context);
                 forward(context, ",");
             }
 
-            try
-            {
-                arr[L - 1] = std::stof(forward(context));
-            }
-            catch (const std::invalid_argument&)
-            {
-                syntaxError(context, *context.token);
-            }
+            arr[L - 1] = literal_float(context);
 
             forward(context, "]");
 
             return arr;
         }
-
-        // Parse current token
-        void parseCurrentToken(ParseContext& context, const ParserMap& map)
-        {
-            const auto it = map.find(*context.token);
-            if (it == std::cend(map))
-            {
-                syntaxError(context, *context.token);
-            }
-            it->second(context);
-        }
-
         // Check identifier
         void addIdentifier(ParseContext& context, const std::string& name)
         {
@@ -303,12 +282,13 @@ namespace killme
             }
         }
 
+
         // Parse "priority" elemts
         void elem_priority(ParseContext& context)
         {
             forward(context, "=");
-            const auto p = forward(context);
-            context.material.setPriority(toMaterialPriority(p));
+            forward(context);
+            context.material.setPriority(convert(context, toMaterialPriority));
             forward(context, ";");
             forward(context);
         }
@@ -317,14 +297,14 @@ namespace killme
         template <class Float, size_t N>
         void elem_float(ParseContext& context)
         {
-            const auto name = forward(context);
+            const auto name = forward(context).str();
 
             addIdentifier(context, name);
 
             forward(context);
 
             Float value;
-            if (*context.token == "=")
+            if (context.token.is("="))
             {
                 const auto arr = literal_array<float, N>(context);
                 forward(context, ";");
@@ -334,13 +314,13 @@ namespace killme
                     value[i] = arr[i];
                 }
             }
-            else if (*context.token == ";")
+            else if (context.token.is(";"))
             {
                 value = Float::INIT;
             }
             else
             {
-                syntaxError(context, *context.token);
+                syntaxError(context);
             }
 
             forward(context);
@@ -351,14 +331,14 @@ namespace killme
         // Parse "tex2d" element
         void elem_tex2d(ParseContext& context)
         {
-            const auto name = forward(context);
+            const auto name = forward(context).str();
 
             addIdentifier(context, name);
 
             forward(context);
 
             MP_tex2d value;
-            if (*context.token == "=")
+            if (context.token.is("="))
             {
                 const auto path = literal_string(context);
                 forward(context, ";");
@@ -366,13 +346,13 @@ namespace killme
                 value = MP_tex2d::INIT;
                 value.texture = Resource<Texture>(*context.resources, path);
             }
-            else if (*context.token == ";")
+            else if (context.token.is(";"))
             {
                 value = MP_tex2d::INIT;
             }
             else
             {
-                syntaxError(context, *context.token);
+                syntaxError(context);
             }
 
             forward(context);
@@ -383,20 +363,31 @@ namespace killme
         // Parse "parameters" block
         void block_parameters(ParseContext& context)
         {
-            static ParserMap map({
-                { "float", elem_float<MP_float, 1> },
-                { "float3", elem_float<MP_float3, 3> },
-                { "float4", elem_float<MP_float4, 4> },
-                { "float4x4", elem_float<MP_float4x4, 16> },
-                { "tex2d", elem_tex2d }
-            });
-
             forward(context, "{");
             forward(context);
 
-            while (*context.token != "}")
+            while (!context.token.is("}"))
             {
-                parseCurrentToken(context, map);
+                switch (context.token.keyword)
+                {
+                case MaterialKeyword::float_:
+                    elem_float<MP_float, 1>(context);
+                    break;
+                case MaterialKeyword::float3:
+                    elem_float<MP_float3, 3>(context);
+                    break;
+                case MaterialKeyword::float4:
+                    elem_float<MP_float4, 4>(context);
+                    break;
+                case MaterialKeyword::float4x4:
+                    elem_float<MP_float4x4, 16>(context);
+                    break;
+                case MaterialKeyword::tex2d:
+                    elem_tex2d(context);
+                    break;
+                default:
+                    syntaxError(context);
+                }
             }
 
             forward(context);
@@ -417,7 +408,7 @@ namespace killme
         void elem_map_to_constant(ParseContext& context)
         {
             forward(context, "(");
-            const auto paramName = forward(context);
+            const auto paramName = forward(context).str();
 
             checkNumeric(context, paramName);
 
@@ -434,7 +425,7 @@ namespace killme
         void elem_map_to_texture(ParseContext& context)
         {
             forward(context, "(");
-            const auto paramName = forward(context);
+            const auto paramName = forward(context).str();
 
             checkTexture(context, paramName);
 
@@ -454,25 +445,32 @@ namespace killme
         template <ShaderType Type>
         void block_shader(ParseContext& context)
         {
-            static ParserMap map({
-                { "source", elem_source },
-                { "map_to_constant", elem_map_to_constant },
-                { "map_to_texture", elem_map_to_texture }
-            });
-
             ShaderBoundDescription shaderBound;
             context.currentShaderBound = &shaderBound;
 
-            const auto name = forward(context);
+            const auto name = forward(context).str();
 
             addIdentifier(context, name);
 
             forward(context, "{");
             forward(context);
 
-            while (*context.token != "}")
+            while (!context.token.is("}"))
             {
-                parseCurrentToken(context, map);
+                switch (context.token.keyword)
+                {
+                case MaterialKeyword::source:
+                    elem_source(context);
+                    break;
+                case MaterialKeyword::map_to_constant:
+                    elem_map_to_constant(context);
+                    break;
+                case MaterialKeyword::map_to_texture:
+                    elem_map_to_texture(context);
+                    break;
+                default:
+                    syntaxError(context);
+                }
             }
 
             forward(context);
@@ -485,17 +483,8 @@ namespace killme
         void elem_blend_enable(ParseContext& context)
         {
             forward(context, "=");
-
-            bool enable;
-            try
-            {
-                enable = stob(forward(context));
-            }
-            catch (const std::invalid_argument&)
-            {
-                syntaxError(context, *context.token);
-            }
-
+            forward(context);
+            const auto enable = convert(context, toBool);
             forward(context, ";");
             forward(context);
 
@@ -506,17 +495,8 @@ namespace killme
         void elem_blend_src(ParseContext& context)
         {
             forward(context, "=");
-
-            Blend blend;
-            try
-            {
-                blend = toBlend(forward(context));
-            }
-            catch (const std::invalid_argument&)
-            {
-                syntaxError(context, *context.token);
-            }
-
+            forward(context);
+            const auto blend = convert(context, toBlend);
             forward(context, ";");
             forward(context);
 
@@ -527,17 +507,8 @@ namespace killme
         void elem_blend_dest(ParseContext& context)
         {
             forward(context, "=");
-
-            Blend blend;
-            try
-            {
-                blend = toBlend(forward(context));
-            }
-            catch (const std::invalid_argument&)
-            {
-                syntaxError(context, *context.token);
-            }
-
+            forward(context);
+            const auto blend = convert(context, toBlend);
             forward(context, ";");
             forward(context);
 
@@ -548,17 +519,8 @@ namespace killme
         void elem_blend_op(ParseContext& context)
         {
             forward(context, "=");
-
-            BlendOp op;
-            try
-            {
-                op = toBlendOp(forward(context));
-            }
-            catch (const std::invalid_argument&)
-            {
-                syntaxError(context, *context.token);
-            }
-
+            forward(context);
+            const auto op = convert(context, toBlendOp);
             forward(context, ";");
             forward(context);
 
@@ -569,17 +531,8 @@ namespace killme
         void elem_for_each_light(ParseContext& context)
         {
             forward(context, "=");
-
-            LightIteration type;
-            try
-            {
-                type = toLightIteration(forward(context));
-            }
-            catch (const std::invalid_argument&)
-            {
-                syntaxError(context, *context.token);
-            }
-
+            forward(context);
+            const auto type = convert(context, toLightIteration);
             forward(context, ";");
             forward(context);
 
@@ -591,7 +544,7 @@ namespace killme
         void elem_shader_ref(ParseContext& context)
         {
             forward(context, "=");
-            const auto name = forward(context);
+            const auto name = forward(context).str();
 
             checkShaderBound(context, Type, name);
 
@@ -604,40 +557,54 @@ namespace killme
         // Parse "pass" block
         void block_pass(ParseContext& context)
         {
-            static ParserMap map({
-                { "vertex_shader_ref", elem_shader_ref<ShaderType::vertex> },
-                { "pixel_shader_ref", elem_shader_ref<ShaderType::pixel> },
-                { "geometry_shader_ref", elem_shader_ref<ShaderType::geometry> },
-                { "for_each_light", elem_for_each_light },
-                { "blend_op", elem_blend_op },
-                { "blend_enable", elem_blend_enable },
-                { "blend_src", elem_blend_src },
-                { "blend_dest", elem_blend_dest }
-            });
-
             PassDescription pass;
             pass.lightIteration = LightIteration::none;
             pass.blendState = BlendState::DEFAULT;
             context.currentPass = &pass;
 
-            size_t index;
-            try
-            {
-                index = std::stoi(forward(context));
-            }
-            catch (const std::invalid_argument&)
+            int number = 0;
+            if (!toInt(forward(context), number))
             {
-                syntaxError(context, *context.token);
+                syntaxError(context);
             }
+            const size_t index = number;
 
             checkPassIndex(context, *context.currentTech, index);
 
             forward(context, "{");
             forward(context);
 
-            while (*context.token != "}")
+            while (!context.token.is("}"))
             {
-                parseCurrentToken(context, map);
+                switch (context.token.keyword)
+                {
+                case MaterialKeyword::vertex_shader_ref:
+                    elem_shader_ref<ShaderType::vertex>(context);
+                    break;
+                case MaterialKeyword::pixel_shader_ref:
+                    elem_shader_ref<ShaderType::pixel>(context);
+                    break;
+                case MaterialKeyword::geometry_shader_ref:
+                    elem_shader_ref<ShaderType::geometry>(context);
+                    break;
+                case MaterialKeyword::for_each_light:
+                    elem_for_each_light(context);
+                    break;
+                case MaterialKeyword::blend_op:
+                    elem_blend_op(context);
+                    break;
+                case MaterialKeyword::blend_enable:
+                    elem_blend_enable(context);
+                    break;
+                case MaterialKeyword::blend_src:
+                    elem_blend_src(context);
+                    break;
+                case MaterialKeyword::blend_dest:
+                    elem_blend_dest(context);
+                    break;
+                default:
+                    syntaxError(context);
+                }
             }
 
             checkPass(context, pass);
@@ -651,23 +618,26 @@ namespace killme
         // Parse "technique" block
         void block_technique(ParseContext& context)
         {
-            static ParserMap map({
-                { "pass", block_pass }
-            });
-
             TechniqueDescription tech;
             context.currentTech = &tech;
 
-            const auto name = forward(context);
+            const auto name = forward(context).str();
 
             addIdentifier(context, name);
 
             forward(context, "{");
             forward(context);
 
-            while (*context.token != "}")
+            while (!context.token.is("}"))
             {
-                parseCurrentToken(context, map);
+                if (context.token.keyword == MaterialKeyword::pass)
+                {
+                    block_pass(context);
+                }
+                else
+                {
+                    syntaxError(context);
+                }
             }
 
             forward(context);
@@ -741,87 +711,6 @@ namespace killme
             context.material.addParameter("_LightAttLiner", { typeNumber<MP_float>(), Variant(MP_float::INIT) });
             context.material.addParameter("_LightAttQuadratic", { typeNumber<MP_float>(), Variant(MP_float::INIT) });
         }
-
-        // Step position by find nonspace character
-        size_t stepByNonspace(size_t p, const std::string& str)
-        {
-            while (p < str.length() && std::isspace(str[p]))
-            {
-                ++p;
-            }
-            return p;
-        }
-
-        // Tokenize line by delimiters
-        std::vector<std::string> tokenizeLine(const std::string& line)
-        {
-            static const std::string DERIMITERS = " \t\",=(){}[];";
-
-            std::vector<std::string> tokens;
-
-            for (auto p = stepByNonspace(0, line); p < line.length(); p = stepByNonspace(p, line))
-            {
-                auto q = line.find_first_of(DERIMITERS, p);
-                if (q == std::string::npos)
-                {
-                    q = line.length();
-                }
-
-                if (p == q)
-                {
-                    tokens.emplace_back(line.substr(p, 1));
-                    p = q + 1;
-                }
-                else
-                {
-                    tokens.emplace_back(line.substr(p, q - p));
-                    p = q;
-                }
-            }
-
-            return tokens;
-        }
-
-        void tokenize(std::ifstream& stream, ParseContext& context)
-        {
-            bool commentOut = false;
-
-            while (!stream.eof())
-            {
-                // Get current line
-                std::string line;
-                std::getline(stream, line);
-
-                // Erase comments
-                if (commentOut)
-                {
-                    const auto p = line.find("*/");
-                    if (p == std::string::npos)
-                    {
-                        line.clear();
-                    }
-                    else
-                    {
-                        line = line.substr(p + 2);
-                        commentOut = false;
-                    }
-                }
-
-                const auto p = line.find("/*");
-                if (p != std::string::npos)
-                {
-                    line = line.substr(0, p);
-                    commentOut = true;
-                }
-
-                line = line.substr(0, line.find("//"));
-
-                // Tokelize line
-                const auto lineTokens = tokenizeLine(line);
-                context.tokens.insert(std::cend(context.tokens), std::begin(lineTokens), std::cend(lineTokens));
-                context.numTokensInLine.push(lineTokens.size());
-            }
-        }
     }
 
     void MaterialDescription::setPriority(MaterialPriority priority)
@@ -875,49 +764,215 @@ namespace killme
     {
     }
 
+    MaterialBatchLoadException::MaterialBatchLoadException(const std::string& msg, const std::vector<std::string>& failedPaths)
+        : MaterialLoadException(msg)
+        , failedPaths_(failedPaths)
+    {
+    }
+
+    const std::vector<std::string>& MaterialBatchLoadException::getFailedPaths() const
+    {
+        return failedPaths_;
+    }
+
+    namespace
+    {
+        const char BEGIN_TEXT[] = "MATERIAL_BEGIN";
+
+        std::string readSource(const std::string& path)
+        {
+            std::ifstream stream(path);
+            enforce<MaterialLoadException>(stream.is_open(), "Failed to open file (" + path + ").");
+            return std::string(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+        }
+
+        MaterialDescription parseMaterial(ResourceManager& resources, const std::string& path, const char* source, size_t size)
+        {
+            // Tokens are read while parsing
+            MaterialLexer lexer(source, size);
+
+            ParseContext context;
+            context.lexer = &lexer;
+            context.token = { BEGIN_TEXT, BEGIN_TEXT + sizeof(BEGIN_TEXT) - 1, MaterialKeyword::identifier, 0 };
+            context.path = path;
+            context.currentShaderBound = nullptr;
+            context.currentPass = nullptr;
+            context.currentTech = nullptr;
+            context.resources = &resources;
+
+            initContext(context);
+
+            // Parse
+            forward(context);
+            while (context.token.keyword != MaterialKeyword::end)
+            {
+                switch (context.token.keyword)
+                {
+                case MaterialKeyword::parameters:
+                    block_parameters(context);
+                    break;
+                case MaterialKeyword::vertex_shader:
+                    block_shader<ShaderType::vertex>(context);
+                    break;
+                case MaterialKeyword::pixel_shader:
+                    block_shader<ShaderType::pixel>(context);
+                    break;
+                case MaterialKeyword::geometry_shader:
+                    block_shader<ShaderType::geometry>(context);
+                    break;
+                case MaterialKeyword::technique:
+                    block_technique(context);
+                    break;
+                case MaterialKeyword::priority:
+                    elem_priority(context);
+                    break;
+                default:
+                    syntaxError(context);
+                }
+            }
+
+            return std::move(context.material);
+        }
+
+        std::shared_ptr<Material> createMaterial(RenderDevice& device, ResourceManager& resources, const std::string& path, const MaterialDescription& desc)
+        {
+            std::vector<std::string> paths;
+            for (const auto& param : desc.getParameters())
+            {
+                if (param.second.type == typeNumber<MP_tex2d>())
+                {
+                    const auto& texture = to<MP_tex2d>(param.second.value).texture;
+                    if (texture.bound())
+                    {
+                        paths.emplace_back(texture.getId().getPath());
+                    }
+                }
+            }
+            for (const auto& bounds : desc.getShaderBounds())
+            {
+                for (const auto& bound : bounds.second)
+                {
+                    paths.emplace_back(bound.second.path);
+                }
+            }
+
+            // Load textures and shaders in parallel, and keep them until the material refers them
+            const auto dependencies = resources.loadDependencies(path, paths);
+
+            return std::make_shared<Material>(device, resources, desc);
+        }
+
+        // Read the cached description, otherwise parse the source and cache the description
+        MaterialDescription describeMaterial(ResourceManager& resources, const std::string& path,
+            const char* source, size_t size, uint64_t writeTime, const std::string& cacheDirectory)
+        {
+            const auto cachePath = writeTime != 0
+                ? getMaterialCachePath(cacheDirectory, path, writeTime, size)
+                : getMaterialCachePath(cacheDirectory, source, size);
+            if (auto cached = readMaterialCache(cachePath, resources))
+            {
+                return std::move(*cached);
+            }
+
+            auto desc = parseMaterial(resources, path, source, size);
+
+            // The cache is an optimization, so failures to write it are ignored
+            try
+            {
+                writeMaterialCache(cachePath, desc);
+            }
+            catch (const FileException&)
+            {
+            }
+
+            return desc;
+        }
+    }
+
     std::shared_ptr<Material> loadMaterial(RenderDevice& device, ResourceManager& resources, const std::string& path)
     {
-        std::ifstream stream(path);
-        enforce<MaterialLoadException>(stream.is_open(), "Failed to open file (" + path + ").");
-
-        ParseContext context;
-        context.path = path;
-        context.line = 0;
-        context.currentShaderBound = nullptr;
-        context.currentPass = nullptr;
-        context.currentTech = nullptr;
-        context.resources = &resources;
-
-        context.tokens.emplace_back("MATERIAL_BEGIN");
-        context.numTokensInLine.push(1);
-
-        // Tokenize source code
-        tokenize(stream, context);
-        stream.close();
-
-        context.tokens.emplace_back("MATERIAL_END");
-        context.numTokensInLine.push(1);
-        context.token = std::cbegin(context.tokens);
-        context.tokenEnd = std::cend(context.tokens);
-
-        // Parse
-        static ParserMap map({
-            { "parameters", block_parameters },
-            { "vertex_shader", block_shader<ShaderType::vertex> },
-            { "pixel_shader", block_shader<ShaderType::pixel> },
-            { "geometry_shader", block_shader<ShaderType::geometry> },
-            { "technique", block_technique },
-            { "priority", elem_priority }
+        const auto source = readSource(path);
+        return createMaterial(device, resources, path, parseMaterial(resources, path, source.data(), source.size()));
+    }
+
+    std::shared_ptr<Material> loadMaterial(RenderDevice& device, ResourceManager& resources, const std::string& path, const char* source, size_t size)
+    {
+        return createMaterial(device, resources, path, parseMaterial(resources, path, source, size));
+    }
+
+    std::shared_ptr<Material> loadMaterial(RenderDevice& device, ResourceManager& resources, const std::string& path,
+        const char* source, size_t size, uint64_t writeTime, const std::string& cacheDirectory)
+    {
+        return createMaterial(device, resources, path, describeMaterial(resources, path, source, size, writeTime, cacheDirectory));
+    }
+
+    std::vector<std::shared_ptr<Material>> loadMaterials(RenderDevice& device, ResourceManager& resources, ThreadPool& pool,
+        const std::vector<std::string>& paths, const std::string& cacheDirectory)
+    {
+        std::vector<Optional<MaterialDescription>> descs(paths.size());
+        std::vector<std::string> errors(paths.size());
+
+        // Parsing does not touch the device, so the sources are parsed in parallel
+        pool.parallelFor(paths.size(), [&](size_t i)
+        {
+            try
+            {
+                // Mapping does not read the source, so that cached materials are not read
+                const MappedFile file(paths[i]);
+                descs[i] = describeMaterial(resources, paths[i], reinterpret_cast<const char*>(file.getData()), file.getSize(),
+                    file.getLastWriteTime(), cacheDirectory);
+            }
+            catch (const Exception& e)
+            {
+                errors[i] = e.getMessage();
+            }
+            catch (const std::exception& e)
+            {
+                errors[i] = "Failed to load material (" + paths[i] + "). " + e.what();
+            }
         });
 
-        initContext(context);
+        std::vector<std::shared_ptr<Material>> materials(paths.size());
+        for (size_t i = 0; i < paths.size(); ++i)
+        {
+            if (!descs[i])
+            {
+                continue;
+            }
+
+            try
+            {
+                materials[i] = createMaterial(device, resources, paths[i], *descs[i]);
+            }
+            catch (const Exception& e)
+            {
+                errors[i] = e.getMessage();
+            }
+            catch (const std::exception& e)
+            {
+                errors[i] = "Failed to load material (" + paths[i] + "). " + e.what();
+            }
+        }
+
+        // Report all errors at once
+        std::vector<std::string> failedPaths;
+        std::string msg;
+        for (size_t i = 0; i < paths.size(); ++i)
+        {
+            if (!materials[i])
+            {
+                failedPaths.emplace_back(paths[i]);
+                msg += "\n\n" + errors[i];
+            }
+        }
 
-        forward(context);
-        while (*context.token != "MATERIAL_END")
+        if (!failedPaths.empty())
         {
-            parseCurrentToken(context, map);
+            throw MaterialBatchLoadException(
+                "Failed to load " + std::to_string(failedPaths.size()) + " of " + std::to_string(paths.size()) + " materials." + msg,
+                failedPaths);
         }
 
-        return std::make_shared<Material>(device, resources, context.material);
+        return materials;
     }
 }
\ No newline at end of file
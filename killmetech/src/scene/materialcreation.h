@@ -15,11 +15,13 @@
 #include <set>
 #include <string>
 #include <memory>
+#include <cstdint>
 
 namespace killme
 {
     class RenderDevice;
     class ResourceManager;
+    class ThreadPool;
     enum class ShaderType;
 
     /** Material parameter description */
@@ -80,6 +82,12 @@ namespace killme
             return constRange(paramMap_);
         }
 
+        auto getShaderBounds() const
+            -> decltype(constRange(shaderBoundMap_))
+        {
+            return constRange(shaderBoundMap_);
+        }
+
         auto getTechniques() const
             -> decltype(constRange(techs_))
         {
@@ -95,8 +103,38 @@ namespace killme
         explicit MaterialLoadException(const std::string& msg);
     };
 
+    /** Loading materials in a batch exception. The message lists the errors of all failed materials. */
+    class MaterialBatchLoadException : public MaterialLoadException
+    {
+    private:
+        std::vector<std::string> failedPaths_;
+
+    public:
+        /** Construct */
+        MaterialBatchLoadException(const std::string& msg, const std::vector<std::string>& failedPaths);
+
+        /** Return the paths of the failed materials */
+        const std::vector<std::string>& getFailedPaths() const;
+    };
+
     /** Load a material */
     std::shared_ptr<Material> loadMaterial(RenderDevice& device, ResourceManager& resources, const std::string& path);
+
+    /** Load a material from the source on memory. The path is used for error messages. */
+    std::shared_ptr<Material> loadMaterial(RenderDevice& device, ResourceManager& resources, const std::string& path, const char* source, size_t size);
+
+    /** Load a material from the source on memory, and cache the parsed description in the binary form */
+    /// NOTE: Sources with a cached description are not parsed. A loose file is found in the cache by the path,
+    ///       the last write time and the size, so that the source is not read on a hit. Pass 0 as the write time
+    ///       for a packed source, which is found by the hash of the source.
+    std::shared_ptr<Material> loadMaterial(RenderDevice& device, ResourceManager& resources, const std::string& path,
+        const char* source, size_t size, uint64_t writeTime, const std::string& cacheDirectory);
+
+    /** Load materials. The sources are parsed and validated in parallel, then the materials are created on the calling thread. */
+    /// NOTE: All materials are tried even if some of them fail, then MaterialBatchLoadException is thrown.
+    ///       Parsed descriptions are cached like loadMaterial(), so that cached sources are not read nor parsed.
+    std::vector<std::shared_ptr<Material>> loadMaterials(RenderDevice& device, ResourceManager& resources, ThreadPool& pool,
+        const std::vector<std::string>& paths, const std::string& cacheDirectory);
 }
 
 #endif
\ No newline at end of file
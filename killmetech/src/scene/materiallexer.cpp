@@ -0,0 +1,282 @@
+#include "materiallexer.h"
+#include <algorithm>
+#include <type_traits>
+#include <cstring>
+#include <cstdlib>
+#include <cctype>
+
+namespace killme
+{
+    namespace
+    {
+        const char END_TEXT[] = "MATERIAL_END";
+
+        struct KeywordEntry
+        {
+            const char* text;
+            MaterialKeyword keyword;
+        };
+
+        // Sorted by the text
+        const KeywordEntry KEYWORDS[] = {
+            { "add", MaterialKeyword::add },
+            { "blend_dest", MaterialKeyword::blend_dest },
+            { "blend_enable", MaterialKeyword::blend_enable },
+            { "blend_op", MaterialKeyword::blend_op },
+            { "blend_src", MaterialKeyword::blend_src },
+            { "deferred", MaterialKeyword::deferred },
+            { "directional", MaterialKeyword::directional },
+            { "false", MaterialKeyword::false_ },
+            { "float", MaterialKeyword::float_ },
+            { "float3", MaterialKeyword::float3 },
+            { "float4", MaterialKeyword::float4 },
+            { "float4x4", MaterialKeyword::float4x4 },
+            { "for_each_light", MaterialKeyword::for_each_light },
+            { "forward", MaterialKeyword::forward },
+            { "geometry_shader", MaterialKeyword::geometry_shader },
+            { "geometry_shader_ref", MaterialKeyword::geometry_shader_ref },
+            { "map_to_constant", MaterialKeyword::map_to_constant },
+            { "map_to_texture", MaterialKeyword::map_to_texture },
+            { "max", MaterialKeyword::max },
+            { "min", MaterialKeyword::min },
+            { "none", MaterialKeyword::none },
+            { "one", MaterialKeyword::one },
+            { "parameters", MaterialKeyword::parameters },
+            { "pass", MaterialKeyword::pass },
+            { "pixel_shader", MaterialKeyword::pixel_shader },
+            { "pixel_shader_ref", MaterialKeyword::pixel_shader_ref },
+            { "point", MaterialKeyword::point },
+            { "priority", MaterialKeyword::priority },
+            { "source", MaterialKeyword::source },
+            { "subtract", MaterialKeyword::subtract },
+            { "technique", MaterialKeyword::technique },
+            { "tex2d", MaterialKeyword::tex2d },
+            { "translucent", MaterialKeyword::translucent },
+            { "true", MaterialKeyword::true_ },
+            { "vertex_shader", MaterialKeyword::vertex_shader },
+            { "vertex_shader_ref", MaterialKeyword::vertex_shader_ref },
+            { "zero", MaterialKeyword::zero }
+        };
+
+        // Compare a text with a null terminated string like strcmp()
+        int compare(const char* begin, const char* end, const char* str)
+        {
+            for (; begin != end && *str != '\0'; ++begin, ++str)
+            {
+                if (*begin != *str)
+                {
+                    return static_cast<unsigned char>(*begin) < static_cast<unsigned char>(*str) ? -1 : 1;
+                }
+            }
+            return begin != end ? 1 : (*str != '\0' ? -1 : 0);
+        }
+
+        // Intern a word as the keyword
+        MaterialKeyword findKeyword(const char* begin, const char* end)
+        {
+            // Binary search
+            size_t low = 0;
+            size_t high = std::extent<decltype(KEYWORDS)>::value;
+            while (low < high)
+            {
+                const auto mid = (low + high) / 2;
+                const auto c = compare(begin, end, KEYWORDS[mid].text);
+                if (c == 0)
+                {
+                    return KEYWORDS[mid].keyword;
+                }
+                else if (c < 0)
+                {
+                    high = mid;
+                }
+                else
+                {
+                    low = mid + 1;
+                }
+            }
+            return MaterialKeyword::identifier;
+        }
+
+        enum class CharClass : unsigned char
+        {
+            word,
+            space,
+            delimiter
+        };
+
+        // Classes of all characters, so that the lexer does not call isspace() and strchr() per character
+        struct CharClassTable
+        {
+            CharClass classes[256];
+
+            CharClassTable()
+            {
+                for (int c = 0; c < 256; ++c)
+                {
+                    classes[c] = std::isspace(c) ? CharClass::space
+                        : (c != '\0' && std::strchr("\",=(){}[];", c) ? CharClass::delimiter : CharClass::word);
+                }
+            }
+        };
+
+        const CharClassTable CHAR_CLASSES;
+
+        bool isSpace(char c)
+        {
+            return CHAR_CLASSES.classes[static_cast<unsigned char>(c)] == CharClass::space;
+        }
+
+        bool isDelimiter(char c)
+        {
+            return CHAR_CLASSES.classes[static_cast<unsigned char>(c)] == CharClass::delimiter;
+        }
+
+        // Find a two characters pattern. Return the end if not found.
+        const char* find(const char* begin, const char* end, const char* pattern)
+        {
+            return std::search(begin, end, pattern, pattern + 2);
+        }
+
+        // Copy a token into a null terminated buffer
+        template <size_t N>
+        void copyToken(const MaterialToken& token, char (&buffer)[N])
+        {
+            const auto length = std::min(static_cast<size_t>(token.end - token.begin), N - 1);
+            std::memcpy(buffer, token.begin, length);
+            buffer[length] = '\0';
+        }
+    }
+
+    bool MaterialToken::is(const char* text) const
+    {
+        return compare(begin, end, text) == 0;
+    }
+
+    std::string MaterialToken::str() const
+    {
+        return std::string(begin, end);
+    }
+
+    MaterialLexer::MaterialLexer(const char* source, size_t size)
+        : sourceEnd_()
+        , nextLine_(source ? source : "")
+        , cursor_(nextLine_)
+        , lineEnd_(nextLine_)
+        , line_(0)
+        , commentOut_(false)
+    {
+        sourceEnd_ = nextLine_ + size;
+    }
+
+    MaterialToken MaterialLexer::next()
+    {
+        while (true)
+        {
+            while (cursor_ != lineEnd_ && isSpace(*cursor_))
+            {
+                ++cursor_;
+            }
+            if (cursor_ != lineEnd_)
+            {
+                break;
+            }
+            if (!startLine())
+            {
+                return{ END_TEXT, END_TEXT + sizeof(END_TEXT) - 1, MaterialKeyword::end, line_ + 1 };
+            }
+        }
+
+        const auto begin = cursor_;
+        if (isDelimiter(*cursor_))
+        {
+            ++cursor_;
+            return{ begin, cursor_, MaterialKeyword::identifier, line_ };
+        }
+
+        while (cursor_ != lineEnd_ && !isSpace(*cursor_) && !isDelimiter(*cursor_))
+        {
+            ++cursor_;
+        }
+        return{ begin, cursor_, findKeyword(begin, cursor_), line_ };
+    }
+
+    bool MaterialLexer::startLine()
+    {
+        if (!nextLine_)
+        {
+            return false;
+        }
+
+        // Get the current line
+        const auto begin = nextLine_;
+        auto end = static_cast<const char*>(std::memchr(begin, '\n', sourceEnd_ - begin));
+        if (end)
+        {
+            nextLine_ = end + 1;
+        }
+        else
+        {
+            end = sourceEnd_;
+            nextLine_ = nullptr;
+        }
+
+        ++line_;
+        cursor_ = begin;
+        lineEnd_ = end;
+
+        // Skip comments
+        if (commentOut_)
+        {
+            const auto p = find(cursor_, lineEnd_, "*/");
+            if (p == lineEnd_)
+            {
+                cursor_ = lineEnd_;
+            }
+            else
+            {
+                cursor_ = p + 2;
+                commentOut_ = false;
+            }
+        }
+
+        const auto p = find(cursor_, lineEnd_, "/*");
+        if (p != lineEnd_)
+        {
+            lineEnd_ = p;
+            commentOut_ = true;
+        }
+
+        lineEnd_ = find(cursor_, lineEnd_, "//");
+        return true;
+    }
+
+    bool toFloat(const MaterialToken& token, float& value)
+    {
+        char buffer[64];
+        copyToken(token, buffer);
+
+        char* end;
+        const auto v = std::strtof(buffer, &end);
+        if (end == buffer)
+        {
+            return false;
+        }
+        value = v;
+        return true;
+    }
+
+    bool toInt(const MaterialToken& token, int& value)
+    {
+        char buffer[32];
+        copyToken(token, buffer);
+
+        char* end;
+        const auto v = std::strtol(buffer, &end, 10);
+        if (end == buffer)
+        {
+            return false;
+        }
+        value = static_cast<int>(v);
+        return true;
+    }
+}
\ No newline at end of file
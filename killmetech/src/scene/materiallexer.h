@@ -0,0 +1,98 @@
+#ifndef _KILLME_MATERIALLEXER_H_
+#define _KILLME_MATERIALLEXER_H_
+
+#include <string>
+
+namespace killme
+{
+    /** Keywords of the material language */
+    enum class MaterialKeyword
+    {
+        identifier, // Not a keyword
+        end, // End of the source
+        true_,
+        false_,
+        one,
+        zero,
+        add,
+        subtract,
+        min,
+        max,
+        translucent,
+        deferred,
+        forward,
+        priority,
+        parameters,
+        float_,
+        float3,
+        float4,
+        float4x4,
+        tex2d,
+        vertex_shader,
+        pixel_shader,
+        geometry_shader,
+        source,
+        map_to_constant,
+        map_to_texture,
+        technique,
+        pass,
+        vertex_shader_ref,
+        pixel_shader_ref,
+        geometry_shader_ref,
+        for_each_light,
+        none,
+        directional,
+        point,
+        blend_enable,
+        blend_op,
+        blend_src,
+        blend_dest
+    };
+
+    /** Token of the material language. The text refers the source without copy. */
+    struct MaterialToken
+    {
+        const char* begin;
+        const char* end;
+        MaterialKeyword keyword;
+        size_t line; // 1-origin
+
+        /** Compare the text */
+        bool is(const char* text) const;
+
+        /** Return the text */
+        std::string str() const;
+    };
+
+    /** Single pass tokenizer of the material language */
+    /// NOTE: Tokens are split by whitespaces and delimiters " \t\",=(){}[];". Each delimiter is a token.
+    ///       The lexer does not copy the source, so the source must outlive the lexer and the tokens.
+    class MaterialLexer
+    {
+    private:
+        const char* sourceEnd_;
+        const char* nextLine_; // Null after the last line
+        const char* cursor_;
+        const char* lineEnd_; // End of the current line without comments
+        size_t line_;
+        bool commentOut_;
+
+    public:
+        /** Construct */
+        MaterialLexer(const char* source, size_t size);
+
+        /** Read the next token. Return the token of MaterialKeyword::end at the end of the source. */
+        MaterialToken next();
+
+    private:
+        bool startLine();
+    };
+
+    /** Convert a token to float like std::stof, but without exception. Return false if not a number. */
+    bool toFloat(const MaterialToken& token, float& value);
+
+    /** Convert a token to int like std::stoi, but without exception. Return false if not a number. */
+    bool toInt(const MaterialToken& token, int& value);
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,15 @@
+#include "mesh.h"
+#include "../renderer/vertexdata.h"
+
+namespace killme
+{
+    size_t Mesh::getResourceSize() const
+    {
+        size_t size = 0;
+        for (const auto& submesh : submeshes_)
+        {
+            size += submesh.second->getVertexData()->getSize();
+        }
+        return size;
+    }
+}
\ No newline at end of file
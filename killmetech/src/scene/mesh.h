@@ -2,6 +2,7 @@
 #define _KILLME_MESH_H_
 
 #include "../resources/resource.h"
+#include "../core/math/boundingvolume.h"
 #include "../core/utility.h"
 #include <memory>
 #include <vector>
@@ -19,12 +20,17 @@ namespace killme
     private:
         std::shared_ptr<VertexData> vertexData_;
         Resource<Material> material_;
+        BoundingBox boundingBox_;
+        BoundingSphere boundingSphere_;
 
     public:
-        /** Construct with a vertices and a material */
-        Submesh(const std::shared_ptr<VertexData>& vertexData, const Resource<Material>& material)
+        /** Construct with a vertices, a material and bounds of the vertices in the local space */
+        Submesh(const std::shared_ptr<VertexData>& vertexData, const Resource<Material>& material,
+            const BoundingBox& boundingBox, const BoundingSphere& boundingSphere)
             : vertexData_(vertexData)
             , material_(material)
+            , boundingBox_(boundingBox)
+            , boundingSphere_(boundingSphere)
         {}
 
         /** Return the vertices */
@@ -32,6 +38,10 @@ namespace killme
 
         /** Return the material */
         Resource<Material> getMaterial() const { return material_; }
+
+        /** Return bounds of the vertices in the local space */
+        const BoundingBox& getBoundingBox() const { return boundingBox_; }
+        const BoundingSphere& getBoundingSphere() const { return boundingSphere_; }
     };
 
     /** Mesh */
@@ -48,9 +58,10 @@ namespace killme
 
     public:
         /** Create a submesh */
-        std::shared_ptr<Submesh> createSubmesh(const std::string& name, const std::shared_ptr<VertexData>& vertexData, const Resource<Material>& material)
+        std::shared_ptr<Submesh> createSubmesh(const std::string& name, const std::shared_ptr<VertexData>& vertexData, const Resource<Material>& material,
+            const BoundingBox& boundingBox, const BoundingSphere& boundingSphere)
         {
-            const auto sm = std::make_shared<Submesh>(vertexData, material);
+            const auto sm = std::make_shared<Submesh>(vertexData, material, boundingBox, boundingSphere);
             submeshes_.emplace_back(name, sm);
             return sm;
         }
@@ -74,6 +85,9 @@ namespace killme
         {
             return constRange(submeshes_);
         }
+
+        /** Return the memory size of vertices */
+        size_t getResourceSize() const;
     };
 }
 
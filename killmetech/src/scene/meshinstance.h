@@ -7,6 +7,8 @@
 #include "../core/math/vector3.h"
 #include "../core/math/quaternion.h"
 #include "../core/math/matrix44.h"
+#include "../core/math/boundingvolume.h"
+#include "../core/math/frustum.h"
 #include <memory>
 
 namespace killme
@@ -39,17 +41,40 @@ namespace killme
         void setOrientation(const Quaternion& q) { orientation_ = q; }
         void setScale(const Vector3& k) { scale_ = k; }
 
-        /** Collect render elements into queue */
-        void collectMeshes(RenderQueue& queue)
+        /** Return the bounding box in the world space */
+        BoundingBox getBoundingBox()
         {
-            const auto worldMatrix = transpose(makeTransformMatrix(scale_, orientation_, position_));
+            const auto transform = makeTransformMatrix(scale_, orientation_, position_);
+            auto first = true;
+            BoundingBox box(position_, position_);
             for (const auto& sm : mesh_.access()->getSubmeshes())
             {
-                const auto elem = std::make_shared<RenderElement>();
-                elem->vertices = sm.second->getVertexData();
-                elem->material = sm.second->getMaterial().access();
-                elem->worldMatrix = worldMatrix;
-                queue.push(elem);
+                const auto smBox = transformBoundingBox(sm.second->getBoundingBox(), transform);
+                box = first ? smBox : merge(box, smBox);
+                first = false;
+            }
+            return box;
+        }
+
+        /** Collect render elements visible in the frustum into queue */
+        void collectMeshes(RenderQueue& queue, const Frustum& frustum)
+        {
+            const auto transform = makeTransformMatrix(scale_, orientation_, position_);
+            const auto worldMatrix = transpose(transform);
+            for (const auto& sm : mesh_.access()->getSubmeshes())
+            {
+                // The sphere test is cheaper, and the box test is tighter for long meshes
+                if (!frustum.intersects(transformBoundingSphere(sm.second->getBoundingSphere(), transform)))
+                {
+                    continue;
+                }
+                const auto box = transformBoundingBox(sm.second->getBoundingBox(), transform);
+                if (!frustum.intersects(box))
+                {
+                    continue;
+                }
+
+                queue.push(sm.second->getVertexData(), sm.second->getMaterial().access(), worldMatrix, box);
             }
         }
     };
@@ -0,0 +1,114 @@
+#include "renderqueue.h"
+#include "material.h"
+#include <functional>
+#include <utility>
+#include <cstring>
+
+namespace killme
+{
+    namespace
+    {
+        // Return 24 bits increasing with the depth. Depths behind the camera are 0.
+        uint64_t depthBits(float depth)
+        {
+            // Bits of positive floats are ordered as the values
+            uint32_t bits;
+            std::memcpy(&bits, &depth, sizeof(bits));
+            return depth > 0 ? (bits >> 7) & 0xffffff : 0;
+        }
+
+        // Fold a hash value into 16 bits
+        uint64_t foldBits(size_t hash)
+        {
+            const auto h = static_cast<uint64_t>(hash);
+            return (h ^ (h >> 16) ^ (h >> 32) ^ (h >> 48)) & 0xffff;
+        }
+    }
+
+    RenderQueue::RenderQueue()
+        : elements_()
+        , items_()
+        , sortBuffer_()
+        , viewMatrix_()
+    {
+    }
+
+    void RenderQueue::reset(const Matrix44& viewMatrix)
+    {
+        elements_.clear();
+        items_.clear();
+        viewMatrix_ = viewMatrix;
+    }
+
+    void RenderQueue::push(const std::shared_ptr<VertexData>& vertices, const std::shared_ptr<Material>& material,
+        const Matrix44& worldMatrix, const BoundingBox& boundingBox)
+    {
+        // Depth of the center in the view space
+        const auto c = boundingBox.getCenter();
+        const auto& v = viewMatrix_;
+        const auto depth = depthBits(c.x * v(0, 2) + c.y * v(1, 2) + c.z * v(2, 2) + v(3, 2));
+
+        const auto priority = material->getPriority();
+        const auto pipeline = foldBits(material->getStateHash());
+        const auto mat = foldBits(std::hash<const Material*>()(material.get()));
+
+        const auto priorityBits = static_cast<uint64_t>(priority);
+        uint64_t key = (priorityBits < 0xff ? priorityBits : 0xff) << 56;
+        if (priority < MaterialPriority::translucent)
+        {
+            key |= (pipeline << 40) | (mat << 24) | depth;
+        }
+        else
+        {
+            key |= ((~depth & 0xffffff) << 32) | (pipeline << 16) | mat;
+        }
+
+        RenderElement elem;
+        elem.vertices = vertices;
+        elem.material = material;
+        elem.worldMatrix = worldMatrix;
+        elem.boundingBox = boundingBox;
+        elem.sortKey = key;
+        elements_.emplace_back(std::move(elem));
+
+        SortItem item;
+        item.key = key;
+        item.index = elements_.size() - 1;
+        items_.emplace_back(item);
+    }
+
+    void RenderQueue::sort()
+    {
+        // LSD radix sort by each byte, which is stable and linear in count of elements
+        const auto n = items_.size();
+        sortBuffer_.resize(n);
+        for (size_t shift = 0; shift < 64; shift += 8)
+        {
+            size_t counts[256] = {};
+            for (const auto& item : items_)
+            {
+                ++counts[(item.key >> shift) & 0xff];
+            }
+
+            // Skip the byte that all keys have in common
+            if (n == 0 || counts[(items_[0].key >> shift) & 0xff] == n)
+            {
+                continue;
+            }
+
+            size_t offset = 0;
+            for (auto& count : counts)
+            {
+                const auto c = count;
+                count = offset;
+                offset += c;
+            }
+
+            for (const auto& item : items_)
+            {
+                sortBuffer_[counts[(item.key >> shift) & 0xff]++] = item;
+            }
+            items_.swap(sortBuffer_);
+        }
+    }
+}
\ No newline at end of file
@@ -1,10 +1,12 @@
 #ifndef _KILLME_RENDERQUEUE_H_
 #define _KILLME_RENDERQUEUE_H_
 
-#include "material.h"
 #include "../core/math/matrix44.h"
-#include <queue>
+#include "../core/math/boundingvolume.h"
+#include <vector>
 #include <memory>
+#include <cstdint>
+#include <cassert>
 
 namespace killme
 {
@@ -17,32 +19,54 @@ namespace killme
         std::shared_ptr<VertexData> vertices;
         std::shared_ptr<Material> material;
         Matrix44 worldMatrix; // Transposed
+        BoundingBox boundingBox; // In the world space
+        uint64_t sortKey;
     };
 
     /** Render queue */
+    /// NOTE: Elements are sorted by 64 bit keys. From the most significant bits, a key has
+    ///         [priority 8][pipeline state 16][material 16][depth 24]
+    ///       for opaque elements to draw front to back with less state changes, and
+    ///         [priority 8][inverted depth 24][pipeline state 16][material 16]
+    ///       for translucent elements to draw back to front.
+    ///       The queue is reused over frames, so that pushing and sorting do not allocate memory once it is warmed up.
     class RenderQueue
     {
     private:
-        struct Less
+        struct SortItem
         {
-            bool operator ()(const std::shared_ptr<const RenderElement>& a,
-                const std::shared_ptr<const RenderElement>& b)
-            {
-                return a->material->getPriority() < b->material->getPriority();
-            }
+            uint64_t key;
+            size_t index;
         };
-        std::priority_queue<std::shared_ptr<const RenderElement>,
-            std::vector<std::shared_ptr<const RenderElement>>, Less> queue_;
+
+        std::vector<RenderElement> elements_;
+        std::vector<SortItem> items_;
+        std::vector<SortItem> sortBuffer_;
+        Matrix44 viewMatrix_;
 
     public:
+        /** Construct */
+        RenderQueue();
+
+        /** Clear elements with keeping the capacity, and set the view matrix to compute depths */
+        void reset(const Matrix44& viewMatrix);
+
         /** Push a render element */
-        void push(const std::shared_ptr<const RenderElement>& e) { queue_.emplace(e); }
+        void push(const std::shared_ptr<VertexData>& vertices, const std::shared_ptr<Material>& material,
+            const Matrix44& worldMatrix, const BoundingBox& boundingBox);
 
-        /** Pop a render element */
-        std::shared_ptr<const RenderElement> pop() { const auto e = queue_.top(); queue_.pop(); return e; }
+        /** Sort elements by keys */
+        void sort();
 
-        /** Whether queue is empty or not */
-        bool empty() const { return queue_.empty(); }
+        /** Return count of elements */
+        size_t size() const { return items_.size(); }
+
+        /** Return a sorted element */
+        const RenderElement& operator [](size_t i) const
+        {
+            assert(i < items_.size() && "Index out of range.");
+            return elements_[items_[i].index];
+        }
     };
 }
 
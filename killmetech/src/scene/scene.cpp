@@ -15,28 +15,54 @@
 #include "../renderer/commandlist.h"
 #include "../renderer/commandqueue.h"
 #include "../core/math/matrix44.h"
+#include "../core/math/frustum.h"
 #include <cassert>
 
 namespace killme
 {
+    namespace
+    {
+        // Return the box containing the range of a point light
+        BoundingBox getBoundingBox(const Light& light)
+        {
+            const auto pos = light.getPosition();
+            const auto range = light.getAttenuationRange();
+            return BoundingBox(pos - Vector3(range, range, range), pos + Vector3(range, range, range));
+        }
+
+        // Names of built-in parameters. These are constructed once, since updates take strings.
+        const std::string VIEW_MATRIX = "_ViewMatrix";
+        const std::string PROJ_MATRIX = "_ProjMatrix";
+        const std::string WORLD_MATRIX = "_WorldMatrix";
+        const std::string AMBIENT_LIGHT = "_AmbientLight";
+        const std::string LIGHT_COLOR = "_LightColor";
+        const std::string LIGHT_DIRECTION = "_LightDirection";
+        const std::string LIGHT_POSITION = "_LightPosition";
+        const std::string LIGHT_ATT_RANGE = "_LightAttRange";
+        const std::string LIGHT_ATT_CONSTANT = "_LightAttConstant";
+        const std::string LIGHT_ATT_LINER = "_LightAttLiner";
+        const std::string LIGHT_ATT_QUADRATIC = "_LightAttQuadratic";
+    }
+
     Scene::Scene(RenderSystem& renderSystem)
         : device_(renderSystem.getDevice())
         , scissorRect_()
         , ambientLight_(0.2f, 0.2f, 0.2f, 1)
         , dirLights_()
-        , pointLights_()
         , cameras_()
-        , meshInstances_()
         , mainCamera_()
+        , pointLights_()
+        , meshInstances_()
+        , meshUsages_()
+        , movedMeshInstances_()
+        , pointLightTree_()
+        , meshInstanceTree_()
+        , renderQueue_()
     {
-        const auto window = renderSystem.getTargetWindow();
-        RECT clientRect;
-        GetClientRect(window, &clientRect);
-
         scissorRect_.top = 0;
         scissorRect_.left = 0;
-        scissorRect_.right = clientRect.right - clientRect.left;
-        scissorRect_.bottom = clientRect.bottom - clientRect.top;
+        scissorRect_.right = static_cast<int>(renderSystem.getClientWidth());
+        scissorRect_.bottom = static_cast<int>(renderSystem.getClientHeight());
     }
 
     void Scene::setAmbientLight(const Color& c)
@@ -50,9 +76,9 @@ namespace killme
         {
             dirLights_.emplace(light);
         }
-        else
+        else if (pointLights_.find(light) == std::cend(pointLights_))
         {
-            pointLights_.emplace(light);
+            pointLights_.emplace(light, pointLightTree_.createProxy(getBoundingBox(*light), light));
         }
     }
 
@@ -64,7 +90,21 @@ namespace killme
         }
         else
         {
-            pointLights_.erase(light);
+            const auto it = pointLights_.find(light);
+            if (it != std::cend(pointLights_))
+            {
+                pointLightTree_.destroyProxy(it->second);
+                pointLights_.erase(it);
+            }
+        }
+    }
+
+    void Scene::updateLight(const std::shared_ptr<Light>& light)
+    {
+        const auto it = pointLights_.find(light);
+        if (it != std::cend(pointLights_))
+        {
+            pointLightTree_.moveProxy(it->second, getBoundingBox(*light));
         }
     }
 
@@ -95,12 +135,91 @@ namespace killme
 
     void Scene::addMeshInstance(const std::shared_ptr<MeshInstance>& inst)
     {
-        meshInstances_.emplace(inst);
+        if (meshInstances_.find(inst) != std::cend(meshInstances_))
+        {
+            return;
+        }
+
+        meshInstances_.emplace(inst, MeshInstanceEntry{ meshInstanceTree_.createProxy(inst->getBoundingBox(), inst), false });
+
+        // Application meshes are not reloaded
+        const auto mesh = inst->getMesh();
+        if (mesh.getId().valid())
+        {
+            auto& usage = meshUsages_.emplace(mesh.getId(), MeshUsage{ mesh, mesh.getLoaded(), 0 }).first->second;
+            ++usage.numInstances;
+        }
     }
 
     void Scene::removeMeshInstance(const std::shared_ptr<MeshInstance>& inst)
     {
-        meshInstances_.erase(inst);
+        const auto it = meshInstances_.find(inst);
+        if (it == std::cend(meshInstances_))
+        {
+            return;
+        }
+
+        meshInstanceTree_.destroyProxy(it->second.proxy);
+        meshInstances_.erase(it);
+
+        const auto usage = meshUsages_.find(inst->getMesh().getId());
+        if (usage != std::cend(meshUsages_) && --usage->second.numInstances == 0)
+        {
+            meshUsages_.erase(usage);
+        }
+    }
+
+    void Scene::updateMeshInstance(const std::shared_ptr<MeshInstance>& inst)
+    {
+        const auto it = meshInstances_.find(inst);
+        if (it != std::cend(meshInstances_) && !it->second.moved)
+        {
+            it->second.moved = true;
+            movedMeshInstances_.emplace_back(inst);
+        }
+    }
+
+    std::vector<std::shared_ptr<MeshInstance>> Scene::findMeshInstances(const BoundingBox& box)
+    {
+        updateMeshBounds();
+        std::vector<std::shared_ptr<MeshInstance>> result;
+        meshInstanceTree_.query(box, [&](const std::shared_ptr<MeshInstance>& inst) { result.emplace_back(inst); });
+        return result;
+    }
+
+    std::vector<std::shared_ptr<MeshInstance>> Scene::findMeshInstances(const BoundingSphere& sphere)
+    {
+        updateMeshBounds();
+        std::vector<std::shared_ptr<MeshInstance>> result;
+        meshInstanceTree_.query(sphere, [&](const std::shared_ptr<MeshInstance>& inst) { result.emplace_back(inst); });
+        return result;
+    }
+
+    std::vector<std::shared_ptr<Light>> Scene::findPointLights(const BoundingBox& box)
+    {
+        std::vector<std::shared_ptr<Light>> result;
+        pointLightTree_.query(box, [&](const std::shared_ptr<Light>& light) { result.emplace_back(light); });
+        return result;
+    }
+
+    std::shared_ptr<MeshInstance> Scene::pickMeshInstance(const Vector3& origin, const Vector3& direction, float maxDistance)
+    {
+        updateMeshBounds();
+
+        std::shared_ptr<MeshInstance> picked;
+        auto closest = maxDistance;
+        meshInstanceTree_.rayCast(origin, direction, maxDistance, [&](const std::shared_ptr<MeshInstance>& inst, float)
+        {
+            // The boxes in the tree are enlarged, so test the exact box
+            float distance;
+            if (intersectsRay(inst->getBoundingBox(), origin, direction, closest, distance))
+            {
+                picked = inst;
+                closest = distance;
+            }
+            return closest;
+        });
+        return picked;
     }
 
     void Scene::renderScene(const FrameResource& frame)
@@ -115,26 +234,47 @@ namespace killme
         const auto projMatrix = transpose(mainCamera_->getProjectionMatrix());
         const auto viewport = mainCamera_->getViewport();
 
-        // Collect render meshes
-        RenderQueue queue;
-        for (const auto inst : meshInstances_)
+        // Collect render meshes in the view
+        updateMeshBounds();
+        const Frustum frustum(mainCamera_->getViewMatrix() * mainCamera_->getProjectionMatrix());
+        renderQueue_.reset(mainCamera_->getViewMatrix());
+        meshInstanceTree_.query(frustum, [&](const std::shared_ptr<MeshInstance>& inst)
+        {
+            inst->collectMeshes(renderQueue_, frustum);
+        });
+        renderQueue_.sort();
+        if (renderQueue_.size() == 0)
         {
-            inst->collectMeshes(queue);
+            return;
         }
 
+        // Record all draws into a command list, and submit it once
+        const auto allocator = device_->obtainCommandAllocator();
+        const auto commands = device_->obtainCommandList(allocator, nullptr);
+        commands->transitionBarrior(frame.backBuffer, GpuResourceState::present, GpuResourceState::renderTarget);
+
         // For each render elements
-        while (!queue.empty())
+        for (size_t i = 0; i < renderQueue_.size(); ++i)
         {
-            const auto elem = queue.pop();
+            const auto& elem = renderQueue_[i];
+
+            // The GPU reads them after this returns, so keep them alive until the execution is completed.
+            // Neighboring opaque elements often share a material, so skip it if it is the same as the previous.
+            // Duplicates are harmless, so materials are not deduplicated across the list.
+            commands->hold(elem.vertices);
+            if (i == 0 || elem.material != renderQueue_[i - 1].material)
+            {
+                commands->hold(elem.material);
+            }
 
             // Update constant buffers
-            elem->material->setNumeric("_ViewMatrix", to<MP_float4x4>(viewMatrix));
-            elem->material->setNumeric("_ProjMatrix", to<MP_float4x4>(projMatrix));
-            elem->material->setNumeric("_WorldMatrix", to<MP_float4x4>(elem->worldMatrix));
-            elem->material->setNumeric("_AmbientLight", to<MP_float4>(ambientLight_));
+            elem.material->setNumeric(VIEW_MATRIX, to<MP_float4x4>(viewMatrix));
+            elem.material->setNumeric(PROJ_MATRIX, to<MP_float4x4>(projMatrix));
+            elem.material->setNumeric(WORLD_MATRIX, to<MP_float4x4>(elem.worldMatrix));
+            elem.material->setNumeric(AMBIENT_LIGHT, to<MP_float4>(ambientLight_));
 
             // For each passes
-            for (const auto& pass : elem->material->getUseTechnique()->getPasses())
+            for (const auto& pass : elem.material->getUseTechnique()->getPasses())
             {
                 const auto pipeline = pass->getPipelineState();
 
@@ -145,25 +285,11 @@ namespace killme
                     pipeline->setViewport(viewport);
                     pipeline->setScissorRect(scissorRect_);
                     pipeline->setPrimitiveTopology(PrimitiveTopology::triangeList);
-                    pipeline->setVertexBuffers(elem->vertices);
-
-                    // Add draw commands
-                    const auto allocator = device_->obtainCommandAllocator();
-                    const auto commands = device_->obtainCommandList(allocator, pipeline);
-
-                    commands->transitionBarrior(frame.backBuffer,
-                        GpuResourceState::present, GpuResourceState::renderTarget);
-                    commands->drawIndexed(elem->vertices->getIndexBuffer()->getNumIndices());
-                    commands->transitionBarrior(frame.backBuffer,
-                        GpuResourceState::renderTarget, GpuResourceState::present);
-
-                    commands->close();
+                    pipeline->setVertexBuffers(elem.vertices);
 
-                    const auto commandExe = { commands };
-                    device_->getCommandQueue()->executeCommands(commandExe);
-
-                    device_->reuseCommandAllocatorAfterExecution(allocator);
-                    device_->reuseCommandListAfterExecution(commands);
+                    // Add draw commands. The current constants are copied into the list.
+                    commands->setPipelineState(pipeline);
+                    commands->drawIndexed(elem.vertices->getIndexBuffer()->getNumIndices());
                 };
 
                 if (pass->getLightIteration() == LightIteration::directional)
@@ -172,14 +298,15 @@ namespace killme
                     {
                         const auto lightColor = light->getColor();
                         const auto lightDir = light->getDirection();
-                        pass->updateConstant("_LightColor", &lightColor, sizeof(lightColor));
-                        pass->updateConstant("_LightDirection", &lightDir, sizeof(lightDir));
+                        pass->updateConstant(LIGHT_COLOR, &lightColor, sizeof(lightColor));
+                        pass->updateConstant(LIGHT_DIRECTION, &lightDir, sizeof(lightDir));
                         renderPass();
                     }
                 }
                 else if (pass->getLightIteration() == LightIteration::point)
                 {
-                    for (const auto& light : pointLights_)
+                    // Only the lights whose ranges reach the element
+                    pointLightTree_.query(elem.boundingBox, [&](const std::shared_ptr<Light>& light)
                     {
                         const auto lightColor = light->getColor();
                         const auto lightPos = light->getPosition();
@@ -187,14 +314,14 @@ namespace killme
                         const auto lightAttConstant = light->getAttenuationConstant();
                         const auto lightAttLiner = light->getAttenuationLiner();
                         const auto lightAttQuadratic = light->getAttenuationQuadratic();
-                        pass->updateConstant("_LightColor", &lightColor, sizeof(lightColor));
-                        pass->updateConstant("_LightPosition", &lightPos, sizeof(lightPos));
-                        pass->updateConstant("_LightAttRange", &lightAttRange, sizeof(lightAttRange));
-                        pass->updateConstant("_LightAttConstant", &lightAttConstant, sizeof(lightAttConstant));
-                        pass->updateConstant("_LightAttLiner", &lightAttLiner, sizeof(lightAttLiner));
-                        pass->updateConstant("_LightAttQuadratic", &lightAttQuadratic, sizeof(lightAttQuadratic));
+                        pass->updateConstant(LIGHT_COLOR, &lightColor, sizeof(lightColor));
+                        pass->updateConstant(LIGHT_POSITION, &lightPos, sizeof(lightPos));
+                        pass->updateConstant(LIGHT_ATT_RANGE, &lightAttRange, sizeof(lightAttRange));
+                        pass->updateConstant(LIGHT_ATT_CONSTANT, &lightAttConstant, sizeof(lightAttConstant));
+                        pass->updateConstant(LIGHT_ATT_LINER, &lightAttLiner, sizeof(lightAttLiner));
+                        pass->updateConstant(LIGHT_ATT_QUADRATIC, &lightAttQuadratic, sizeof(lightAttQuadratic));
                         renderPass();
-                    }
+                    });
                 }
                 else
                 {
@@ -203,6 +330,46 @@ namespace killme
             }
         }
 
-        device_->getCommandQueue()->waitForCommands();
+        commands->transitionBarrior(frame.backBuffer, GpuResourceState::renderTarget, GpuResourceState::present);
+        commands->close();
+
+        // Do not wait here. The render system waits for the frame before reusing the back buffer.
+        const auto commandExe = { commands };
+        device_->getCommandQueue()->executeCommands(commandExe);
+        device_->reuseCommandAllocatorAfterExecution(allocator);
+        device_->reuseCommandListAfterExecution(commands);
+    }
+
+    void Scene::updateMeshBounds()
+    {
+        // A reloaded mesh is a new instance in the store. Do not load evicted meshes here.
+        for (auto& usage : meshUsages_)
+        {
+            const auto mesh = usage.second.mesh.getLoaded();
+            if (!mesh || mesh == usage.second.seen.lock())
+            {
+                continue;
+            }
+
+            usage.second.seen = mesh;
+            for (const auto& inst : meshInstances_)
+            {
+                if (inst.first->getMesh().getId() == usage.first)
+                {
+                    updateMeshInstance(inst.first);
+                }
+            }
+        }
+
+        for (const auto& inst : movedMeshInstances_)
+        {
+            const auto it = meshInstances_.find(inst);
+            if (it != std::cend(meshInstances_) && it->second.moved)
+            {
+                meshInstanceTree_.moveProxy(it->second.proxy, inst->getBoundingBox());
+                it->second.moved = false;
+            }
+        }
+        movedMeshInstances_.clear();
     }
 }
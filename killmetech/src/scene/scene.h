@@ -1,10 +1,15 @@
 #ifndef _KILLME_SCENE_H_
 #define _KILLME_SCENE_H_
 
+#include "renderqueue.h"
 #include "../renderer/renderstate.h"
 #include "../core/math/color.h"
+#include "../core/math/boundingvolumehierarchy.h"
+#include "../resources/resource.h"
 #include <memory>
 #include <unordered_set>
+#include <unordered_map>
+#include <vector>
 
 namespace killme
 {
@@ -13,6 +18,7 @@ namespace killme
     class Camera;
     class Light;
     class MeshInstance;
+    class Mesh;
     struct FrameResource;
 
     /** Render scene */
@@ -23,11 +29,36 @@ namespace killme
         ScissorRect scissorRect_;
         Color ambientLight_;
         std::unordered_set<std::shared_ptr<Light>> dirLights_;
-        std::unordered_set<std::shared_ptr<Light>> pointLights_;
         std::unordered_set<std::shared_ptr<Camera>> cameras_;
-        std::unordered_set<std::shared_ptr<MeshInstance>> meshInstances_;
         std::shared_ptr<Camera> mainCamera_;
 
+        // Spatial indices. The maps have the proxies in the trees.
+        using PointLightTree = BoundingVolumeHierarchy<std::shared_ptr<Light>>;
+        using MeshInstanceTree = BoundingVolumeHierarchy<std::shared_ptr<MeshInstance>>;
+        struct MeshInstanceEntry
+        {
+            MeshInstanceTree::ProxyId proxy;
+            bool moved;
+        };
+
+        // Meshes used by the instances, to find reloaded ones
+        struct MeshUsage
+        {
+            Resource<Mesh> mesh;
+            std::weak_ptr<Mesh> seen; // The mesh which the bounds are computed from
+            size_t numInstances;
+        };
+
+        std::unordered_map<std::shared_ptr<Light>, PointLightTree::ProxyId> pointLights_;
+        std::unordered_map<std::shared_ptr<MeshInstance>, MeshInstanceEntry> meshInstances_;
+        std::unordered_map<ResourceId, MeshUsage> meshUsages_;
+        std::vector<std::shared_ptr<MeshInstance>> movedMeshInstances_;
+        PointLightTree pointLightTree_;
+        MeshInstanceTree meshInstanceTree_;
+
+        // Reused over frames to avoid allocations
+        RenderQueue renderQueue_;
+
     public:
         /** Construct */
         explicit Scene(RenderSystem& renderSystem);
@@ -41,6 +72,9 @@ namespace killme
         /** Remove a light */
         void removeLight(const std::shared_ptr<Light>& light);
 
+        /** Update the bounds of a point light after it is moved or its range is changed */
+        void updateLight(const std::shared_ptr<Light>& light);
+
         /** Set the main camera */
         void setMainCamera(const std::shared_ptr<Camera>& camera);
 
@@ -59,8 +93,28 @@ namespace killme
         /** Remove a mesh instance */
         void removeMeshInstance(const std::shared_ptr<MeshInstance>& inst);
 
+        /** Mark the bounds of a mesh instance as moved */
+        /// NOTE: The bounds are computed once before the next query or rendering, however many times this is called.
+        ///       Bounds of instances whose meshes are reloaded are updated without this.
+        void updateMeshInstance(const std::shared_ptr<MeshInstance>& inst);
+
+        /** Return mesh instances overlapping the volume */
+        /// NOTE: Instances near the volume may be returned, since the bounds in the index are enlarged.
+        std::vector<std::shared_ptr<MeshInstance>> findMeshInstances(const BoundingBox& box);
+        std::vector<std::shared_ptr<MeshInstance>> findMeshInstances(const BoundingSphere& sphere);
+
+        /** Return point lights whose ranges overlap the box */
+        std::vector<std::shared_ptr<Light>> findPointLights(const BoundingBox& box);
+
+        /** Return the closest mesh instance whose bounding box is hit by the ray, or null */
+        std::shared_ptr<MeshInstance> pickMeshInstance(const Vector3& origin, const Vector3& direction, float maxDistance);
+
         /** Draw the current scene */
         void renderScene(const FrameResource& frame);
+
+    private:
+        // Move the proxies of moved instances and instances whose meshes are reloaded
+        void updateMeshBounds();
     };
 }
 
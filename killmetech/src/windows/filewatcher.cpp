@@ -0,0 +1,156 @@
+#include "filewatcher.h"
+#include "../core/exception.h"
+#include <Windows.h>
+#include <unordered_set>
+
+namespace killme
+{
+    namespace
+    {
+        // Return 0 if the file does not exist
+        uint64_t getWriteTime(const std::string& path)
+        {
+            WIN32_FILE_ATTRIBUTE_DATA data;
+            if (!GetFileAttributesExA(path.c_str(), GetFileExInfoStandard, &data))
+            {
+                return 0;
+            }
+            return (static_cast<uint64_t>(data.ftLastWriteTime.dwHighDateTime) << 32) | data.ftLastWriteTime.dwLowDateTime;
+        }
+
+        std::string getDirectory(const std::string& path)
+        {
+            const auto found = path.find_last_of("/\\");
+            return found == std::string::npos ? "." : path.substr(0, found);
+        }
+    }
+
+    FileWatcher::FileWatcher(Listener listener, std::chrono::milliseconds interval)
+        : listener_(listener)
+        , interval_(interval)
+        , writeTimes_()
+        , directoriesChanged_(false)
+        , mutex_()
+        , stopEvent_(nullptr)
+        , thread_()
+    {
+        stopEvent_ = enforce<Exception>(CreateEventA(nullptr, TRUE, FALSE, nullptr), "Failed to create the event of the file watcher.");
+        thread_ = std::thread([this] { run(); });
+    }
+
+    FileWatcher::~FileWatcher()
+    {
+        SetEvent(stopEvent_);
+        thread_.join();
+        CloseHandle(stopEvent_);
+    }
+
+    void FileWatcher::watch(const std::string& path)
+    {
+        const auto writeTime = getWriteTime(path);
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (writeTimes_.emplace(path, writeTime).second)
+        {
+            directoriesChanged_ = true;
+        }
+    }
+
+    void FileWatcher::unwatch(const std::string& path)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (writeTimes_.erase(path) > 0)
+        {
+            directoriesChanged_ = true;
+        }
+    }
+
+    void FileWatcher::run()
+    {
+        std::vector<HANDLE> notifications;
+        KILLME_SCOPE_EXIT
+        {
+            for (const auto n : notifications)
+            {
+                FindCloseChangeNotification(n);
+            }
+        };
+
+        while (true)
+        {
+            // Observe the directories of the watched files
+            std::unordered_set<std::string> directories;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (directoriesChanged_)
+                {
+                    for (const auto& file : writeTimes_)
+                    {
+                        directories.emplace(getDirectory(file.first));
+                    }
+                    directoriesChanged_ = false;
+                }
+            }
+            if (!directories.empty())
+            {
+                for (const auto n : notifications)
+                {
+                    FindCloseChangeNotification(n);
+                }
+                notifications.clear();
+
+                // Directories over the limit of handles are polled
+                for (const auto& directory : directories)
+                {
+                    if (notifications.size() + 1 >= MAXIMUM_WAIT_OBJECTS)
+                    {
+                        break;
+                    }
+                    const auto n = FindFirstChangeNotificationA(directory.c_str(), FALSE, FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_FILE_NAME);
+                    if (n != INVALID_HANDLE_VALUE)
+                    {
+                        notifications.emplace_back(n);
+                    }
+                }
+            }
+
+            std::vector<HANDLE> handles = { stopEvent_ };
+            handles.insert(std::end(handles), std::cbegin(notifications), std::cend(notifications));
+            const auto result = WaitForMultipleObjects(static_cast<DWORD>(handles.size()), handles.data(), FALSE, static_cast<DWORD>(interval_.count()));
+            if (result == WAIT_OBJECT_0)
+            {
+                return;
+            }
+            if (result > WAIT_OBJECT_0 && result < WAIT_OBJECT_0 + handles.size())
+            {
+                FindNextChangeNotification(handles[result - WAIT_OBJECT_0]);
+            }
+
+            const auto modified = poll();
+            if (!modified.empty())
+            {
+                listener_(modified);
+            }
+        }
+    }
+
+    std::vector<std::string> FileWatcher::poll()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::vector<std::string> modified;
+        for (auto& file : writeTimes_)
+        {
+            const auto writeTime = getWriteTime(file.first);
+            if (writeTime != file.second)
+            {
+                file.second = writeTime;
+
+                // Removed files are reported when they are created again
+                if (writeTime != 0)
+                {
+                    modified.emplace_back(file.first);
+                }
+            }
+        }
+        return modified;
+    }
+}
\ No newline at end of file
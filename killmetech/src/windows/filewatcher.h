@@ -0,0 +1,59 @@
+#ifndef _KILLME_FILEWATCHER_H_
+#define _KILLME_FILEWATCHER_H_
+
+#include <unordered_map>
+#include <vector>
+#include <string>
+#include <functional>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <cstdint>
+
+namespace killme
+{
+    /** Watcher of file modifications on a background thread */
+    /// NOTE: Directories of the watched files are observed by change notifications, and
+    ///       last write times are compared on each notification. Files in directories that
+    ///       can not be observed are found by polling at the interval.
+    class FileWatcher
+    {
+    public:
+        /** Called on the watcher thread with the modified files */
+        using Listener = std::function<void(const std::vector<std::string>&)>;
+
+    private:
+        Listener listener_;
+        std::chrono::milliseconds interval_;
+        std::unordered_map<std::string, uint64_t> writeTimes_;
+        bool directoriesChanged_;
+        std::mutex mutex_;
+        void* stopEvent_;
+        std::thread thread_;
+
+    public:
+        /** Start the watcher thread */
+        FileWatcher(Listener listener, std::chrono::milliseconds interval);
+
+        /** Stop the watcher thread */
+        ~FileWatcher();
+
+        /** File watcher is noncopyable */
+        FileWatcher(const FileWatcher&) = delete;
+        FileWatcher& operator =(const FileWatcher&) = delete;
+
+        /** Watch a file */
+        void watch(const std::string& path);
+
+        /** Stop watching a file */
+        void unwatch(const std::string& path);
+
+    private:
+        void run();
+
+        // Update the write times, and return modified files
+        std::vector<std::string> poll();
+    };
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,78 @@
+#include "mappedfile.h"
+#include "../core/exception.h"
+#include <Windows.h>
+
+namespace killme
+{
+    MappedFile::MappedFile(const std::string& path)
+        : file_(INVALID_HANDLE_VALUE)
+        , mapping_(nullptr)
+        , data_(nullptr)
+        , size_(0)
+    {
+        file_ = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_RANDOM_ACCESS, nullptr);
+        enforce<FileException>(file_ != INVALID_HANDLE_VALUE, "Failed to open file (" + path + ").");
+
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(file_, &size))
+        {
+            CloseHandle(file_);
+            throw FileException("Failed to get the file size (" + path + ").");
+        }
+        size_ = static_cast<size_t>(size.QuadPart);
+
+        // An empty file can not be mapped
+        if (size_ == 0)
+        {
+            return;
+        }
+
+        mapping_ = CreateFileMappingA(file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mapping_)
+        {
+            data_ = static_cast<const unsigned char*>(MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0));
+        }
+        if (!data_)
+        {
+            if (mapping_)
+            {
+                CloseHandle(mapping_);
+            }
+            CloseHandle(file_);
+            throw FileException("Failed to map file (" + path + ").");
+        }
+    }
+
+    MappedFile::~MappedFile()
+    {
+        if (data_)
+        {
+            UnmapViewOfFile(data_);
+        }
+        if (mapping_)
+        {
+            CloseHandle(mapping_);
+        }
+        CloseHandle(file_);
+    }
+
+    const unsigned char* MappedFile::getData() const
+    {
+        return data_;
+    }
+
+    size_t MappedFile::getSize() const
+    {
+        return size_;
+    }
+
+    uint64_t MappedFile::getLastWriteTime() const
+    {
+        FILETIME time;
+        if (!GetFileTime(file_, nullptr, nullptr, &time))
+        {
+            return 0;
+        }
+        return (static_cast<uint64_t>(time.dwHighDateTime) << 32) | time.dwLowDateTime;
+    }
+}
\ No newline at end of file
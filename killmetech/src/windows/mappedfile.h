@@ -0,0 +1,40 @@
+#ifndef _KILLME_MAPPEDFILE_H_
+#define _KILLME_MAPPEDFILE_H_
+
+#include <string>
+#include <cstdint>
+
+namespace killme
+{
+    /** Read only memory mapped file */
+    class MappedFile
+    {
+    private:
+        void* file_;
+        void* mapping_;
+        const unsigned char* data_;
+        size_t size_;
+
+    public:
+        /** Map a file. Throw FileException if failed. */
+        explicit MappedFile(const std::string& path);
+
+        /** Unmap the file */
+        ~MappedFile();
+
+        /** Mapped file is noncopyable */
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator =(const MappedFile&) = delete;
+
+        /** Return the mapped bytes */
+        const unsigned char* getData() const;
+
+        /** Return the size[byte] */
+        size_t getSize() const;
+
+        /** Return the last write time of the file */
+        uint64_t getLastWriteTime() const;
+    };
+}
+
+#endif
\ No newline at end of file